@@ -1,3 +1,3 @@
 set(3rdparty_include ${3rdparty_include} ${3rdparty_path}/EMT_API_CPP_V2.24.0/emt_api/include)
 set(3rdparty_lib ${3rdparty_lib} ${3rdparty_path}/EMT_API_CPP_V2.24.0/emt_api/lib/linux)
-set(3rdparty_so ${3rdparty_so} -lemt_api -lemt_quote_api)
\ No newline at end of file
+set(3rdparty_so ${3rdparty_so} -lemt_api -lemt_quote_api -lemt_quote_api_lv2)
\ No newline at end of file
@@ -4,12 +4,31 @@
 
 #pragma once
 #include <string>
+#include <tuple>
 #include <vector>
+#include <cstdint>
 namespace rk::config_type
 {
     struct AccountConfig
     {
         std::string account_name;
+        uint32_t order_capacity = 0;    // 预分配委托容量
+        uint32_t trade_capacity = 0;    // 预分配成交容量
+        std::string journal_path;       // 预写日志目录
+    };
+    // Level2组播通道, 对应行情API的SetChannelConfig
+    struct L2ChannelConfig
+    {
+        std::string quote_type;             // SSE_SNAP/SSE_TICK/SSE_TREE/SZSE_SNAP/SZSE_TICK/SZSE_TREE
+        std::string recv_mode;              // normal/efvi
+        std::string eth_name;
+        std::string multicast_ip;
+        uint16_t multicast_port = 0;
+        int32_t rx_cpu_id = -1;             // -1不绑核
+        int32_t handle_cpu_id = -1;
+        int32_t rx_pkt_num = 8;             // 接收内存, 单位4MB
+        int32_t spsc_size = 8;              // API内部缓存队列长度, 单位K
+        uint32_t queue_capacity = 0;        // 本地分发队列容量, 0按行情类型取默认值
     };
     struct MDAdapterConfig
     {
@@ -26,6 +45,9 @@ namespace rk::config_type
         std::string password;
         std::string app_id;
         std::string auth_code;
+        std::string l2_front_ip;
+        std::string l2_front_port;
+        std::vector<L2ChannelConfig> l2_channel;
     };
     struct TDAdapterConfig
     {
@@ -40,13 +62,15 @@ namespace rk::config_type
         std::string password;
         std::string app_id;
         std::string auth_code;
+        uint32_t order_capacity = 0;        // 取自account_config, 报单引用映射预分配容量
     };
     struct RiskControlConfig
     {
         int daily_order_num = 0;
         int daily_cancel_num = 0;
         int daily_repeat_order_num = 0;
-
+        uint32_t order_rate = 0;            // 每秒报撤单笔数上限, 0不限流
+        uint32_t order_burst = 0;           // 允许突发的报撤单笔数, 0取order_rate
     };
     struct DBConfig
     {
@@ -55,6 +79,15 @@ namespace rk::config_type
         std::string ip;
         int port;
         std::string database;
+        uint32_t batch_size = 0;            // 异步写入按表攒批, 达到条数即刷出
+        uint32_t flush_interval_ms = 0;     // 批次最长等待时间
+        uint32_t queue_capacity = 0;        // 每张表预分配的异步写入队列容量
+        std::string backpressure;           // 队列满时drop丢弃计数, block等待
+        uint32_t snapshot_interval_s = 0;   // 交易数据快照落库周期, 0为仅停止交易时落库
+    };
+    struct AlgoConfig
+    {
+        std::string volume_profile_path;    // VWAP历史分钟成交量分布目录, 每个合约一个<合约>.csv
     };
     struct EngineConfig
     {
@@ -63,19 +96,32 @@ namespace rk::config_type
         TDAdapterConfig td_adapter_config;
         RiskControlConfig risk_control_config;
         DBConfig db_config;
+        AlgoConfig algo_config;
     };
     EngineConfig load_engine_config(std::string_view config_file_path);
+    // Level2逐笔重建订单簿, 按合约分片到多个工作线程
+    struct OrderBookConfig
+    {
+        uint32_t shard_num = 0;                 // 0不重建订单簿
+        std::vector<int32_t> shard_cpu_id;      // 按分片绑核, 未配置或-1不绑核
+        uint32_t queue_capacity = 0;            // 每个分片的输入队列容量
+        uint32_t depth = 10;                    // 快照档数
+        uint32_t snapshot_interval_ms = 0;      // 同一合约快照最小间隔(交易所时间), 0为逐笔发布
+        std::string last_value_store;           // 快照共享内存名, 空为不发布
+    };
     struct MDGatewayConfig
     {
         std::string endpoint;
         MDAdapterConfig md_adapter_config;
+        OrderBookConfig order_book_config;
+        bool iopv = false;                      // 按申赎清单实时计算ETF参考净值, 自动订阅成分股
         static MDGatewayConfig load_config_file(std::string_view config_file_path);
     };
     struct AlgoExecutorConfig
     {
         EngineConfig engine_config;
         std::string req_endpoint;
-        std::vector<std::tuple<std::string, std::string>> schedule;
+        std::vector<std::tuple<std::string, std::string>> schedule;     // 交易时段(开始, 结束), 形如HH:MM:SS, 时段内登录交易
 
     };
     AlgoExecutorConfig load_algo_executor_config(std::string_view config_file_path);
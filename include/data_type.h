@@ -3,6 +3,7 @@
 //
 
 #pragma once
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <utility>
@@ -19,6 +20,8 @@ namespace rk::data_type
 {
     // types
     using OrderRef = std::uint32_t;
+    using BasketId = std::uint32_t;
+    using SpreadId = std::uint32_t;
     // enums
     enum class Exchange
     {
@@ -60,6 +63,23 @@ namespace rk::data_type
         ORDER_INSERT_ERROR,
         ORDER_CANCEL_ERROR
     };
+    enum class BasketStatus
+    {
+        UNKNOWN,
+        SENDING,            // 子单按流控分批报出中
+        WORKING,            // 子单已全部报出
+        CANCELING,          // 撤单中
+        FINISHED            // 各腿全部成交、撤销或拒单
+    };
+    enum class SpreadOrderStatus
+    {
+        UNKNOWN,
+        WORKING,
+        CANCELING,          // 主动腿撤单中, 已成交部分继续对冲
+        FINISHED,           // 全部组合配平
+        CANCELED,           // 撤单完成, 已成交部分已对冲
+        HEDGE_FAILED        // 主动腿或对冲腿连续拒单超过上限, 撤销在途腿单并停止报单, 未配平敞口由策略处理
+    };
     enum class OrderStatus
     {
         UNKNOWN,            // 未知
@@ -77,6 +97,21 @@ namespace rk::data_type
         SUSPENSION,             // 当日停牌
         TRADEABLE               // 可以交易
     };
+    enum class L2OrderType
+    {
+        UNKNOWN,
+        LIMIT,              // 限价
+        MARKET,             // 市价
+        BEST_OWN,           // 本方最优
+        CANCEL              // 撤单, 上交所删除订单与深交所撤单成交统一为撤单委托
+    };
+    enum class CashReplaceType
+    {
+        UNKNOWN,
+        FORBIDDEN,          // 禁止现金替代
+        OPTIONAL,           // 可以现金替代
+        MUST                // 必须现金替代
+    };
     enum class DataType
     {
 
@@ -90,11 +125,26 @@ namespace rk::data_type
         ProductClass                                product_class = ProductClass::UNKNOWN;
         bool operator==(const Symbol& other) const {return symbol == other.symbol;}
         bool operator<(const Symbol& other) const {return symbol < other.symbol;}
+        // 平仓指令是否只能平昨仓: 上期所/能源中心的CLOSE为平昨, 股票/ETF为T+1
+        [[nodiscard]] bool is_close_yesterday(Offset offset) const
+        {
+            return (
+                offset == Offset::CLOSE_YD ||
+                (
+                    offset == Offset::CLOSE &&
+                    (
+                        exchange == Exchange::SHFE || exchange == Exchange::INE ||
+                        product_class == ProductClass::STOCK || product_class == ProductClass::ETF
+                    )
+                )
+            );
+        }
     };
     struct TickData
     {
         Symbol                                      symbol;
         uint32_t                                    trading_day = 0;
+        uint32_t                                    symbol_id = std::numeric_limits<uint32_t>::max();     // 行情接口合约表序号, 引擎按序号缓存分发下标, 未填为最大值
         util::DateTime                              update_time;
         double                                      last_price = 0.;
         double                                      open_price = 0.;
@@ -111,6 +161,49 @@ namespace rk::data_type
         std::array<int64_t, 10>                     ask_volume{};
         double                                      iopv = 0.;
     };
+    // 逐笔委托
+    struct L2OrderData
+    {
+        Symbol                                      symbol;
+        util::DateTime                              update_time;
+        uint32_t                                    channel = 0;            // 交易所频道号
+        uint64_t                                    seq = 0;                // 频道内逐笔序号, 委托与成交共用
+        uint64_t                                    order_no = 0;           // 上交所为订单号, 深交所为委托的逐笔序号
+        Direction                                   direction = Direction::UNKNOWN;
+        L2OrderType                                 order_type = L2OrderType::UNKNOWN;
+        double                                      price = 0.;             // 深交所撤单无价格
+        int64_t                                     volume = 0;             // 上交所新增委托为撮合后剩余数量, 撤单为撤销数量
+        int64_t                                     traded_volume = 0;      // 上交所新增委托申报时已成交数量
+    };
+    // 逐笔成交
+    struct L2TradeData
+    {
+        Symbol                                      symbol;
+        util::DateTime                              update_time;
+        uint32_t                                    channel = 0;
+        uint64_t                                    seq = 0;
+        uint64_t                                    buy_order_no = 0;
+        uint64_t                                    sell_order_no = 0;
+        Direction                                   direction = Direction::UNKNOWN;     // 主动成交方向
+        double                                      price = 0.;
+        int64_t                                     volume = 0;
+        double                                      turnover = 0.;
+    };
+    // 十档快照, 建树快照由行情服务商按逐笔重建, seq为重建时最后处理的逐笔序号
+    struct L2SnapshotData
+    {
+        TickData                                    tick;
+        uint32_t                                    channel = 0;
+        uint64_t                                    seq = 0;
+        bool                                        is_tree = false;
+        double                                      pre_close_price = 0.;
+        int64_t                                     trade_num = 0;
+        double                                      turnover = 0.;
+        int64_t                                     total_bid_volume = 0;
+        int64_t                                     total_ask_volume = 0;
+        double                                      bid_average_price = 0.;
+        double                                      ask_average_price = 0.;
+    };
     struct SymbolDetail
     {
         Symbol                                      symbol;
@@ -135,11 +228,47 @@ namespace rk::data_type
         double                                      close_fee_rate_by_volume = 0.;
         double                                      close_today_fee_rate_by_money = 0.;
         double                                      close_today_fee_rate_by_volume = 0.;
+        double                                      pre_close_price = 0.;
+        // 股票/ETF现金交收, 期货保证金交易
+        [[nodiscard]] bool is_cash_settled() const
+        {
+            return product_class == ProductClass::STOCK || product_class == ProductClass::ETF;
+        }
+        [[nodiscard]] double margin(Direction direction, double amount) const
+        {
+            return amount * (direction == Direction::LONG ? long_margin_ratio : short_margin_ratio);
+        }
+        [[nodiscard]] double commission(Offset offset, double amount, uint32_t volume) const
+        {
+            switch (offset)
+            {
+                case Offset::OPEN: return amount * open_fee_rate_by_money + volume * open_fee_rate_by_volume;
+                case Offset::CLOSE_TD: return amount * close_today_fee_rate_by_money + volume * close_today_fee_rate_by_volume;
+                default: return amount * close_fee_rate_by_money + volume * close_fee_rate_by_volume;
+            }
+        }
+    };
+    // ETF申赎清单中的成分股, 数量按一个最小申赎单位
+    struct ETFComponent
+    {
+        Symbol                                      symbol;
+        int64_t                                     quantity = 0;
+        CashReplaceType                             replace_type = CashReplaceType::UNKNOWN;
+        double                                      premium_ratio = 0.;         // 现金替代溢价比例
+        double                                      creation_amount = 0.;       // 必须现金替代时申购替代金额
+        double                                      redemption_amount = 0.;     // 必须现金替代时赎回替代金额
     };
     struct ETFDetail
     {
         Symbol                                      symbol;
-        std::vector<Symbol>                         component;
+        std::vector<ETFComponent>                   component;
+        int64_t                                     unit = 0;                   // 最小申赎单位份数
+        double                                      estimate_cash_component = 0.;   // T日预估现金差额
+        double                                      cash_component = 0.;        // T-1日现金差额
+        double                                      max_cash_ratio = 0.;        // 最大现金替代比例
+        double                                      net_value = 0.;             // T-1日基金份额净值
+        bool                                        creation_allowed = false;
+        bool                                        redemption_allowed = false;
     };
     struct BarData
     {
@@ -158,6 +287,11 @@ namespace rk::data_type
         uint32_t                                    position = 0;
         uint32_t                                    frozen = 0;
         uint32_t                                    pending = 0;
+        uint32_t                                    yd_position = 0;    // 昨仓(股票为可卖)
+        uint32_t                                    yd_frozen = 0;      // 平昨冻结
+        double                                      cost = 0.;          // 持仓成本(价格*数量*乘数)
+        double                                      margin = 0.;        // 占用保证金
+        double                                      profit = 0.;        // 持仓盈亏(盯市)
         [[nodiscard]] bool empty() const {return !position && !frozen && !pending;}
         bool operator==(const PositionInfo& other) const
         {
@@ -189,6 +323,23 @@ namespace rk::data_type
         {
             return long_position.empty() && short_position.empty();
         }
+        // 平仓报单的可平数量, 上期所/能源中心区分平今平昨, 股票/ETF仅昨仓可卖
+        [[nodiscard]] uint32_t closable_volume(Direction direction, Offset offset) const
+        {
+            const auto& info = direction == Direction::LONG ? short_position : long_position;
+            const auto available = [](uint32_t volume, uint32_t frozen) {return volume > frozen ? volume - frozen : 0u;};
+            // 今昨分别可平, 且不超过总持仓扣除全部平仓冻结(不区分今昨的平仓冻结不计入yd_frozen)
+            const auto total = available(info.position, info.frozen);
+            if (offset == Offset::CLOSE_TD)
+            {
+                return std::min(available(info.position - info.yd_position, info.frozen - info.yd_frozen), total);
+            }
+            if (symbol.is_close_yesterday(offset))
+            {
+                return std::min(available(info.yd_position, info.yd_frozen), total);
+            }
+            return total;
+        }
     };
     struct OrderReq
     {
@@ -205,21 +356,21 @@ namespace rk::data_type
         OrderReq                                    order_req;
         uint32_t                                    trading_day = 0;
         util::DateTime                              req_time;
+        OrderStatus                                 status = OrderStatus::UNKNOWN;
         uint32_t                                    traded_volume = 0;
         uint32_t                                    remain_volume = 0;
         uint32_t                                    canceled_volume = 0;
         [[nodiscard]] bool is_rejected() const
         {
-            return (
-                order_req.volume != 0 &&
-                order_req.volume != (traded_volume + remain_volume + canceled_volume)
-            );
+            return status == OrderStatus::REJECTED;
         }
         [[nodiscard]] bool is_finished() const
         {
             return (
-                is_rejected() ||
-                remain_volume == 0
+                status == OrderStatus::REJECTED ||
+                status == OrderStatus::ALL_TRADED ||
+                status == OrderStatus::ALL_CANCELED ||
+                status == OrderStatus::PARTIAL_CANCELED
             );
         }
     };
@@ -247,7 +398,8 @@ namespace rk::data_type
         double                                      frozen_margin = 0;
         double                                      commission = 0;
         double                                      available = 0;
-
+        double                                      close_profit = 0.;
+        double                                      position_profit = 0.;
     };
     struct CancelData
     {
@@ -272,6 +424,96 @@ namespace rk::data_type
         util::DateTime                              start_time;
         util::DateTime                              end_time;
     };
+    // 组合下单, 各腿价格和数量预先算好, 作为一个逻辑订单报出
+    struct BasketReq
+    {
+        util::FixedString<32>                       basket_name;
+        std::vector<OrderReq>                       legs;
+    };
+    // 组合进度, 按腿汇总
+    struct BasketProgress
+    {
+        BasketId                                    basket_id = 0;
+        BasketStatus                                status = BasketStatus::UNKNOWN;
+        uint32_t                                    leg_num = 0;
+        uint32_t                                    sent_leg_num = 0;
+        uint32_t                                    rejected_leg_num = 0;       // 风控或柜台拒单
+        uint32_t                                    traded_leg_num = 0;         // 全部成交
+        uint32_t                                    finished_leg_num = 0;
+        uint32_t                                    cancel_failed_leg_num = 0;  // 撤单被风控拒绝且重试用尽的在途腿, 可再次撤组合重试
+        double                                      target_amount = 0.;         // 各腿委托金额之和
+        double                                      traded_amount = 0.;
+        double                                      long_traded_amount = 0.;
+        double                                      short_traded_amount = 0.;
+        double                                      min_fill_ratio = 0.;        // 各腿成交比例的最小/最大值, 差值为腿间不同步程度
+        double                                      max_fill_ratio = 0.;
+        util::DateTime                              update_time;
+        // 腿风险: 已成交多空金额差
+        [[nodiscard]] double net_exposure() const
+        {
+            return long_traded_amount - short_traded_amount;
+        }
+        [[nodiscard]] bool is_finished() const
+        {
+            return status == BasketStatus::FINISHED;
+        }
+    };
+    // 价差组合腿, 价差价格 = sum(ratio * 腿价格), 买入组合时ratio为正的腿买入、为负的腿卖出
+    struct SpreadLeg
+    {
+        Symbol                                      symbol;
+        int32_t                                     ratio = 0;
+    };
+    struct SpreadDetail
+    {
+        util::FixedString<32>                       spread_name;
+        std::vector<SpreadLeg>                      legs;
+    };
+    // 由各腿一档盘口合成的价差盘口, 数量为按比例可成交的组合数
+    struct SpreadTick
+    {
+        SpreadId                                    spread_id = 0;
+        util::DateTime                              update_time;
+        double                                      bid_price = 0.;
+        double                                      ask_price = 0.;
+        uint32_t                                    bid_volume = 0;
+        uint32_t                                    ask_volume = 0;
+    };
+    struct SpreadOrderReq
+    {
+        SpreadId                                    spread_id = 0;
+        double                                      limit_price = 0.;           // 价差限价
+        uint32_t                                    volume = 0;                 // 组合数
+        Direction                                   direction = Direction::UNKNOWN;
+        Offset                                      offset = Offset::OPEN;      // 各腿统一开平
+        uint32_t                                    hedge_slippage = 1;         // 对冲腿超价跳数
+    };
+    struct SpreadOrderData
+    {
+        uint32_t                                    spread_order_id = 0;
+        SpreadOrderReq                              req;
+        SpreadOrderStatus                           status = SpreadOrderStatus::UNKNOWN;
+        uint32_t                                    traded_volume = 0;          // 各腿已配平的组合数
+        double                                      traded_price = 0.;          // 按各腿成交均价合成的价差
+        util::DateTime                              update_time;
+        [[nodiscard]] bool is_finished() const
+        {
+            return status == SpreadOrderStatus::FINISHED || status == SpreadOrderStatus::CANCELED || status == SpreadOrderStatus::HEDGE_FAILED;
+        }
+    };
+    // 价差组合持仓, 由各腿成交累加, 与合约持仓并存
+    struct SpreadPositionData
+    {
+        SpreadId                                    spread_id = 0;
+        SpreadDetail                                detail;
+        int64_t                                     position = 0;               // 已配平组合数, 正为多头
+        std::vector<int64_t>                        leg_position;               // 各腿净成交手数, 正为买入
+        std::vector<double>                         leg_multiplier;
+        std::vector<double>                         leg_last_price;
+        double                                      cash = 0.;                  // 各腿成交资金流, 买入为负
+        double                                      fee = 0.;
+        double                                      profit = 0.;                // 按各腿最新价盯市, 扣除手续费
+    };
 
 };
 
@@ -336,7 +578,8 @@ namespace rk::data_type
             {"close_fee_rate_by_money", s.close_fee_rate_by_money},
             {"close_fee_rate_by_volume", s.close_fee_rate_by_volume},
             {"close_today_fee_rate_by_money", s.close_today_fee_rate_by_money},
-            {"close_today_fee_rate_by_volume", s.close_today_fee_rate_by_volume}
+            {"close_today_fee_rate_by_volume", s.close_today_fee_rate_by_volume},
+            {"pre_close_price", s.pre_close_price}
         };
     }
     inline void to_json(nlohmann::ordered_json& j, const BarData& b) {
@@ -356,7 +599,12 @@ namespace rk::data_type
         j = nlohmann::ordered_json{
             {"position", p.position},
             {"frozen", p.frozen},
-            {"pending", p.pending}
+            {"pending", p.pending},
+            {"yd_position", p.yd_position},
+            {"yd_frozen", p.yd_frozen},
+            {"cost", p.cost},
+            {"margin", p.margin},
+            {"profit", p.profit}
         };
     }
     inline void to_json(nlohmann::ordered_json& j, const PositionData& p) {
@@ -381,7 +629,7 @@ namespace rk::data_type
             {"order_req", o.order_req},
             {"trading_day", o.trading_day},
             {"req_time", o.req_time.strftime()},
-            // {"status", o.status},
+            {"status", magic_enum::enum_name(o.status)},
             {"traded_volume", o.traded_volume},
             {"remain_volume", o.remain_volume},
             {"canceled_volume", o.canceled_volume}
@@ -412,6 +660,8 @@ namespace rk::data_type
             {"frozen_margin", t.frozen_margin},
             {"commission", t.commission},
             {"available", t.available},
+            {"close_profit", t.close_profit},
+            {"position_profit", t.position_profit},
         };
     }
     inline void to_json(nlohmann::ordered_json& j, const CancelData& c) {
@@ -440,6 +690,38 @@ namespace rk::data_type
             {"end_time", e.end_time.strftime()},
         };
     }
+    inline void to_json(nlohmann::ordered_json& j, const SpreadOrderData& o) {
+        j = nlohmann::ordered_json{
+            {"spread_order_id", o.spread_order_id},
+            {"spread_id", o.req.spread_id},
+            {"limit_price", o.req.limit_price},
+            {"volume", o.req.volume},
+            {"direction", magic_enum::enum_name(o.req.direction)},
+            {"offset", magic_enum::enum_name(o.req.offset)},
+            {"status", magic_enum::enum_name(o.status)},
+            {"traded_volume", o.traded_volume},
+            {"traded_price", o.traded_price},
+            {"update_time", o.update_time.strftime()},
+        };
+    }
+    inline void to_json(nlohmann::ordered_json& j, const BasketProgress& b) {
+        j = nlohmann::ordered_json{
+            {"basket_id", b.basket_id},
+            {"status", magic_enum::enum_name(b.status)},
+            {"leg_num", b.leg_num},
+            {"sent_leg_num", b.sent_leg_num},
+            {"rejected_leg_num", b.rejected_leg_num},
+            {"traded_leg_num", b.traded_leg_num},
+            {"finished_leg_num", b.finished_leg_num},
+            {"cancel_failed_leg_num", b.cancel_failed_leg_num},
+            {"target_amount", b.target_amount},
+            {"traded_amount", b.traded_amount},
+            {"net_exposure", b.net_exposure()},
+            {"min_fill_ratio", b.min_fill_ratio},
+            {"max_fill_ratio", b.max_fill_ratio},
+            {"update_time", b.update_time.strftime()},
+        };
+    }
 
 };
 
@@ -450,7 +732,7 @@ namespace std
     {
         size_t operator()(const rk::data_type::Symbol& s) const noexcept
         {
-            return std::hash<std::string_view>{}(s.symbol.view());
+            return s.symbol.hash();
         };
     };
     template<>
@@ -496,6 +778,7 @@ namespace rk::ipc
         SUBSCRIBE,
         UNSUBSCRIBE,
         QUERY_SYMBOL_DETAIL,
+        ALGO_INSERT,
     };
     struct ReqData
     {
@@ -515,6 +798,11 @@ namespace rk::ipc
     {
         std::span<const data_type::Symbol> symbol_list;
     };
+    // 一条请求携带整批算法目标
+    struct AlgoInsertReq
+    {
+        std::span<const data_type::AlgoReq> algo_req_list;
+    };
     struct RspData
     {
         bool res = false;
@@ -533,6 +821,10 @@ namespace rk::ipc
     struct QuerySymbolDetailRsp
     {
         std::span<const data_type::SymbolDetail> symbol_detail_list;
+    };
+    struct AlgoInsertRsp
+    {
+
     };
     enum class PubDataType: uint8_t
     {
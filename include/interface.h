@@ -20,6 +20,13 @@ namespace rk::interface
         virtual void on_cancel(const data_type::CancelData& data) {};
         virtual void on_error(const data_type::OrderError& data) {};
         virtual void on_algo_req(const data_type::AlgoReq& data) {};
+        // 组合子单成交、撤单、拒单后推送组合进度
+        virtual void on_basket(const data_type::BasketProgress& data) {};
+        // 价差组合任一腿盘口变化后推送合成盘口
+        virtual void on_spread_tick(const data_type::SpreadTick& data) {};
+        virtual void on_spread_order(const data_type::SpreadOrderData& data) {};
+        // EngineImpl::schedule_timer定时到期, 在引擎线程回调
+        virtual void on_timer(uint32_t timer_id) {};
     };
 
 };
\ No newline at end of file
@@ -4,10 +4,70 @@
 
 #pragma once
 #include <string>
+#include <cctype>
 #include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <format>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
 #include <string_view>
 namespace rk::util
 {
+    namespace detail
+    {
+        // 公历日期与1970-01-01起天数互转, 纯整数运算, 算法见Howard Hinnant的chrono-Compatible Low-Level Date Algorithms
+        constexpr int64_t days_from_civil(int64_t year, unsigned month, unsigned day)
+        {
+            year -= month <= 2;
+            const int64_t era = (year >= 0 ? year : year - 399) / 400;
+            const auto yoe = static_cast<unsigned>(year - era * 400);
+            const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + static_cast<int64_t>(doe) - 719468;
+        }
+        struct CivilDate
+        {
+            int year;
+            unsigned month;
+            unsigned day;
+        };
+        constexpr CivilDate civil_from_days(int64_t days)
+        {
+            days += 719468;
+            const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            const auto doe = static_cast<unsigned>(days - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+            const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+            return {static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (month <= 2)), month, doy - (153 * mp + 2) / 5 + 1};
+        }
+        static_assert(days_from_civil(1970, 1, 1) == 0);
+        static_assert(civil_from_days(days_from_civil(2024, 2, 29)).day == 29);
+        // 定宽十进制, 不足补0
+        inline char* write_digits(char* out, uint64_t value, int width)
+        {
+            for (int i = width - 1; i >= 0; --i)
+            {
+                out[i] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            return out + width;
+        }
+        // 读取1~max_width位数字, 与std::get_time一致允许位数不足
+        inline bool parse_digits(std::string_view s, size_t& pos, int max_width, int& value)
+        {
+            const auto begin = pos;
+            value = 0;
+            while (pos < s.size() && pos - begin < static_cast<size_t>(max_width) && s[pos] >= '0' && s[pos] <= '9')
+            {
+                value = value * 10 + (s[pos++] - '0');
+            }
+            return pos != begin;
+        }
+    }
     class DateTime;
     class TimeDelta
     {
@@ -93,144 +153,118 @@ namespace rk::util
             int microsecond = 0;
             int nanosecond = 0;
         };
+        // 本地时间, 按缓存的时区偏移换算, 越界的月/日/时分秒与mktime一样顺延
         explicit DateTime(const keyword_args& _keyword_args)
         {
-            std::tm tm = {};
-            tm.tm_year = _keyword_args.year - 1900;
-            tm.tm_mon = _keyword_args.month - 1;
-            tm.tm_mday = _keyword_args.day;
-            tm.tm_hour = _keyword_args.hour;
-            tm.tm_min = _keyword_args.minute;
-            tm.tm_sec = _keyword_args.second;
-            tm.tm_isdst = -1;  // 自动判断夏令时
-
-            std::time_t tt = std::mktime(&tm);
-            if (tt == -1) throw std::invalid_argument("Invalid date/time");
-            _time_point = std::chrono::system_clock::from_time_t(tt);
+            const auto months = static_cast<int64_t>(_keyword_args.year) * 12 + _keyword_args.month - 1;
+            const auto year = (months >= 0 ? months : months - 11) / 12;
+            const auto month = static_cast<unsigned>(months - year * 12 + 1);
+            const auto days = detail::days_from_civil(year, month, 1) + _keyword_args.day - 1;
+            const auto seconds = days * 86400 + _keyword_args.hour * 3600 + _keyword_args.minute * 60 + _keyword_args.second - utc_offset();
+            _time_point = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
             _sub_second = std::chrono::milliseconds{_keyword_args.millisecond} +
                                std::chrono::microseconds{_keyword_args.microsecond} +
                                std::chrono::nanoseconds{_keyword_args.nanosecond};
-            _time_point += _sub_second;
+            _time_point += std::chrono::duration_cast<std::chrono::system_clock::duration>(_sub_second);
         }
         static DateTime now()
         {
             return DateTime(std::chrono::high_resolution_clock::now());
         }
+        // 本地时区相对UTC的偏移(秒), 进程内首次调用时确定, 交易所时区无夏令时
+        static int64_t utc_offset()
+        {
+            static const int64_t offset = []() -> int64_t
+            {
+                std::time_t tt = std::time(nullptr);
+                std::tm tm = {};
+                localtime_r(&tt, &tm);
+                return tm.tm_gmtoff;
+            }();
+            return offset;
+        }
+        // 支持%Y %m %d %H %M %S %%, 格式中的空白匹配任意空白; 其余格式符回退std::get_time
         static DateTime strptime(
-            const std::string& datetime_string,
+            std::string_view datetime_string,
             std::string_view format="%Y-%m-%d %H:%M:%S",
             unsigned int milliseconds = 0,
             unsigned int microseconds = 0,
             unsigned int nanoseconds = 0
         )
         {
-            std::tm tm = {};
-            std::istringstream ss(datetime_string);
-            ss >> std::get_time(&tm, format.data());
-            if (ss.fail())
-                throw std::invalid_argument(std::format("Failed to parse date string with format: {}", format));
-            std::time_t tt = std::mktime(&tm);
-            if (tt == -1)
-                throw std::invalid_argument("Invalid date/time");
-            auto tp = std::chrono::system_clock::from_time_t(tt);
-
-            // 添加亚秒部分
-            tp += std::chrono::milliseconds{milliseconds} +
-                  std::chrono::microseconds{microseconds} +
-                  std::chrono::nanoseconds{nanoseconds};
-
-            return DateTime(tp);
+            keyword_args args{1900, 1, 1};
+            bool supported = true;
+            if (!parse(datetime_string, format, args, supported))
+            {
+                if (supported)
+                    throw std::invalid_argument(std::format("Failed to parse date string with format: {}", format));
+                return strptime_fallback(datetime_string, format, milliseconds, microseconds, nanoseconds);
+            }
+            args.millisecond = static_cast<int>(milliseconds);
+            args.microsecond = static_cast<int>(microseconds);
+            args.nanosecond = static_cast<int>(nanoseconds);
+            return DateTime(args);
+        }
+        // 日期与时间分开的字段, 例如CTP的"20251023"与"09:30:01"
+        static DateTime strptime_date_time(std::string_view date_string, std::string_view time_string, unsigned int milliseconds = 0)
+        {
+            keyword_args args{1900, 1, 1};
+            bool supported = true;
+            if (!parse(date_string, "%Y%m%d", args, supported) || !parse(time_string, "%H:%M:%S", args, supported))
+                throw std::invalid_argument(std::format("Failed to parse date string: {} {}", date_string, time_string));
+            args.millisecond = static_cast<int>(milliseconds);
+            return DateTime(args);
         }
+        // 支持%Y %m %d %H %M %S %%及亚秒%f/%6(微秒) %3(毫秒) %9(纳秒), 其余格式符回退std::strftime
         [[nodiscard]] std::string strftime(std::string_view format="%Y-%m-%d %H:%M:%S.%f") const
         {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-
-            std::string modified_format{format};
-
-            // 获取亚秒部分
-            auto duration = _time_point.time_since_epoch();
-            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
-            auto sub_second = duration - seconds;
-
-            auto total_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(sub_second).count();
-            auto millis = total_nanos / 1000000;
-//            auto micros = (total_nanos % 1000000) / 1000;
-//            auto nanos = total_nanos % 1000;
-
-            // 替换 %f (微秒，6位)
-            size_t f_pos = modified_format.find("%f");
-            if (f_pos != std::string::npos) {
-                std::stringstream ss;
-                ss << std::setfill('0') << std::setw(6) << (total_nanos / 1000);
-                modified_format.replace(f_pos, 2, ss.str());
-            }
-
-            // 替换 %3 (毫秒)
-            size_t ms_pos = modified_format.find("%3");
-            if (ms_pos != std::string::npos) {
-                std::stringstream ss;
-                ss << std::setfill('0') << std::setw(3) << millis;
-                modified_format.replace(ms_pos, 2, ss.str());
-            }
-
-            // 替换 %6 (微秒)
-            size_t us_pos = modified_format.find("%6");
-            if (us_pos != std::string::npos) {
-                std::stringstream ss;
-                ss << std::setfill('0') << std::setw(6) << (total_nanos / 1000);
-                modified_format.replace(us_pos, 2, ss.str());
-            }
-
-            // 替换 %9 (纳秒)
-            size_t ns_pos = modified_format.find("%9");
-            if (ns_pos != std::string::npos) {
-                std::stringstream ss;
-                ss << std::setfill('0') << std::setw(9) << total_nanos;
-                modified_format.replace(ns_pos, 2, ss.str());
-            }
-
             char buffer[256];
-            if (std::strftime(buffer, sizeof(buffer), modified_format.c_str(), tm) == 0) {
-                throw std::runtime_error("Failed to format date");
-            }
-
-            return buffer;
-        }
-        [[nodiscard]] int year() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_year + 1900;
+            return {buffer, strftime(buffer, sizeof(buffer), format)};
         }
-        [[nodiscard]] int month() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_mon + 1;
-        }
-        [[nodiscard]] int day() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_mday;
-        }
-        [[nodiscard]] int hour() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_hour;
-        }
-        [[nodiscard]] int minute() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_min;
-        }
-        [[nodiscard]] int second() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_sec;
+        // 写入调用方缓冲区, 返回写入长度, 不分配内存
+        size_t strftime(char* out, size_t capacity, std::string_view format) const
+        {
+            const auto fields = local_fields();
+            size_t size = 0;
+            for (size_t i = 0; i < format.size(); ++i)
+            {
+                // 单个格式符最多写9个字符
+                if (size + 9 > capacity) throw std::runtime_error("Failed to format date");
+                if (format[i] != '%' || i + 1 == format.size())
+                {
+                    out[size++] = format[i];
+                    continue;
+                }
+                char* pos = out + size;
+                switch (format[++i])
+                {
+                    case 'Y': pos = detail::write_digits(pos, fields.year, 4); break;
+                    case 'm': pos = detail::write_digits(pos, fields.month, 2); break;
+                    case 'd': pos = detail::write_digits(pos, fields.day, 2); break;
+                    case 'H': pos = detail::write_digits(pos, fields.hour, 2); break;
+                    case 'M': pos = detail::write_digits(pos, fields.minute, 2); break;
+                    case 'S': pos = detail::write_digits(pos, fields.second, 2); break;
+                    case 'f':
+                    case '6': pos = detail::write_digits(pos, fields.nanosecond / 1000, 6); break;
+                    case '3': pos = detail::write_digits(pos, fields.nanosecond / 1000000, 3); break;
+                    case '9': pos = detail::write_digits(pos, fields.nanosecond, 9); break;
+                    case '%': *pos++ = '%'; break;
+                    default: return strftime_fallback(out, capacity, format);
+                }
+                size = pos - out;
+            }
+            return size;
         }
+        [[nodiscard]] int year() const {return local_fields().year;}
+        [[nodiscard]] int month() const {return local_fields().month;}
+        [[nodiscard]] int day() const {return local_fields().day;}
+        [[nodiscard]] int hour() const {return static_cast<int>(local_seconds_of_day() / 3600);}
+        [[nodiscard]] int minute() const {return static_cast<int>(local_seconds_of_day() / 60 % 60);}
+        [[nodiscard]] int second() const {return static_cast<int>(local_seconds_of_day() % 60);}
+        // 0为周日, 与tm_wday一致
         [[nodiscard]] int weekday() const {
-            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
-            std::tm* tm = std::localtime(&tt);
-            return tm->tm_wday;
+            const auto days = floor_div(local_seconds(), 86400);
+            return static_cast<int>((days % 7 + 11) % 7);
         }
         [[nodiscard]] int millisecond() const {
             auto duration = _time_point.time_since_epoch();
@@ -238,6 +272,11 @@ namespace rk::util
             auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration - seconds);
             return millis.count();
         }
+        // 本地日期, 形如20251023
+        [[nodiscard]] uint32_t date() const {
+            const auto fields = local_fields();
+            return static_cast<uint32_t>(fields.year * 10000 + fields.month * 100 + fields.day);
+        }
         TimeDelta operator-(const DateTime& other) const {return TimeDelta(_time_point - other._time_point);}
         DateTime operator+(const TimeDelta& delta) const {return DateTime(_time_point + delta._duration);}
         DateTime operator-(const TimeDelta& delta) const {return DateTime(_time_point - delta._duration);}
@@ -249,6 +288,128 @@ namespace rk::util
         bool operator!=(const DateTime& other) const {return _time_point != other._time_point;}
 
     private:
+        struct LocalFields
+        {
+            int year;
+            int month;
+            int day;
+            int hour;
+            int minute;
+            int second;
+            int64_t nanosecond;
+        };
+        static int64_t floor_div(int64_t a, int64_t b) {return a / b - (a % b < 0);}
+        [[nodiscard]] int64_t local_seconds() const
+        {
+            return std::chrono::floor<std::chrono::seconds>(_time_point.time_since_epoch()).count() + utc_offset();
+        }
+        [[nodiscard]] int64_t local_seconds_of_day() const
+        {
+            const auto seconds = local_seconds();
+            return seconds - floor_div(seconds, 86400) * 86400;
+        }
+        [[nodiscard]] LocalFields local_fields() const
+        {
+            const auto seconds = local_seconds();
+            const auto days = floor_div(seconds, 86400);
+            const auto seconds_of_day = seconds - days * 86400;
+            const auto date = detail::civil_from_days(days);
+            const auto duration = _time_point.time_since_epoch();
+            return {
+                date.year,
+                static_cast<int>(date.month),
+                static_cast<int>(date.day),
+                static_cast<int>(seconds_of_day / 3600),
+                static_cast<int>(seconds_of_day / 60 % 60),
+                static_cast<int>(seconds_of_day % 60),
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration - std::chrono::floor<std::chrono::seconds>(duration)).count()
+            };
+        }
+        // 解析失败返回false, 遇到不支持的格式符时supported置为false
+        static bool parse(std::string_view s, std::string_view format, keyword_args& args, bool& supported)
+        {
+            size_t pos = 0;
+            for (size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] == ' ')
+                {
+                    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+                    continue;
+                }
+                if (format[i] != '%' || i + 1 == format.size())
+                {
+                    if (pos == s.size() || s[pos] != format[i]) return false;
+                    ++pos;
+                    continue;
+                }
+                bool ok;
+                switch (format[++i])
+                {
+                    case 'Y': ok = detail::parse_digits(s, pos, 4, args.year); break;
+                    case 'm': ok = detail::parse_digits(s, pos, 2, args.month) && args.month >= 1 && args.month <= 12; break;
+                    case 'd': ok = detail::parse_digits(s, pos, 2, args.day) && args.day >= 1 && args.day <= 31; break;
+                    case 'H': ok = detail::parse_digits(s, pos, 2, args.hour) && args.hour <= 23; break;
+                    case 'M': ok = detail::parse_digits(s, pos, 2, args.minute) && args.minute <= 59; break;
+                    case 'S': ok = detail::parse_digits(s, pos, 2, args.second) && args.second <= 60; break;
+                    case '%': ok = pos < s.size() && s[pos++] == '%'; break;
+                    default: supported = false; return false;
+                }
+                if (!ok) return false;
+            }
+            return true;
+        }
+        static DateTime strptime_fallback(
+            std::string_view datetime_string,
+            std::string_view format,
+            unsigned int milliseconds,
+            unsigned int microseconds,
+            unsigned int nanoseconds
+        )
+        {
+            std::tm tm = {};
+            std::istringstream ss{std::string(datetime_string)};
+            ss >> std::get_time(&tm, std::string(format).c_str());
+            if (ss.fail())
+                throw std::invalid_argument(std::format("Failed to parse date string with format: {}", format));
+            std::time_t tt = std::mktime(&tm);
+            if (tt == -1)
+                throw std::invalid_argument("Invalid date/time");
+            auto tp = std::chrono::system_clock::from_time_t(tt);
+
+            // 添加亚秒部分
+            tp += std::chrono::milliseconds{milliseconds} +
+                  std::chrono::microseconds{microseconds} +
+                  std::chrono::nanoseconds{nanoseconds};
+
+            return DateTime(tp);
+        }
+        size_t strftime_fallback(char* out, size_t capacity, std::string_view format) const
+        {
+            std::time_t tt = std::chrono::system_clock::to_time_t(_time_point);
+            std::tm tm = {};
+            localtime_r(&tt, &tm);
+
+            std::string modified_format{format};
+            const auto total_nanos = local_fields().nanosecond;
+            // 替换亚秒格式符, %f/%6为微秒, %3为毫秒, %9为纳秒
+            const std::pair<std::string_view, std::string> sub_seconds[] = {
+                {"%f", std::format("{:06}", total_nanos / 1000)},
+                {"%3", std::format("{:03}", total_nanos / 1000000)},
+                {"%6", std::format("{:06}", total_nanos / 1000)},
+                {"%9", std::format("{:09}", total_nanos)},
+            };
+            for (const auto& [spec, value] : sub_seconds)
+            {
+                size_t spec_pos = modified_format.find(spec);
+                if (spec_pos != std::string::npos) modified_format.replace(spec_pos, 2, value);
+            }
+            const auto size = std::strftime(out, capacity, modified_format.c_str(), &tm);
+            if (size == 0) {
+                throw std::runtime_error("Failed to format date");
+            }
+            return size;
+        }
+
         std::chrono::system_clock::time_point _time_point{};
         std::chrono::nanoseconds _sub_second{};
     };
@@ -1,17 +1,81 @@
 #pragma once
 #include <array>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <string_view>
 #include <cstring>
 #include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace rk::util
 {
+    namespace detail
+    {
+        // 定长缓冲区整块比较, 依赖assign保证有效内容之后全部补0
+        template<size_t N>
+        inline bool fixed_buffer_equal(const char* a, const char* b)
+        {
+#if defined(__AVX2__)
+            if constexpr (N % 32 == 0)
+            {
+                for (size_t i = 0; i < N; i += 32)
+                {
+                    const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                    const auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                    if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))) != 0xFFFFFFFFu) return false;
+                }
+                return true;
+            }
+#endif
+#if defined(__SSE2__)
+            if constexpr (N % 16 == 0)
+            {
+                for (size_t i = 0; i < N; i += 16)
+                {
+                    const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                    const auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF) return false;
+                }
+                return true;
+            }
+#endif
+            return std::memcmp(a, b, N) == 0;
+        }
+        // 按8字节字混合整个缓冲区, 末尾用murmur3的fmix64打散
+        template<size_t N>
+        inline size_t fixed_buffer_hash(const char* p)
+        {
+            uint64_t h = 0x9E3779B97F4A7C15ull ^ N;
+            size_t i = 0;
+            for (; i + 8 <= N; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, p + i, 8);
+                h = (std::rotl(h, 5) ^ word) * 0x9E3779B97F4A7C15ull;
+            }
+            if constexpr (N % 8 != 0)
+            {
+                uint64_t word = 0;
+                std::memcpy(&word, p + i, N % 8);
+                h = (std::rotl(h, 5) ^ word) * 0x9E3779B97F4A7C15ull;
+            }
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+    }
     template<size_t N>
     struct FixedString {
-        // 唯一的成员数据，确保内存布局紧凑
-        // 初始化为全0，保证如果不满有默认的终止符
-        std::array<char, N> buffer{};
+        using size_type = std::conditional_t<(N <= std::numeric_limits<uint8_t>::max()), uint8_t, uint32_t>;
 
         // =========================================================
         // 构造函数
@@ -29,42 +93,40 @@ namespace rk::util
             assign(sv);
         }
 
-        constexpr FixedString(std::string str) {
-            assign(str.c_str());
+        // 按引用接收, 避免拷贝std::string产生的堆分配
+        constexpr FixedString(const std::string& str) {
+            assign(std::string_view(str));
         }
         // =========================================================
         // 核心赋值逻辑
         // =========================================================
 
+        // 超过N截断, 有效内容之后全部补0, 整块比较和哈希依赖这一点
         constexpr void assign(std::string_view sv) {
-            // 先清空（或者至少保证新内容之后是0），这里选择逐个填充
-            // 如果追求极致性能，非 constexpr 环境可以用 memset/memcpy，但在 C++20 中 loop 也会被优化得很好
-            size_t count = std::min(N, sv.size());
-            for (size_t i = 0; i < count; ++i) {
-                buffer[i] = sv[i];
+            const size_t count = std::min(N, sv.size());
+            if (!std::is_constant_evaluated()) {
+                std::memcpy(_buffer.data(), sv.data(), count);
+                std::memset(_buffer.data() + count, 0, N - count);
             }
-            // 如果原始字符串比 N 短，后面补零；如果长，截断且末尾可能无 \0
-            // 为了安全，如果还有空间，手动补一个 \0 (可选策略，看具体协议需求)
-            // 这里采用最原始策略：只拷贝，剩下的保持初始化时的0
-            if (count < N) {
-                for (size_t i = count; i < N; ++i) buffer[i] = '\0';
+            else {
+                for (size_t i = 0; i < N; ++i) _buffer[i] = i < count ? sv[i] : '\0';
             }
+            _length = static_cast<size_type>(count);
         }
 
         constexpr void assign(const char* str) {
             if (!str) {
-                *this = FixedString(); // 重置为0
+                assign(std::string_view());
                 return;
             }
-            // 手写循环以支持 constexpr strlen
-            size_t i = 0;
-            for (; i < N && str[i] != '\0'; ++i) {
-                buffer[i] = str[i];
-            }
-            // 填充剩余部分为 0
-            for (; i < N; ++i) {
-                buffer[i] = '\0';
+            // 最多读N个字符, 不要求str以'\0'结尾
+            if (!std::is_constant_evaluated()) {
+                assign(std::string_view(str, strnlen(str, N)));
+                return;
             }
+            size_t count = 0;
+            while (count < N && str[count] != '\0') ++count;
+            assign(std::string_view(str, count));
         }
 
         // =========================================================
@@ -87,15 +149,9 @@ namespace rk::util
         // =========================================================
 
         // 转为 string_view，这是现代 C++ 交互的核心接口
-        // 注意：由于 buffer 可能不以 \0 结尾（如果填满了），我们需要检测实际长度
+        // 长度在assign时记录, 不再查找'\0'
         constexpr std::string_view view() const {
-            // 寻找第一个 \0，或者取 N
-            // 在 C++20 constexpr 中不能用 memchr，手写查找
-            size_t len = 0;
-            for (; len < N; ++len) {
-                if (buffer[len] == '\0') break;
-            }
-            return std::string_view(buffer.data(), len);
+            return std::string_view(_buffer.data(), _length);
         }
 
         // 隐式转换为 string_view，方便直接传参
@@ -103,28 +159,28 @@ namespace rk::util
             return view();
         }
 
-        // 获取原始指针 (慎用，不一定有 \0 结尾)
-        constexpr const char* data() const { return buffer.data(); }
-        constexpr const char* c_str() const { return buffer.data(); }
-        constexpr char* data() { return buffer.data(); }
+        // 获取原始指针 (慎用，填满时没有 \0 结尾); 只读, 修改内容须经assign以维护长度和补0
+        constexpr const char* data() const { return _buffer.data(); }
+        constexpr const char* c_str() const { return _buffer.data(); }
 
 
-        constexpr size_t size() const { return view().size(); }
+        constexpr size_t size() const { return _length; }
         constexpr size_t capacity() const { return N; }
-        constexpr bool empty() const { return buffer[0] == '\0'; }
+        constexpr bool empty() const { return _length == 0; }
 
         // =========================================================
         // 比较操作符 (C++20 spaceship operator)
         // =========================================================
 
         // 支持与另一个 FixedString 比较
-        auto operator<(const FixedString& other) const
+        // 有效内容之后全部补0, 整块比较与按字符串比较结果一致
+        bool operator<(const FixedString& other) const
         {
-            return view() < other.view();
+            return std::memcmp(_buffer.data(), other._buffer.data(), N) < 0;
         }
-        auto operator==(const FixedString& other) const
+        bool operator==(const FixedString& other) const
         {
-            return view() == other.view();
+            return _length == other._length && detail::fixed_buffer_equal<N>(_buffer.data(), other._buffer.data());
         }
         // 支持与 const char* 比较
         constexpr bool operator==(const char* other) const {
@@ -134,8 +190,24 @@ namespace rk::util
         // 支持与 string_view 比较
 
         std::string to_string() const {
-            return data();
+            return std::string(view());
+        }
+        // 非加密哈希, 整块计算不查找'\0'
+        size_t hash() const {
+            return detail::fixed_buffer_hash<N>(_buffer.data());
         }
 
+    private:
+        // 初始化为全0，保证如果不满有默认的终止符
+        std::array<char, N> _buffer{};
+        size_type _length = 0;
     };
-}
\ No newline at end of file
+}
+template<size_t N>
+struct std::hash<rk::util::FixedString<N>>
+{
+    size_t operator()(const rk::util::FixedString<N>& s) const noexcept
+    {
+        return s.hash();
+    }
+};
@@ -0,0 +1,302 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rk::util
+{
+    /// 整数键哈希, std::hash对整数是恒等映射, 步长规律的键(如逐笔序号)取低位会聚集, 用murmur3的fmix64打散
+    struct IntegerHash
+    {
+        size_t operator()(uint64_t x) const noexcept
+        {
+            x ^= x >> 33;
+            x *= 0xFF51AFD7ED558CCDull;
+            x ^= x >> 33;
+            x *= 0xC4CEB9FE1A85EC53ull;
+            x ^= x >> 33;
+            return static_cast<size_t>(x);
+        }
+    };
+    /// 开放寻址哈希表, 线性探测, 删除时后移回填不留墓碑
+    /// 每个槽位保存哈希高32位作为标签, 探测时先比标签再比键, FixedString键基本不需要逐字节比较
+    /// 元素平铺在连续数组中, 扩容会搬移元素, 插入可能使引用和迭代器失效, 热路径前应先reserve
+    /// 不要通过迭代器修改键
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class FlatMap
+    {
+        static constexpr uint32_t empty_tag = 0;
+        static constexpr size_t min_capacity = 16;
+        template<typename Owner, typename Element>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::pair<Key, Value>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Element*;
+            using reference = Element&;
+            Iterator() = default;
+            Iterator(Owner* owner, size_t index) : _owner(owner), _index(index) {skip();}
+            reference operator*() const {return _owner->_slots[_index];}
+            pointer operator->() const {return &_owner->_slots[_index];}
+            Iterator& operator++() {++_index; skip(); return *this;}
+            Iterator operator++(int) {auto it = *this; ++(*this); return it;}
+            bool operator==(const Iterator& other) const {return _index == other._index;}
+            // 允许iterator转为const_iterator
+            operator Iterator<const Owner, const Element>() const requires (!std::is_const_v<Owner>) {return {_owner, _index};}
+        private:
+            friend class FlatMap;
+            void skip()
+            {
+                while (_index < _owner->_tags.size() && _owner->_tags[_index] == empty_tag) ++_index;
+            }
+            Owner* _owner = nullptr;
+            size_t _index = 0;
+        };
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+        using iterator = Iterator<FlatMap, value_type>;
+        using const_iterator = Iterator<const FlatMap, const value_type>;
+
+        FlatMap() = default;
+        explicit FlatMap(size_t capacity) {reserve(capacity);}
+        template<typename InputIt>
+        FlatMap(InputIt first, InputIt last) {insert(first, last);}
+
+        // 预留至少容纳capacity个元素的空间, 负载因子不超过3/4
+        void reserve(size_t capacity)
+        {
+            const auto table_size = std::bit_ceil(std::max(min_capacity, capacity * 4 / 3 + 1));
+            if (table_size > _tags.size()) rehash(table_size);
+        }
+        void clear()
+        {
+            _tags.clear();
+            _slots.clear();
+            _size = 0;
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            const auto hash = Hash{}(key);
+            const auto tag = make_tag(hash);
+            if (!_tags.empty())
+            {
+                const auto index = find_index(key, hash, tag);
+                if (index != _tags.size()) return {iterator{this, index}, false};
+            }
+            if ((_size + 1) * 4 > _tags.size() * 3) rehash(std::max(min_capacity, _tags.size() * 2));
+            const auto mask = _tags.size() - 1;
+            auto index = hash & mask;
+            while (_tags[index] != empty_tag) index = (index + 1) & mask;
+            _tags[index] = tag;
+            _slots[index] = value_type{key, Value{std::forward<Args>(args)...}};
+            ++_size;
+            return {iterator{this, index}, true};
+        }
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(const Key& key, Args&&... args)
+        {
+            return try_emplace(key, std::forward<Args>(args)...);
+        }
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(value.first, std::move(value.second));
+        }
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last)
+        {
+            if constexpr (std::forward_iterator<InputIt>) reserve(_size + static_cast<size_t>(std::distance(first, last)));
+            for (; first != last; ++first)
+            {
+                auto&& element = *first;
+                // move_iterator时移动值, 否则拷贝
+                if constexpr (std::is_rvalue_reference_v<std::iter_reference_t<InputIt>>) try_emplace(element.first, std::move(element.second));
+                else try_emplace(element.first, element.second);
+            }
+        }
+        Value& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        iterator find(const Key& key) {return {this, find_index(key)};}
+        const_iterator find(const Key& key) const {return {this, find_index(key)};}
+        [[nodiscard]] bool contains(const Key& key) const {return find_index(key) != _tags.size();}
+        [[nodiscard]] size_t count(const Key& key) const {return contains(key) ? 1 : 0;}
+
+        size_t erase(const Key& key)
+        {
+            const auto index = find_index(key);
+            if (index == _tags.size()) return 0;
+            erase_index(index);
+            return 1;
+        }
+        // 后移回填会改变其余元素位置, 不返回后继迭代器
+        void erase(const_iterator it)
+        {
+            erase_index(it._index);
+        }
+
+        iterator begin() {return {this, 0};}
+        iterator end() {return {this, _tags.size()};}
+        const_iterator begin() const {return {this, 0};}
+        const_iterator end() const {return {this, _tags.size()};}
+        [[nodiscard]] size_t size() const {return _size;}
+        [[nodiscard]] bool empty() const {return _size == 0;}
+        [[nodiscard]] size_t capacity() const {return _tags.size() * 3 / 4;}
+
+    private:
+        // 标签取哈希高32位, 最低位置1以区别空槽
+        static uint32_t make_tag(size_t hash)
+        {
+            return static_cast<uint32_t>(static_cast<uint64_t>(hash) >> 32) | 1u;
+        }
+        size_t find_index(const Key& key) const
+        {
+            if (_size == 0) return _tags.size();
+            const auto hash = Hash{}(key);
+            return find_index(key, hash, make_tag(hash));
+        }
+        // 找不到返回_tags.size()
+        size_t find_index(const Key& key, size_t hash, uint32_t tag) const
+        {
+            const auto mask = _tags.size() - 1;
+            for (auto index = hash & mask; ; index = (index + 1) & mask)
+            {
+                const auto slot_tag = _tags[index];
+                if (slot_tag == empty_tag) return _tags.size();
+                if (slot_tag == tag && KeyEqual{}(_slots[index].first, key)) return index;
+            }
+        }
+        void erase_index(size_t index)
+        {
+            const auto mask = _tags.size() - 1;
+            auto hole = index;
+            for (auto next = (hole + 1) & mask; _tags[next] != empty_tag; next = (next + 1) & mask)
+            {
+                // next的理想位置不在(hole, next]区间内时, 可以回填到hole
+                const auto home = Hash{}(_slots[next].first) & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask))
+                {
+                    _tags[hole] = _tags[next];
+                    _slots[hole] = std::move(_slots[next]);
+                    hole = next;
+                }
+            }
+            _tags[hole] = empty_tag;
+            _slots[hole] = value_type{};
+            --_size;
+        }
+        void rehash(size_t table_size)
+        {
+            auto tags = std::exchange(_tags, std::vector<uint32_t>(table_size, empty_tag));
+            auto slots = std::exchange(_slots, std::vector<value_type>(table_size));
+            const auto mask = table_size - 1;
+            for (size_t i = 0; i < tags.size(); ++i)
+            {
+                if (tags[i] == empty_tag) continue;
+                auto index = Hash{}(slots[i].first) & mask;
+                while (_tags[index] != empty_tag) index = (index + 1) & mask;
+                _tags[index] = tags[i];
+                _slots[index] = std::move(slots[i]);
+            }
+        }
+
+        std::vector<uint32_t> _tags;        // 探测只扫描标签数组, 命中后才访问元素
+        std::vector<value_type> _slots;
+        size_t _size = 0;
+    };
+
+    /// 一键多值哈希表, 同一个键的值连续存放, equal_range返回连续区间
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+    class FlatMultiMap
+    {
+        using Map = FlatMap<Key, std::vector<Value>, Hash, KeyEqual>;
+    public:
+        FlatMultiMap() = default;
+        explicit FlatMultiMap(size_t key_capacity) : _map(key_capacity) {}
+
+        void reserve(size_t key_capacity) {_map.reserve(key_capacity);}
+        void clear()
+        {
+            _map.clear();
+            _size = 0;
+        }
+        template<typename... Args>
+        Value& emplace(const Key& key, Args&&... args)
+        {
+            ++_size;
+            return _map[key].emplace_back(std::forward<Args>(args)...);
+        }
+        std::span<Value> equal_range(const Key& key)
+        {
+            auto it = _map.find(key);
+            if (it == _map.end()) return {};
+            return it->second;
+        }
+        std::span<const Value> equal_range(const Key& key) const
+        {
+            auto it = _map.find(key);
+            if (it == _map.end()) return {};
+            return it->second;
+        }
+        [[nodiscard]] bool contains(const Key& key) const {return _map.contains(key);}
+        [[nodiscard]] size_t count(const Key& key) const {return equal_range(key).size();}
+        // 删除键下第一个等于value的值, 值删空后键一并删除
+        bool erase(const Key& key, const Value& value)
+        {
+            auto it = _map.find(key);
+            if (it == _map.end()) return false;
+            auto& values = it->second;
+            auto value_it = std::find(values.begin(), values.end(), value);
+            if (value_it == values.end()) return false;
+            values.erase(value_it);
+            --_size;
+            if (values.empty()) _map.erase(it);
+            return true;
+        }
+        // 删除键下全部值
+        size_t erase(const Key& key)
+        {
+            auto it = _map.find(key);
+            if (it == _map.end()) return 0;
+            const auto num = it->second.size();
+            _map.erase(it);
+            _size -= num;
+            return num;
+        }
+
+        // 按键遍历, 元素为(键, 值数组)
+        auto begin() {return _map.begin();}
+        auto end() {return _map.end();}
+        auto begin() const {return _map.begin();}
+        auto end() const {return _map.end();}
+        // 值总数
+        [[nodiscard]] size_t size() const {return _size;}
+        [[nodiscard]] size_t key_size() const {return _map.size();}
+        [[nodiscard]] bool empty() const {return _size == 0;}
+
+    private:
+        Map _map;
+        size_t _size = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #include "adapter.h"
 #include "impl/ctp_adapter.h"
 #include "impl/emt_adapter.h"
+#include "impl/emt_l2_adapter.h"
 #include "impl/atp_adapter.h"
 #include "impl/gateway_adapter.h"
 namespace rk::adapter
@@ -18,6 +19,10 @@ namespace rk::adapter
         {
             return std::make_unique<EMTMDAdapter>(std::move(push_data_callbacks), std::move(config));
         }
+        if (config.adapter_name == "EMTL2")
+        {
+            return std::make_unique<EMTL2MDAdapter>(std::move(push_data_callbacks), std::move(config));
+        }
         if (config.adapter_name == "ATP")
         {
             return nullptr;
@@ -18,6 +18,10 @@ namespace rk::adapter
         {
             std::function<void(data_type::TickData&&)> push_tick;
             std::function<void()> push_md_disconnected;
+            // Level2行情, 未设置的回调不推送
+            std::function<void(data_type::L2OrderData&&)> push_l2_order;
+            std::function<void(data_type::L2TradeData&&)> push_l2_trade;
+            std::function<void(data_type::L2SnapshotData&&)> push_l2_snapshot;
         };
         MDAdapter(PushDataCallbacks push_data_callbacks, config_type::MDAdapterConfig config)
         : _push_data_callbacks(std::move(push_data_callbacks)), _config(std::move(config))
@@ -31,6 +35,8 @@ namespace rk::adapter
         virtual bool unsubscribe(std::unordered_set<data_type::Symbol>) = 0;
         virtual std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>> query_symbol_detail() = 0;
         virtual std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> query_etf_detail() {return {};};
+        // Level2组播在合约查询后由调用方启动, 逐笔消费者须先就绪; 其它行情接口登录即推送
+        virtual bool start_l2() {return true;}
 
     protected:
         PushDataCallbacks                       _push_data_callbacks;
@@ -66,6 +72,8 @@ namespace rk::adapter
         virtual std::optional<data_type::AccountData> query_account_data() = 0;
         virtual void order_insert(data_type::OrderRef order_ref, const data_type::OrderReq& order_req) = 0;
         virtual void order_cancel(data_type::OrderRef order_ref) = 0;
+        // 查询报单只暂存撤单所需的柜台映射, 由报单线程(引擎线程)在查询完成后合并
+        virtual void restore_order_refs() {}
 
     protected:
         PushDataCallbacks                       _push_data_callbacks;
@@ -113,11 +113,17 @@ namespace rk::adapter
                 case THOST_FTDC_PD_Long:
                 {
                     it->second->long_position.position += pInvestorPosition->Position;
+                    it->second->long_position.yd_position += pInvestorPosition->Position - pInvestorPosition->TodayPosition;
+                    it->second->long_position.cost += pInvestorPosition->PositionCost;
+                    it->second->long_position.margin += pInvestorPosition->UseMargin;
                     break;
                 }
                 case THOST_FTDC_PD_Short:
                 {
                     it->second->short_position.position += pInvestorPosition->Position;
+                    it->second->short_position.yd_position += pInvestorPosition->Position - pInvestorPosition->TodayPosition;
+                    it->second->short_position.cost += pInvestorPosition->PositionCost;
+                    it->second->short_position.margin += pInvestorPosition->UseMargin;
                     break;
                 }
                 default: RK_LOG_ERROR("unknown position direction {}", pInvestorPosition->PosiDirection);
@@ -152,22 +158,20 @@ namespace rk::adapter
                 {
                     {pOrder->InstrumentID},
                     pOrder->LimitPrice,
-                    static_cast<uint32_t>(pOrder->VolumeTotal),
+                    static_cast<uint32_t>(pOrder->VolumeTotalOriginal),
                     pOrder->Direction == THOST_FTDC_D_Buy ? data_type::Direction::LONG : data_type::Direction::SHORT,
                     CTPAdapter::convert_offset(pOrder->CombOffsetFlag[0]),
                 },
                 _td_gateway->_trading_day,
-                util::DateTime::strptime(
-                    std::format("{} {}", pOrder->InsertDate, pOrder->InsertTime),
-                    "%Y%m%d %H:%M:%S"
-                ),
+                util::DateTime::strptime_date_time(pOrder->InsertDate, pOrder->InsertTime),
+                CTPAdapter::convert_order_status(pOrder->OrderSubmitStatus, pOrder->OrderStatus, pOrder->VolumeTraded),
                 static_cast<uint32_t>(pOrder->VolumeTraded),
-                static_cast<uint32_t>(std::strlen(pOrder->CancelTime) != 0 ? 0 : (pOrder->VolumeTotal -
-                                                                                  pOrder->VolumeTraded)),
-                static_cast<uint32_t>(std::strlen(pOrder->CancelTime) == 0 ? 0 : (pOrder->VolumeTotal -
-                                                                                  pOrder->VolumeTraded))
+                static_cast<uint32_t>(std::strlen(pOrder->CancelTime) != 0 ? 0 : pOrder->VolumeTotal),
+                static_cast<uint32_t>(std::strlen(pOrder->CancelTime) == 0 ? 0 : pOrder->VolumeTotal)
             };
-
+            // 重启后恢复撤单所需的合约映射, 由restore_order_refs在报单线程合并
+            auto lock = std::lock_guard(_td_gateway->_queried_order_ref_mutex);
+            _td_gateway->_queried_order_refs.emplace_back(order_ref, pOrder->InstrumentID);
         }
         if (bIsLast)
         {
@@ -199,10 +203,7 @@ namespace rk::adapter
                 pTrade->Price,
                 static_cast<uint32_t>(pTrade->Volume),
                 _td_gateway->_trading_day,
-                util::DateTime::strptime(
-                    std::format("{} {}", pTrade->TradeDate, pTrade->TradeTime),
-                    "%Y%m%d %H:%M:%S"
-                ),
+                util::DateTime::strptime_date_time(pTrade->TradeDate, pTrade->TradeTime),
                 0
             });
         }
@@ -236,7 +237,8 @@ namespace rk::adapter
             _td_gateway->_account_data.frozen_margin = pTradingAccount->FrozenMargin;
             _td_gateway->_account_data.commission = pTradingAccount->Commission;
             _td_gateway->_account_data.available = pTradingAccount->Available;
-
+            _td_gateway->_account_data.close_profit = pTradingAccount->CloseProfit;
+            _td_gateway->_account_data.position_profit = pTradingAccount->PositionProfit;
         }
         if (bIsLast)
         {
@@ -267,10 +269,10 @@ namespace rk::adapter
         }
         if (pOrder->OrderStatus == THOST_FTDC_OST_Canceled)
         {
-            auto cancel_time = util::DateTime::strptime(std::format("{} {}", pOrder->TradingDay, pOrder->CancelTime),"%Y%m%d %H:%M:%S",0, 0, 0);
+            auto cancel_time = util::DateTime::strptime_date_time(pOrder->TradingDay, pOrder->CancelTime);
             _td_gateway->_push_data_callbacks.push_cancel({
                static_cast<data_type::OrderRef>(std::stoul(pOrder->OrderRef)),
-               static_cast<uint32_t>(pOrder->VolumeTotal - pOrder->VolumeTraded),
+               static_cast<uint32_t>(pOrder->VolumeTotal),
                static_cast<uint32_t>(std::stoi(pOrder->TradingDay)),
                cancel_time,
            });
@@ -287,7 +289,7 @@ namespace rk::adapter
             pTrade->Price,
             static_cast<uint32_t>(pTrade->Volume),
             static_cast<uint32_t>(std::stoi(pTrade->TradingDay)),
-            util::DateTime::strptime(std::format("{} {}", pTrade->TradeDate, pTrade->TradeTime),"%Y%m%d %H:%M:%S",0, 0, 0),
+            util::DateTime::strptime_date_time(pTrade->TradeDate, pTrade->TradeTime),
             0
         });
     }
@@ -295,7 +297,7 @@ namespace rk::adapter
     CTPTDAdapter::CTPTDAdapter(TDAdapter::PushDataCallbacks push_data_callbacks, config_type::TDAdapterConfig config)
     : TDAdapter(std::move(push_data_callbacks), std::move(config)),
       _handler(this),
-      _order_ref_to_trade_symbol(1000)
+      _order_ref_to_trade_symbol(_config.order_capacity)
     {
         
     }
@@ -390,6 +392,10 @@ namespace rk::adapter
     std::optional<std::vector<data_type::OrderData>> CTPTDAdapter::query_order_data()
     {
         _order_data.clear();
+        {
+            auto lock = std::lock_guard(_queried_order_ref_mutex);
+            _queried_order_refs.clear();
+        }
         CThostFtdcQryOrderField req{};
         std::strncpy(req.BrokerID, _config.broker_id.c_str(), sizeof(req.BrokerID) - 1);
         std::strncpy(req.InvestorID, _config.user_id.c_str(), sizeof(req.InvestorID) - 1);
@@ -495,6 +501,17 @@ namespace rk::adapter
     }
     void CTPTDAdapter::order_insert(data_type::OrderRef order_ref, const data_type::OrderReq& order_req)
     {
+        if (order_ref >= _order_ref_to_trade_symbol.size())
+        {
+            RK_LOG_ERROR("order ref {} exceeds order capacity {}", order_ref, _order_ref_to_trade_symbol.size());
+            _push_data_callbacks.push_order_error({
+                _trading_day,
+                order_ref,
+                data_type::ErrorType::ORDER_INSERT_ERROR,
+                std::format("order ref {} exceeds order capacity", order_ref)
+            });
+            return;
+        }
         CThostFtdcInputOrderField req{};
         std::strncpy(req.BrokerID, _config.broker_id.c_str(), sizeof(req.BrokerID) - 1);
         std::strncpy(req.InvestorID, _config.user_id.c_str(), sizeof(req.InvestorID) - 1);
@@ -528,8 +545,28 @@ namespace rk::adapter
             });
         }
     }
+    void CTPTDAdapter::restore_order_refs()
+    {
+        auto lock = std::lock_guard(_queried_order_ref_mutex);
+        for (const auto& [order_ref, trade_symbol] : _queried_order_refs)
+        {
+            if (order_ref < _order_ref_to_trade_symbol.size()) _order_ref_to_trade_symbol[order_ref] = trade_symbol;
+        }
+        _queried_order_refs.clear();
+    }
     void CTPTDAdapter::order_cancel(data_type::OrderRef order_ref)
     {
+        if (order_ref >= _order_ref_to_trade_symbol.size() || _order_ref_to_trade_symbol[order_ref].empty())
+        {
+            RK_LOG_ERROR("order ref {} not found, order cancel failed", order_ref);
+            _push_data_callbacks.push_order_error({
+                _trading_day,
+                order_ref,
+                data_type::ErrorType::ORDER_CANCEL_ERROR,
+                std::format("order ref {} not found", order_ref)
+            });
+            return;
+        }
         CThostFtdcInputOrderActionField req{};
         std::strncpy(req.BrokerID, _config.broker_id.c_str(), sizeof(req.BrokerID) - 1);
         std::strncpy(req.InvestorID, _config.user_id.c_str(), sizeof(req.InvestorID) - 1);
@@ -669,49 +706,9 @@ namespace rk::adapter
     void CTPMarketHandler::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField* pDepthMarketData) noexcept
     {
         if (!pDepthMarketData) return;
-        _gateway->_push_data_callbacks.push_tick({
-            _gateway->_symbol_detail.find({pDepthMarketData->InstrumentID})->first,
-            static_cast<uint32_t>(std::stoul(pDepthMarketData->TradingDay)),
-            CTPAdapter::convert_trading_day_to_natural_day(pDepthMarketData->TradingDay, pDepthMarketData->UpdateTime, pDepthMarketData->UpdateMillisec),
-            pDepthMarketData->LastPrice,
-            pDepthMarketData->OpenPrice,
-            pDepthMarketData->HighestPrice,
-            pDepthMarketData->LowestPrice,
-            pDepthMarketData->UpperLimitPrice,
-            pDepthMarketData->LowerLimitPrice,
-            static_cast<int64_t>(pDepthMarketData->Volume),
-            pDepthMarketData->OpenInterest,
-            pDepthMarketData->AveragePrice,
-            {
-                pDepthMarketData->BidPrice1,
-                pDepthMarketData->BidPrice2,
-                pDepthMarketData->BidPrice3,
-                pDepthMarketData->BidPrice4,
-                pDepthMarketData->BidPrice5
-            },
-            {
-                pDepthMarketData->AskPrice1,
-                pDepthMarketData->AskPrice2,
-                pDepthMarketData->AskPrice3,
-                pDepthMarketData->AskPrice4,
-                pDepthMarketData->AskPrice5
-            },
-            {
-                static_cast<int64_t>(pDepthMarketData->BidVolume1),
-                static_cast<int64_t>(pDepthMarketData->BidVolume2),
-                static_cast<int64_t>(pDepthMarketData->BidVolume3),
-                static_cast<int64_t>(pDepthMarketData->BidVolume4),
-                static_cast<int64_t>(pDepthMarketData->BidVolume5)
-            },
-            {
-                static_cast<int64_t>(pDepthMarketData->AskVolume1),
-                static_cast<int64_t>(pDepthMarketData->AskVolume2),
-                static_cast<int64_t>(pDepthMarketData->AskVolume3),
-                static_cast<int64_t>(pDepthMarketData->AskVolume4),
-                static_cast<int64_t>(pDepthMarketData->AskVolume5)
-            },
-
-        });
+        data_type::TickData tick{};
+        if (!_gateway->_tick_decoder.decode(*pDepthMarketData, tick)) return;
+        _gateway->_push_data_callbacks.push_tick(std::move(tick));
     }
     CTPMDAdapter::CTPMDAdapter(PushDataCallbacks push_data_callbacks, config_type::MDAdapterConfig config)
         :
@@ -893,7 +890,8 @@ namespace rk::adapter
         std::strncpy(field.UserID, _config.user_id.c_str(), sizeof(field.UserID) - 1);
         _td_api->ReqUserLogout(&field, ++_req_id);
         _td_api = nullptr;
-        return _symbol_detail;
+        _tick_decoder.reset(_symbol_detail);
+        return std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>(_symbol_detail.begin(), _symbol_detail.end());
 
     }
     void CTPMDAdapter::notify_rpc_result(RPCResult result)
@@ -1244,13 +1242,25 @@ namespace rk::adapter
             default: throw std::runtime_error("unknown ctp offset");
         }
     }
+    constexpr data_type::OrderStatus CTPAdapter::convert_order_status(TThostFtdcOrderSubmitStatusType submit_status, TThostFtdcOrderStatusType status, TThostFtdcVolumeType volume_traded)
+    {
+        if (submit_status == THOST_FTDC_OSS_InsertRejected) return data_type::OrderStatus::REJECTED;
+        switch (status)
+        {
+            case THOST_FTDC_OST_AllTraded: return data_type::OrderStatus::ALL_TRADED;
+            case THOST_FTDC_OST_PartTradedQueueing: return data_type::OrderStatus::PARTIAL_TRADED;
+            case THOST_FTDC_OST_PartTradedNotQueueing: return data_type::OrderStatus::PARTIAL_CANCELED;
+            case THOST_FTDC_OST_NoTradeQueueing:
+            case THOST_FTDC_OST_NotTouched:
+            case THOST_FTDC_OST_Touched: return data_type::OrderStatus::QUEUEING;
+            case THOST_FTDC_OST_NoTradeNotQueueing:
+            case THOST_FTDC_OST_Canceled: return volume_traded > 0 ? data_type::OrderStatus::PARTIAL_CANCELED : data_type::OrderStatus::ALL_CANCELED;
+            default: return data_type::OrderStatus::UNKNOWN;
+        }
+    }
     util::DateTime CTPAdapter::convert_trading_day_to_natural_day(TThostFtdcDateType trading_day, TThostFtdcTimeType update_time, TThostFtdcMillisecType millisec)
     {
-        auto datetime = util::DateTime::strptime(
-            std::format("{} {}", trading_day, update_time),
-            "%Y%m%d %H:%M:%S",
-            millisec, 0, 0
-        );
+        auto datetime = util::DateTime::strptime_date_time(trading_day, update_time, millisec);
         auto hour = datetime.hour();
         auto back_days = 1;
         if (datetime.weekday() == 1)
@@ -2,6 +2,8 @@
 #include <ThostFtdcMdApi.h>
 #include <ThostFtdcTraderApi.h>
 #include "../adapter.h"
+#include "util/flat_map.h"
+#include "ctp_tick_decoder.h"
 #include <condition_variable>
 #include <mutex>
 
@@ -51,6 +53,7 @@ namespace rk::adapter
         std::optional<data_type::AccountData> query_account_data() override;
         void order_insert(data_type::OrderRef order_ref, const data_type::OrderReq& order_req) override;
         void order_cancel(data_type::OrderRef order_ref) override;
+        void restore_order_refs() override;
         void notify_rpc_result(RPCResult result);
     private:
         // trade
@@ -70,7 +73,9 @@ namespace rk::adapter
         uint32_t _trading_day = 0;
         // 柜台额外需要字段
         bool _continue_login = true;
-        std::vector<std::string> _order_ref_to_trade_symbol;    // FrontID + SessionID + OrderRef撤单需要InstrumentID字段
+        std::vector<util::FixedString<16>> _order_ref_to_trade_symbol;    // FrontID + SessionID + OrderRef撤单需要InstrumentID字段, 按order_capacity预分配
+        std::mutex _queried_order_ref_mutex;
+        std::vector<std::pair<data_type::OrderRef, util::FixedString<16>>> _queried_order_refs;   // 查询线程暂存, 不直接改写报单路径的映射
         int _req_id = 0;
         int _front_id = 0;
         int _session_id = 0;
@@ -127,9 +132,10 @@ namespace rk::adapter
         RPCResult _rpc_result = RPCResult::UNKNOWN;
         std::mutex _rpc_mutex;
         std::condition_variable _rpc_condition_variable;
-        std::unordered_map<std::string, data_type::Symbol> _trade_symbol_to_symbol;
+        util::FlatMap<util::FixedString<16>, data_type::Symbol> _trade_symbol_to_symbol;
         std::unordered_multimap<std::string, std::shared_ptr<data_type::SymbolDetail>> _underlying_to_symbol_details;
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_detail;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_detail;
+        CTPTickDecoder _tick_decoder;       // 查询合约后重建
         uint32_t _trading_day = 0;
         int _req_id = 0;
         // 柜台额外需要字段
@@ -146,6 +152,7 @@ namespace rk::adapter
         static constexpr TThostFtdcDirectionType convert_direction(data_type::Direction field);
         static constexpr TThostFtdcOffsetFlagType convert_offset(data_type::Offset field, data_type::Exchange exchange);
         static constexpr data_type::Offset convert_offset(TThostFtdcOffsetFlagType field);
+        static constexpr data_type::OrderStatus convert_order_status(TThostFtdcOrderSubmitStatusType submit_status, TThostFtdcOrderStatusType status, TThostFtdcVolumeType volume_traded);
         static util::DateTime convert_trading_day_to_natural_day(TThostFtdcDateType trading_day, TThostFtdcTimeType update_time, TThostFtdcMillisecType millisec);
 
     };
@@ -0,0 +1,136 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <ThostFtdcUserApiStruct.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "data_type.h"
+#include "util/flat_map.h"
+
+namespace rk::adapter
+{
+    /// CTP深度行情解码, 在SPI线程上逐笔调用, 不分配内存
+    /// 合约代码查表得到合约序号, 日期时间按定宽数字解析, 夜盘自然日偏移按交易日预先算好
+    /// reset与decode不能并发, 合约表只在查询合约后、订阅行情前重建
+    class CTPTickDecoder
+    {
+    public:
+        void reset(const util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>& symbol_details)
+        {
+            _symbols.clear();
+            _symbols.reserve(symbol_details.size());
+            _symbol_ids.clear();
+            _symbol_ids.reserve(symbol_details.size());
+            for (const auto& [symbol, _] : symbol_details)
+            {
+                _symbol_ids.emplace(symbol.symbol, static_cast<uint32_t>(_symbols.size()));
+                _symbols.emplace_back(symbol);
+            }
+            _trading_day = 0;
+        }
+        // 未知合约或字段格式不对返回false
+        bool decode(const CThostFtdcDepthMarketDataField& field, data_type::TickData& tick)
+        {
+            util::FixedString<16> instrument;
+            const auto instrument_len = ::strnlen(field.InstrumentID, sizeof(field.InstrumentID));
+            if (instrument_len > instrument.capacity()) return false;
+            instrument.assign(std::string_view(field.InstrumentID, instrument_len));
+            const auto it = _symbol_ids.find(instrument);
+            if (it == _symbol_ids.end()) return false;
+            const auto trading_day = parse_date(field.TradingDay);
+            if (trading_day == 0) return false;
+            if (trading_day != _trading_day) set_trading_day(trading_day);
+            const auto seconds_of_day = parse_time(field.UpdateTime);
+            if (seconds_of_day < 0) return false;
+
+            tick.symbol = _symbols[it->second];
+            tick.symbol_id = it->second;
+            tick.trading_day = trading_day;
+            tick.update_time = natural_time(seconds_of_day, field.UpdateMillisec);
+            tick.last_price = field.LastPrice;
+            tick.open_price = field.OpenPrice;
+            tick.highest_price = field.HighestPrice;
+            tick.lowest_price = field.LowestPrice;
+            tick.upper_limit_price = field.UpperLimitPrice;
+            tick.lower_limit_price = field.LowerLimitPrice;
+            tick.volume = field.Volume;
+            tick.open_interest = field.OpenInterest;
+            tick.average_price = field.AveragePrice;
+            tick.bid_price[0] = field.BidPrice1;
+            tick.bid_price[1] = field.BidPrice2;
+            tick.bid_price[2] = field.BidPrice3;
+            tick.bid_price[3] = field.BidPrice4;
+            tick.bid_price[4] = field.BidPrice5;
+            tick.ask_price[0] = field.AskPrice1;
+            tick.ask_price[1] = field.AskPrice2;
+            tick.ask_price[2] = field.AskPrice3;
+            tick.ask_price[3] = field.AskPrice4;
+            tick.ask_price[4] = field.AskPrice5;
+            tick.bid_volume[0] = field.BidVolume1;
+            tick.bid_volume[1] = field.BidVolume2;
+            tick.bid_volume[2] = field.BidVolume3;
+            tick.bid_volume[3] = field.BidVolume4;
+            tick.bid_volume[4] = field.BidVolume5;
+            tick.ask_volume[0] = field.AskVolume1;
+            tick.ask_volume[1] = field.AskVolume2;
+            tick.ask_volume[2] = field.AskVolume3;
+            tick.ask_volume[3] = field.AskVolume4;
+            tick.ask_volume[4] = field.AskVolume5;
+            return true;
+        }
+        [[nodiscard]] size_t symbol_num() const {return _symbols.size();}
+
+    private:
+        static bool is_digit(char c) {return static_cast<unsigned char>(c - '0') < 10;}
+        // "yyyymmdd", 格式不对返回0
+        static uint32_t parse_date(const char* s)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                if (!is_digit(s[i])) return 0;
+                value = value * 10 + (s[i] - '0');
+            }
+            return value;
+        }
+        // "hh:mm:ss"转为当日秒数, 格式不对返回-1
+        static int64_t parse_time(const char* s)
+        {
+            if (
+                !is_digit(s[0]) || !is_digit(s[1]) || s[2] != ':' ||
+                !is_digit(s[3]) || !is_digit(s[4]) || s[5] != ':' ||
+                !is_digit(s[6]) || !is_digit(s[7])
+            )
+                return -1;
+            return ((s[0] - '0') * 10 + (s[1] - '0')) * 3600 + ((s[3] - '0') * 10 + (s[4] - '0')) * 60 + (s[6] - '0') * 10 + (s[7] - '0');
+        }
+        // 与CTPAdapter::convert_trading_day_to_natural_day一致:
+        // 16点后为前一交易日夜盘, 周一交易日的夜盘属于上周五, 零点后属于周六
+        void set_trading_day(uint32_t trading_day)
+        {
+            _trading_day = trading_day;
+            const auto days = util::detail::days_from_civil(trading_day / 10000, trading_day / 100 % 100, trading_day % 100);
+            const bool is_monday = (days % 7 + 11) % 7 == 1;
+            const auto midnight = [&](int back_days) {return (days - back_days) * 86400 - util::DateTime::utc_offset();};
+            _evening_base = midnight(is_monday ? 3 : 1);
+            _early_base = midnight(is_monday ? 2 : 0);
+            _day_base = midnight(0);
+        }
+        [[nodiscard]] util::DateTime natural_time(int64_t seconds_of_day, int millisec) const
+        {
+            const auto hour = seconds_of_day / 3600;
+            const auto base = hour >= 16 ? _evening_base : (hour <= 3 ? _early_base : _day_base);
+            return util::DateTime((base + seconds_of_day) * 1'000'000'000 + static_cast<int64_t>(millisec) * 1'000'000);
+        }
+
+        util::FlatMap<util::FixedString<16>, uint32_t> _symbol_ids;    // 合约代码 -> 合约序号
+        std::vector<data_type::Symbol> _symbols;                        // 按合约序号索引
+        uint32_t _trading_day = 0;
+        int64_t _evening_base = 0;      // 16点及以后, 各时段自然日零点的UTC秒数
+        int64_t _early_base = 0;        // 0点至3点
+        int64_t _day_base = 0;          // 其余
+    };
+}
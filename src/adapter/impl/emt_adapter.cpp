@@ -6,7 +6,7 @@ namespace rk::adapter
 {
     EMTTDAdapter::EMTTDAdapter(TDAdapter::PushDataCallbacks push_data_callbacks, config_type::TDAdapterConfig config)
     :
-        TDAdapter(std::move(push_data_callbacks), std::move(config)), _order_ref_to_emt_order_id(1000)
+        TDAdapter(std::move(push_data_callbacks), std::move(config)), _order_ref_to_emt_order_id(_config.order_capacity)
     {
 
     }
@@ -89,6 +89,10 @@ namespace rk::adapter
     std::optional<std::vector<data_type::OrderData>> EMTTDAdapter::query_order_data()
     {
         _order_data.clear();
+        {
+            auto lock = std::lock_guard(_queried_order_ref_mutex);
+            _queried_order_refs.clear();
+        }
         auto req = EMTQueryByPageReq{200, 0};
         auto rpc_lock = std::unique_lock(_rpc_mutex);
         auto res = _td_api->QueryOrdersByPage(&req, _session_id, ++_req_id);
@@ -190,6 +194,17 @@ namespace rk::adapter
     }
     void EMTTDAdapter::order_insert(data_type::OrderRef order_ref, const data_type::OrderReq& order_req)
     {
+        if (order_ref >= _order_ref_to_emt_order_id.size())
+        {
+            RK_LOG_ERROR("order ref {} exceeds order capacity {}", order_ref, _order_ref_to_emt_order_id.size());
+            _push_data_callbacks.push_order_error({
+                _trading_day,
+                order_ref,
+                data_type::ErrorType::ORDER_INSERT_ERROR,
+                std::format("order ref {} exceeds order capacity", order_ref)
+            });
+            return;
+        }
         EMTOrderInsertInfo req{};
         req.order_client_id = order_ref;
         std::strncpy(req.ticker, order_req.symbol.trade_symbol.c_str(), sizeof(req.ticker));
@@ -217,6 +232,17 @@ namespace rk::adapter
     }
     void EMTTDAdapter::order_cancel(data_type::OrderRef order_ref)
     {
+        if (order_ref >= _order_ref_to_emt_order_id.size() || _order_ref_to_emt_order_id[order_ref] == 0)
+        {
+            RK_LOG_ERROR("order ref {} not found, order cancel failed", order_ref);
+            _push_data_callbacks.push_order_error({
+                _trading_day,
+                order_ref,
+                data_type::ErrorType::ORDER_CANCEL_ERROR,
+                std::format("order ref {} not found", order_ref)
+            });
+            return;
+        }
         auto order_emt_id = _order_ref_to_emt_order_id[order_ref];
         auto res = _td_api->CancelOrder(order_emt_id, _session_id);
         if (res == 0)
@@ -231,8 +257,21 @@ namespace rk::adapter
             });
             return;
         }
+        auto lock = std::lock_guard(_cancel_mutex);
         _emt_order_id_to_order_ref[order_emt_id] = order_ref;
     }
+    void EMTTDAdapter::restore_order_refs()
+    {
+        auto lock = std::lock_guard(_queried_order_ref_mutex);
+        auto cancel_lock = std::lock_guard(_cancel_mutex);
+        for (const auto& [order_ref, order_emt_id] : _queried_order_refs)
+        {
+            if (order_ref >= _order_ref_to_emt_order_id.size()) continue;
+            _order_ref_to_emt_order_id[order_ref] = order_emt_id;
+            _emt_order_id_to_order_ref[order_emt_id] = order_ref;
+        }
+        _queried_order_refs.clear();
+    }
     void EMTTDAdapter::notify_rpc_result(RPCResult result)
     {
         {
@@ -297,8 +336,13 @@ namespace rk::adapter
     {
         if (error_info && error_info->error_id != 0)
         {
-            if (_emt_order_id_to_order_ref.find(cancel_info->order_emt_id) == _emt_order_id_to_order_ref.end()) return;
-            auto order_ref = _emt_order_id_to_order_ref[cancel_info->order_emt_id];
+            data_type::OrderRef order_ref;
+            {
+                auto lock = std::lock_guard(_cancel_mutex);
+                auto it = _emt_order_id_to_order_ref.find(cancel_info->order_emt_id);
+                if (it == _emt_order_id_to_order_ref.end()) return;
+                order_ref = it->second;
+            }
             RK_LOG_WARN("order ref {} cancel failed, error_id: {}, error_msg: {}",order_ref,error_info->error_id, error_info->error_msg);
             _push_data_callbacks.push_order_error({
                 _trading_day,
@@ -328,6 +372,8 @@ namespace rk::adapter
             }
             auto it = _position_data.find(symbol);
             it->second->long_position.position += trade_info->total_qty;
+            it->second->long_position.yd_position += trade_info->sellable_qty;
+            it->second->long_position.cost += trade_info->avg_price * static_cast<double>(trade_info->total_qty);
         }
         if (is_last)
         {
@@ -375,10 +421,14 @@ namespace rk::adapter
                 },
                 _trading_day,
                 EMTAdapter::convert_datetime(order_info->insert_time),
+                EMTAdapter::convert_order_status(order_info->order_status),
                 static_cast<uint32_t>(order_info->qty_traded),
                 order_info->cancel_time == 0 ? static_cast<uint32_t>(order_info->qty_left) : 0,
                 order_info->cancel_time != 0 ? static_cast<uint32_t>(order_info->qty_left) : 0
             };
+            // 重启后恢复撤单所需的柜台委托编号映射, 由restore_order_refs在报单线程合并
+            auto lock = std::lock_guard(_queried_order_ref_mutex);
+            _queried_order_refs.emplace_back(order_ref, order_info->order_emt_id);
         }
         if (is_last)
         {
@@ -510,9 +560,27 @@ namespace rk::adapter
     {
         RK_LOG_INFO("start subscribe symbol(num: {}) market data...", symbols.size());
         if (symbols.empty()) return true;
-        for (const auto& symbol : symbols)
+        // 不在合约表中的合约收不到行情, 不向柜台订阅
+        size_t unknown_num = 0;
+        std::string unknown_symbols;
+        for (auto it = symbols.begin(); it != symbols.end();)
+        {
+            if (_tick_decoder.set_subscribed(*it, true)) ++it;
+            else
+            {
+                if (unknown_num++ > 0) unknown_symbols += ',';
+                unknown_symbols += it->symbol.view();
+                it = symbols.erase(it);
+            }
+        }
+        if (unknown_num > 0)
         {
-            _subscribed_symbols.emplace(symbol);
+            RK_LOG_WARN("symbol(num: {}) not in symbol table, not subscribed: {}", unknown_num, unknown_symbols.c_str());
+        }
+        if (symbols.empty())
+        {
+            RK_LOG_ERROR("subscribe error, no known symbol");
+            return false;
         }
         auto rpc_lock = std::unique_lock(_rpc_mutex);
         if (!do_subscribe(symbols))
@@ -549,7 +617,7 @@ namespace rk::adapter
         if (symbols.empty()) return true;
         for (const auto& symbol : symbols)
         {
-            _subscribed_symbols.erase(symbol);
+            _tick_decoder.set_subscribed(symbol, false);
         }
         auto rpc_lock = std::unique_lock(_rpc_mutex);
         if (!do_unsubscribe(symbols))
@@ -614,9 +682,10 @@ namespace rk::adapter
             }
             _rpc_result = RPCResult::UNKNOWN;
         }
+        _tick_decoder.reset(_symbol_detail);
         return _symbol_detail;
     }
-    std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> EMTMDAdapter::query_etf_detail()
+    std::unique_ptr<EMT::API::TraderApi, EMTTDDeleter> EMTMDAdapter::login_trade_front(uint64_t& session_id)
     {
         const auto trade_flow_path = std::format("emt_trade_flow/{}/", _config.user_id);
         if (!std::filesystem::exists(trade_flow_path))
@@ -634,7 +703,7 @@ namespace rk::adapter
         td_api->RegisterSpi(this);
         td_api->SubscribePublicTopic(EMT_TE_RESUME_TYPE::EMT_TERT_QUICK);
         RK_LOG_INFO("start login trade front...");
-        auto session_id = td_api->Login(
+        session_id = td_api->Login(
             _config.trade_front_ip.c_str(),
             std::stoi(_config.trade_front_port),
             _config.user_id.c_str(),
@@ -645,8 +714,26 @@ namespace rk::adapter
         {
             auto error = td_api->GetApiLastError();
             RK_LOG_ERROR("login trade front error, error_id: {}, error_msg: {}", error->error_id, error->error_msg);
-            return std::nullopt;
+            return nullptr;
         }
+        return td_api;
+    }
+    uint32_t EMTMDAdapter::query_trading_day()
+    {
+        uint64_t session_id = 0;
+        const auto td_api = login_trade_front(session_id);
+        if (!td_api) return 0;
+        const auto* trading_day = td_api->GetTradingDay();
+        const auto ret = trading_day ? static_cast<uint32_t>(std::strtoul(trading_day, nullptr, 10)) : 0u;
+        td_api->Logout(session_id);
+        RK_LOG_INFO("trading day {}", ret);
+        return ret;
+    }
+    std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> EMTMDAdapter::query_etf_detail()
+    {
+        uint64_t session_id = 0;
+        const auto td_api = login_trade_front(session_id);
+        if (!td_api) return std::nullopt;
         RK_LOG_INFO("start query etf detail...");
         _etf_detail.clear();
         auto rpc_lock = std::unique_lock(_rpc_mutex);
@@ -850,7 +937,8 @@ namespace rk::adapter
                     1,
                     0.,0.,
                     0.,0.,
-                    0.,0.
+                    0.,0.,
+                    qsi->pre_close_price
                 );
                 _symbol_detail.emplace(symbol, std::move(symbol_detail));
             }
@@ -889,7 +977,17 @@ namespace rk::adapter
                     exchange,
                     data_type::ProductClass::ETF
                 };
-                auto etf_detail = std::make_shared<data_type::ETFDetail>(etf);
+                auto etf_detail = std::make_shared<data_type::ETFDetail>(
+                    etf,
+                    std::vector<data_type::ETFComponent>{},
+                    etf_info->unit,
+                    etf_info->estimate_amount,
+                    etf_info->cash_component,
+                    etf_info->max_cash_ratio,
+                    etf_info->net_value,
+                    etf_info->subscribe_status == 1,
+                    etf_info->redemption_status == 1
+                );
                 _etf_detail.emplace(etf, std::move(etf_detail));
             }
         }
@@ -935,7 +1033,14 @@ namespace rk::adapter
                 };
                 if (_etf_detail.contains(etf))
                 {
-                    _etf_detail[etf]->component.emplace_back(component);
+                    _etf_detail[etf]->component.emplace_back(
+                        component,
+                        etf_component_info->quantity,
+                        EMTAdapter::convert_replace_type(etf_component_info->replace_type),
+                        etf_component_info->premium_ratio,
+                        etf_component_info->creation_amount,
+                        etf_component_info->redemption_amount
+                    );
                 }
                 else
                 {
@@ -977,75 +1082,9 @@ namespace rk::adapter
     void EMTMDAdapter::OnDepthMarketData(EMTMarketDataStruct* market_data, int64_t bid1_qty[], int32_t bid1_count, int32_t max_bid1_count, int64_t ask1_qty[], int32_t ask1_count, int32_t max_ask1_count)
     {
         if (!market_data) return;
-        auto exchange = EMTAdapter::convert_exchange(market_data->exchange_id);
-        if (exchange == data_type::Exchange::UNKNOWN) return;
-        auto symbol_name = EMTAdapter::convert_trade_symbol_to_symbol(exchange, market_data->ticker);
-        if (!_symbol_detail.contains({symbol_name})) return;
-        auto symbol = _symbol_detail.find({symbol_name})->first;
-        if (_subscribed_symbols.find(symbol) == _subscribed_symbols.end()) return;
-        _push_data_callbacks.push_tick({
-            symbol,
-            static_cast<uint32_t>(market_data->data_time / 1000000000),
-            EMTAdapter::convert_datetime(market_data->data_time),
-            market_data->last_price,
-            market_data->open_price,
-            market_data->high_price,
-            market_data->low_price,
-            market_data->upper_limit_price,
-            market_data->lower_limit_price,
-            static_cast<int64_t>(market_data->qty),
-            0,
-            market_data->avg_price,
-            {
-                market_data->bid[0],
-                market_data->bid[1],
-                market_data->bid[2],
-                market_data->bid[3],
-                market_data->bid[4],
-                market_data->bid[5],
-                market_data->bid[6],
-                market_data->bid[7],
-                market_data->bid[8],
-                market_data->bid[9]
-            },
-            {
-                market_data->ask[0],
-                market_data->ask[1],
-                market_data->ask[2],
-                market_data->ask[3],
-                market_data->ask[4],
-                market_data->ask[5],
-                market_data->ask[6],
-                market_data->ask[7],
-                market_data->ask[8],
-                market_data->ask[9]
-            },
-            {
-                market_data->bid_qty[0],
-                market_data->bid_qty[1],
-                market_data->bid_qty[2],
-                market_data->bid_qty[3],
-                market_data->bid_qty[4],
-                market_data->bid_qty[5],
-                market_data->bid_qty[6],
-                market_data->bid_qty[7],
-                market_data->bid_qty[8],
-                market_data->bid_qty[9]
-            },
-            {
-                market_data->ask_qty[0],
-                market_data->ask_qty[1],
-                market_data->ask_qty[2],
-                market_data->ask_qty[3],
-                market_data->ask_qty[4],
-                market_data->ask_qty[5],
-                market_data->ask_qty[6],
-                market_data->ask_qty[7],
-                market_data->ask_qty[8],
-                market_data->ask_qty[9]
-            },
-            symbol.product_class == data_type::ProductClass::ETF ? market_data->fund.iopv : 0
-        });
+        data_type::TickData tick{};
+        if (!_tick_decoder.decode(EMTAdapter::convert_exchange(market_data->exchange_id), *market_data, tick)) return;
+        _push_data_callbacks.push_tick(std::move(tick));
     }
 
 
@@ -1090,6 +1129,16 @@ namespace rk::adapter
             default:return EMT_MARKET_TYPE::EMT_MKT_UNKNOWN;
         }
     }
+    data_type::CashReplaceType EMTAdapter::convert_replace_type(ETF_REPLACE_TYPE field)
+    {
+        switch (field)
+        {
+            case ERT_CASH_FORBIDDEN: return data_type::CashReplaceType::FORBIDDEN;
+            case ERT_CASH_OPTIONAL: return data_type::CashReplaceType::OPTIONAL;
+            case ERT_CASH_MUST: return data_type::CashReplaceType::MUST;
+            default: return data_type::CashReplaceType::UNKNOWN;
+        }
+    }
     EMQ_EXCHANGE_TYPE EMTAdapter::convert_exchange1(data_type::Exchange field)
     {
         switch (field)
@@ -1137,6 +1186,20 @@ namespace rk::adapter
             default: return data_type::Offset::UNKNOWN;
         }
     }
+    data_type::OrderStatus EMTAdapter::convert_order_status(EMT_ORDER_STATUS_TYPE field)
+    {
+        switch (field)
+        {
+            case EMT_ORDER_STATUS_INIT:
+            case EMT_ORDER_STATUS_NOTRADEQUEUEING: return data_type::OrderStatus::QUEUEING;
+            case EMT_ORDER_STATUS_ALLTRADED: return data_type::OrderStatus::ALL_TRADED;
+            case EMT_ORDER_STATUS_PARTTRADEDQUEUEING: return data_type::OrderStatus::PARTIAL_TRADED;
+            case EMT_ORDER_STATUS_PARTTRADEDNOTQUEUEING: return data_type::OrderStatus::PARTIAL_CANCELED;
+            case EMT_ORDER_STATUS_CANCELED: return data_type::OrderStatus::ALL_CANCELED;
+            case EMT_ORDER_STATUS_REJECTED: return data_type::OrderStatus::REJECTED;
+            default: return data_type::OrderStatus::UNKNOWN;
+        }
+    }
     EMT_BUSINESS_TYPE_EXT EMTAdapter::convert_business_type(data_type::Direction field)
     {
         switch (field)
@@ -1158,20 +1221,6 @@ namespace rk::adapter
     }
     util::DateTime EMTAdapter::convert_datetime(int64_t time)
     {
-        auto millisecond = static_cast<int>(time % 1000);
-        time /= 1000;
-        auto second = static_cast<int>(time % 100);
-        time /= 100;
-        auto minute = static_cast<int>(time % 100);
-        time /= 100;
-        auto hour = static_cast<int>(time % 100);
-        time /= 100;
-        auto day = static_cast<int>(time % 100);
-        time /= 100;
-        auto month = static_cast<int>(time % 100);
-        time /= 100;
-        auto year = static_cast<int>(time);
-
-        return util::DateTime({year, month, day, hour, minute, second, millisecond});
+        return EMTTickDecoder::convert_datetime(time);
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <emt_trader_api.h>
 #include <quote_api.h>
 #include "../adapter.h"
+#include "emt_tick_decoder.h"
 #include <condition_variable>
 #include <mutex>
 
@@ -24,6 +25,7 @@ namespace rk::adapter
         std::optional<data_type::AccountData> query_account_data() override;
         void order_insert(data_type::OrderRef order_ref, const data_type::OrderReq& order_req) override;
         void order_cancel(data_type::OrderRef order_ref) override;
+        void restore_order_refs() override;
         void notify_rpc_result(RPCResult result);
     private:
         void OnConnected() override;
@@ -48,8 +50,11 @@ namespace rk::adapter
         uint32_t _trading_day = 0;
         // 柜台额外需要字段
         int _symbol_detail_query_count = 0;
-        std::vector<uint64_t> _order_ref_to_emt_order_id;
+        std::vector<uint64_t> _order_ref_to_emt_order_id;      // 按order_capacity预分配
+        std::mutex _cancel_mutex;                               // 撤单(报单线程)与撤单错误回报(SPI线程)共享反查表
         std::unordered_map<uint64_t, data_type::OrderRef> _emt_order_id_to_order_ref;
+        std::mutex _queried_order_ref_mutex;
+        std::vector<std::pair<data_type::OrderRef, uint64_t>> _queried_order_refs;    // 查询线程暂存, 不直接改写报单路径的映射
     };
     class EMTMDAdapter final : public MDAdapter, public EMQ::API::QuoteSpi, public EMT::API::TraderSpi
     {
@@ -62,8 +67,12 @@ namespace rk::adapter
         bool unsubscribe(std::unordered_set<data_type::Symbol>) override;
         std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>> query_symbol_detail() override;
         std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> query_etf_detail() override;
+        // 登录交易前置取交易日, 失败返回0
+        uint32_t query_trading_day();
         void notify_rpc_result(RPCResult result);
     private:
+        // 行情账号登录交易前置, 用于查询ETF信息和交易日, 失败返回nullptr
+        std::unique_ptr<EMT::API::TraderApi, EMTTDDeleter> login_trade_front(uint64_t& session_id);
         bool do_subscribe(const std::unordered_set<data_type::Symbol>& symbols);
         bool do_unsubscribe(const std::unordered_set<data_type::Symbol>& symbols);
         void OnQueryAllTickers(EMTQuoteStaticInfo* qsi, EMTRspInfoStruct* error_info, bool is_last) override;
@@ -78,7 +87,7 @@ namespace rk::adapter
         std::condition_variable _rpc_condition_variable;
         std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_detail;
         std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>> _etf_detail;
-        std::unordered_set<data_type::Symbol> _subscribed_symbols;
+        EMTTickDecoder _tick_decoder;       // 查询合约后重建, 同时记录订阅标志
 
     };
     class EMTAdapter
@@ -93,6 +102,8 @@ namespace rk::adapter
         static data_type::Direction convert_direction(EMT_SIDE_TYPE field);
         static EMT_POSITION_EFFECT_TYPE convert_offset(data_type::Offset field);
         static data_type::Offset convert_offset(EMT_POSITION_EFFECT_TYPE field);
+        static data_type::OrderStatus convert_order_status(EMT_ORDER_STATUS_TYPE field);
+        static data_type::CashReplaceType convert_replace_type(ETF_REPLACE_TYPE field);
         static EMT_BUSINESS_TYPE_EXT convert_business_type(data_type::Direction field);
         static std::string convert_trade_symbol_to_symbol(data_type::Exchange exchange, std::string trade_symbol);
         static util::DateTime convert_datetime(int64_t time);
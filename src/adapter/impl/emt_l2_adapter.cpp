@@ -0,0 +1,346 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "emt_l2_adapter.h"
+#include "util/logger.h"
+#include <filesystem>
+
+namespace rk::adapter
+{
+    // 本地分发队列默认容量, 逐笔按全市场峰值留足余量, 快照每只合约每3秒一条
+    static constexpr size_t default_tick_queue_capacity = 1 << 20;
+    static constexpr size_t default_snap_queue_capacity = 1 << 16;
+    // 每轮每个通道最多处理的消息数, 避免逐笔洪峰时饿死其它通道
+    static constexpr size_t dispatch_batch_size = 256;
+
+    EMTL2MDAdapter::EMTL2MDAdapter(MDAdapter::PushDataCallbacks push_data_callbacks, config_type::MDAdapterConfig config)
+    : MDAdapter(std::move(push_data_callbacks), std::move(config))
+    {
+        _static_adapter = std::make_unique<EMTMDAdapter>(
+            MDAdapter::PushDataCallbacks{
+                [](data_type::TickData&&){},
+                _push_data_callbacks.push_md_disconnected
+            },
+            _config
+        );
+    }
+    EMTL2MDAdapter::~EMTL2MDAdapter()
+    {
+        if (_l2_api) _l2_api->Stop();
+    }
+    bool EMTL2MDAdapter::login()
+    {
+        if (!_static_adapter->login()) return false;
+        if (!init_channel()) return false;
+        const auto l2_flow_path = std::format("emt_l2_flow/{}/", _config.user_id);
+        if (!std::filesystem::exists(l2_flow_path))
+        {
+            std::filesystem::create_directories(l2_flow_path);
+        }
+        _l2_api = std::unique_ptr<EMQ::API::QuoteApiLv2, EMTL2Deleter>(
+            EMQ::API::QuoteApiLv2::CreateQuoteApiLv2(
+                (l2_flow_path + "emq.log").c_str(),
+                EMQ::API::EMQ_LOG_LEVEL::EMQ_LOG_LEVEL_INFO
+            ),
+            EMTL2Deleter()
+        );
+        _l2_api->RegisterSpi(this);
+        auto res = _l2_api->SetChannelConfig(_channel_config.data(), static_cast<uint32_t>(_channel_config.size()));
+        if (res != 0)
+        {
+            RK_LOG_ERROR("set level2 channel config error, res: {}", res);
+            return false;
+        }
+        res = _l2_api->Login(
+            _config.l2_front_ip.c_str(),
+            static_cast<uint16_t>(std::stoul(_config.l2_front_port)),
+            _config.user_id.c_str(),
+            _config.password.c_str()
+        );
+        if (res != 0)
+        {
+            RK_LOG_ERROR("login level2 front error, res: {}", res);
+            return false;
+        }
+        // 组播行情只带时分秒, 交易日以交易前置登录返回为准, 夜间或跨日启动时与本地日期不同
+        const auto trading_day = _static_adapter->query_trading_day();
+        if (trading_day == 0)
+        {
+            RK_LOG_ERROR("query level2 trading day error");
+            return false;
+        }
+        _decoder.set_trading_day(trading_day);
+        return true;
+    }
+    void EMTL2MDAdapter::logout()
+    {
+        if (_l2_api) _l2_api->Stop();
+        _dispatch_worker = nullptr;
+        _l2_api = nullptr;
+        _static_adapter->logout();
+    }
+    // 组播行情推送全市场, 订阅只修改本地过滤标志
+    bool EMTL2MDAdapter::subscribe(std::unordered_set<data_type::Symbol> symbols)
+    {
+        RK_LOG_INFO("start subscribe symbol(num: {}) level2 market data...", symbols.size());
+        size_t unknown_num = 0;
+        for (const auto& symbol : symbols)
+        {
+            if (!_symbol_table.set_subscribed(symbol, true)) ++unknown_num;
+        }
+        if (unknown_num > 0) RK_LOG_WARN("{} symbol not in level2 symbol table", unknown_num);
+        return true;
+    }
+    bool EMTL2MDAdapter::unsubscribe(std::unordered_set<data_type::Symbol> symbols)
+    {
+        RK_LOG_INFO("start unsubscribe symbol(num: {}) level2 market data...", symbols.size());
+        for (const auto& symbol : symbols)
+        {
+            _symbol_table.set_subscribed(symbol, false);
+        }
+        return true;
+    }
+    // 首次查询后建立合约表, 组播接收启动后再查询不重建合约表
+    std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>> EMTL2MDAdapter::query_symbol_detail()
+    {
+        auto symbol_detail = _static_adapter->query_symbol_detail();
+        if (!symbol_detail || _dispatch_worker) return symbol_detail;
+        _symbol_table.reset(*symbol_detail);
+        return symbol_detail;
+    }
+    // 调用方在逐笔消费者(订单簿)就绪后启动, 此后推送的逐笔不再丢失
+    bool EMTL2MDAdapter::start_l2()
+    {
+        if (_dispatch_worker) return true;
+        if (!_l2_api || _symbol_table.symbol_num() == 0)
+        {
+            RK_LOG_ERROR("level2 api not logged in or symbol not queried");
+            return false;
+        }
+        const auto res = _l2_api->Start();
+        if (res != 0)
+        {
+            RK_LOG_ERROR("start level2 api error, res: {}", res);
+            return false;
+        }
+        // 启动成功后再起分发线程, 此前的推送在通道队列中等待
+        _dispatch_worker = std::make_unique<std::jthread>([this](const std::stop_token& stop_token){dispatching_loop(stop_token);});
+        RK_LOG_INFO("level2 api started, {} symbol, {} channel", _symbol_table.symbol_num(), _channel_config.size());
+        return true;
+    }
+    std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> EMTL2MDAdapter::query_etf_detail()
+    {
+        return _static_adapter->query_etf_detail();
+    }
+    bool EMTL2MDAdapter::init_channel()
+    {
+        _channel_config.clear();
+        _sse_tick = nullptr;
+        _sse_snap = nullptr;
+        _sse_tree = nullptr;
+        _sze_tick = nullptr;
+        _sze_snap = nullptr;
+        _sze_tree = nullptr;
+        for (const auto& channel : _config.l2_channel)
+        {
+            const auto quote_type = convert_quote_type(channel.quote_type);
+            if (!quote_type)
+            {
+                RK_LOG_ERROR("unsupported level2 quote type {}", channel.quote_type);
+                return false;
+            }
+            const auto is_tick = channel.quote_type.ends_with("TICK");
+            const auto capacity = channel.queue_capacity > 0 ? channel.queue_capacity : (is_tick ? default_tick_queue_capacity : default_snap_queue_capacity);
+            const auto create = [&](auto& queue)
+            {
+                if (queue) return false;
+                queue = std::make_unique<typename std::decay_t<decltype(queue)>::element_type>(capacity, is_tick);
+                return true;
+            };
+            bool created = false;
+            switch (*quote_type)
+            {
+                case EMQ::API::EMQType::kSseTick: created = create(_sse_tick); break;
+                case EMQ::API::EMQType::kSseSnap: created = create(_sse_snap); break;
+                case EMQ::API::EMQType::kSseTree: created = create(_sse_tree); break;
+                case EMQ::API::EMQType::kSzeTick: created = create(_sze_tick); break;
+                case EMQ::API::EMQType::kSzeSnap: created = create(_sze_snap); break;
+                case EMQ::API::EMQType::kSzeTree: created = create(_sze_tree); break;
+                default: break;
+            }
+            if (!created)
+            {
+                RK_LOG_ERROR("level2 quote type {} configured more than once", channel.quote_type);
+                return false;
+            }
+            EMQ::API::EMQConfigLv2 config{};
+            config.enable = true;
+            config.mode = channel.recv_mode == "efvi" ? EMQ::API::EMQRecvMode::kEFVI : EMQ::API::EMQRecvMode::kNormal;
+            config.quote_type = *quote_type;
+            channel.eth_name.copy(config.eth_name, sizeof(config.eth_name) - 1);
+            channel.multicast_ip.copy(config.multicast_ip, sizeof(config.multicast_ip) - 1);
+            config.multicast_port = channel.multicast_port;
+            config.rx_cpu_id = channel.rx_cpu_id;
+            config.handle_cpu_id = channel.handle_cpu_id;
+            config.rx_pkt_num = channel.rx_pkt_num;
+            config.spsc_size = channel.spsc_size;
+            _channel_config.emplace_back(config);
+        }
+        if (_channel_config.empty())
+        {
+            RK_LOG_ERROR("no level2 channel configured");
+            return false;
+        }
+        return true;
+    }
+
+    template<typename Raw>
+    void EMTL2MDAdapter::enqueue(Channel<Raw>* channel, data_type::Exchange exchange, const void* ticker, size_t ticker_size, const Raw& raw, bool subscribed_only)
+    {
+        if (!channel) return;
+        const auto symbol_id = _symbol_table.find(exchange, static_cast<const char*>(ticker), ticker_size);
+        if (!symbol_id || (subscribed_only && !_symbol_table.is_subscribed(*symbol_id))) return;
+        if (channel->queue.try_enqueue(Message<Raw>{*symbol_id, raw})) return;
+        channel->dropped.fetch_add(1, std::memory_order_relaxed);
+        if (!channel->lossless) return;
+        while (!channel->queue.try_enqueue(Message<Raw>{*symbol_id, raw})) std::this_thread::yield();
+    }
+    void EMTL2MDAdapter::OnLv2TickSse(EMQSseTick *tick)
+    {
+        if (!tick) return;
+        enqueue(_sse_tick.get(), data_type::Exchange::SSE, tick->m_symbol, sizeof(tick->m_symbol), *tick);
+    }
+    void EMTL2MDAdapter::OnLv2SnapSse(EMQSseSnap *snap)
+    {
+        if (!snap) return;
+        enqueue(_sse_snap.get(), data_type::Exchange::SSE, snap->m_symbol, sizeof(snap->m_symbol), *snap, true);
+    }
+    void EMTL2MDAdapter::OnLv2TreeSse(EMQSseTree *tree)
+    {
+        if (!tree) return;
+        enqueue(_sse_tree.get(), data_type::Exchange::SSE, tree->m_symbol, sizeof(tree->m_symbol), *tree);
+    }
+    void EMTL2MDAdapter::OnLv2TickSze(EMQSzeTick *tick)
+    {
+        if (!tick) return;
+        if (tick->m_tick_type == EMQSzeTickType::kTickTypeOrder && tick->m_tick_order)
+        {
+            const auto& order = *tick->m_tick_order;
+            enqueue(_sze_tick.get(), data_type::Exchange::SZSE, order.m_head.m_symbol, sizeof(order.m_head.m_symbol), SzeTickRaw{order});
+        }
+        else if (tick->m_tick_type == EMQSzeTickType::kTickTypeExe && tick->m_tick_exe)
+        {
+            const auto& exe = *tick->m_tick_exe;
+            enqueue(_sze_tick.get(), data_type::Exchange::SZSE, exe.m_head.m_symbol, sizeof(exe.m_head.m_symbol), SzeTickRaw{exe});
+        }
+    }
+    void EMTL2MDAdapter::OnLv2SnapSze(EMQSzeSnap *snap)
+    {
+        if (!snap) return;
+        enqueue(_sze_snap.get(), data_type::Exchange::SZSE, snap->m_head.m_symbol, sizeof(snap->m_head.m_symbol), *snap, true);
+    }
+    void EMTL2MDAdapter::OnLv2TreeSze(EMQSzeTree *tree)
+    {
+        if (!tree) return;
+        enqueue(_sze_tree.get(), data_type::Exchange::SZSE, tree->m_head.m_symbol, sizeof(tree->m_head.m_symbol), *tree);
+    }
+
+    template<typename Raw, typename Handler>
+    size_t EMTL2MDAdapter::drain(Channel<Raw>* channel, Handler&& handler)
+    {
+        if (!channel) return 0;
+        size_t num = 0;
+        // 原地处理队首消息, 不拷出大结构体
+        for (auto* message = channel->queue.peek(); message && num < dispatch_batch_size; message = channel->queue.peek())
+        {
+            handler(message->symbol_id, message->raw);
+            channel->queue.pop();
+            ++num;
+        }
+        return num;
+    }
+    template<typename Raw>
+    void EMTL2MDAdapter::report_dropped(Channel<Raw>* channel, std::string_view quote_type)
+    {
+        if (!channel) return;
+        const auto dropped = channel->dropped.load(std::memory_order_relaxed);
+        if (dropped == channel->reported_dropped) return;
+        RK_LOG_WARN(
+            "level2 {} queue full, {} message {}, total {}",
+            quote_type, dropped - channel->reported_dropped, channel->lossless ? "blocked" : "dropped", dropped
+        );
+        channel->reported_dropped = dropped;
+    }
+    void EMTL2MDAdapter::push_snapshot(data_type::L2SnapshotData&& snapshot)
+    {
+        if (!snapshot.is_tree && _push_data_callbacks.push_tick) _push_data_callbacks.push_tick(data_type::TickData(snapshot.tick));
+        if (_push_data_callbacks.push_l2_snapshot) _push_data_callbacks.push_l2_snapshot(std::move(snapshot));
+    }
+    void EMTL2MDAdapter::dispatching_loop(const std::stop_token& stop_token)
+    {
+        const auto& callbacks = _push_data_callbacks;
+        const auto on_tick = [&](uint32_t symbol_id, const auto& raw)
+        {
+            const auto& symbol = _symbol_table.symbol(symbol_id);
+            data_type::L2OrderData order;
+            data_type::L2TradeData trade;
+            if (_decoder.decode(symbol, raw, order))
+            {
+                if (callbacks.push_l2_order) callbacks.push_l2_order(std::move(order));
+            }
+            else if (_decoder.decode(symbol, raw, trade))
+            {
+                if (callbacks.push_l2_trade) callbacks.push_l2_trade(std::move(trade));
+            }
+        };
+        const auto on_sze_tick = [&](uint32_t symbol_id, const SzeTickRaw& raw)
+        {
+            if (const auto* order = std::get_if<EMQSzeTickOrder>(&raw))
+            {
+                data_type::L2OrderData l2_order;
+                _decoder.decode(_symbol_table.symbol(symbol_id), *order, l2_order);
+                if (callbacks.push_l2_order) callbacks.push_l2_order(std::move(l2_order));
+            }
+            else on_tick(symbol_id, std::get<EMQSzeTickExe>(raw));
+        };
+        const auto on_snapshot = [&](uint32_t symbol_id, const auto& raw)
+        {
+            data_type::L2SnapshotData snapshot;
+            _decoder.decode(_symbol_table.symbol(symbol_id), raw, snapshot);
+            snapshot.tick.symbol_id = symbol_id;
+            push_snapshot(std::move(snapshot));
+        };
+        auto next_report = std::chrono::steady_clock::now();
+        while (!stop_token.stop_requested())
+        {
+            size_t num = 0;
+            num += drain(_sse_tick.get(), on_tick);
+            num += drain(_sze_tick.get(), on_sze_tick);
+            num += drain(_sse_snap.get(), on_snapshot);
+            num += drain(_sze_snap.get(), on_snapshot);
+            num += drain(_sse_tree.get(), on_snapshot);
+            num += drain(_sze_tree.get(), on_snapshot);
+            if (const auto now = std::chrono::steady_clock::now(); now >= next_report)
+            {
+                report_dropped(_sse_tick.get(), "SSE_TICK");
+                report_dropped(_sze_tick.get(), "SZSE_TICK");
+                report_dropped(_sse_snap.get(), "SSE_SNAP");
+                report_dropped(_sze_snap.get(), "SZSE_SNAP");
+                report_dropped(_sse_tree.get(), "SSE_TREE");
+                report_dropped(_sze_tree.get(), "SZSE_TREE");
+                next_report = now + std::chrono::seconds(1);
+            }
+            if (num == 0) std::this_thread::yield();
+        }
+    }
+    std::optional<EMQ::API::EMQType> EMTL2MDAdapter::convert_quote_type(std::string_view quote_type)
+    {
+        if (quote_type == "SSE_TICK") return EMQ::API::EMQType::kSseTick;
+        if (quote_type == "SSE_SNAP") return EMQ::API::EMQType::kSseSnap;
+        if (quote_type == "SSE_TREE") return EMQ::API::EMQType::kSseTree;
+        if (quote_type == "SZSE_TICK") return EMQ::API::EMQType::kSzeTick;
+        if (quote_type == "SZSE_SNAP") return EMQ::API::EMQType::kSzeSnap;
+        if (quote_type == "SZSE_TREE") return EMQ::API::EMQType::kSzeTree;
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,84 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <quote_api_lv2.h>
+#include <readerwriterqueue.h>
+#include "../adapter.h"
+#include "emt_adapter.h"
+#include "emt_l2_decoder.h"
+#include "emt_tick_decoder.h"
+#include <atomic>
+#include <thread>
+#include <variant>
+
+namespace rk::adapter
+{
+    struct EMTL2Deleter { void operator()(EMQ::API::QuoteApiLv2* p){if (p) {p->Release();}} };
+    /// EMT Level2组播行情, 合约与ETF信息仍通过Level1行情和交易前置查询
+    /// API每个通道一个处理线程, 回调中只查合约序号并拷贝原始消息到该通道的单生产者单消费者队列
+    /// 逐笔丢失会使订单簿永久错误, 逐笔队列满时自旋等待并计数; 快照可由下一笔覆盖, 快照队列满时丢弃计数
+    /// 分发线程轮询各通道队列, 解码后推送, 同一通道内保持交易所顺序
+    /// 逐笔和建树快照推送全市场, 订阅只过滤以TickData推送的快照; 建树快照只推送Level2快照
+    /// 每种行情类型只允许配置一个通道; 合约查询后由start_l2启动组播接收
+    class EMTL2MDAdapter final : public MDAdapter, public EMQ::API::QuoteSpiLv2
+    {
+        template<typename Raw>
+        struct Message
+        {
+            uint32_t symbol_id = 0;
+            Raw raw;
+        };
+        template<typename Raw>
+        struct Channel
+        {
+            Channel(size_t capacity, bool lossless) : queue(capacity), lossless(lossless) {}
+            moodycamel::ReaderWriterQueue<Message<Raw>> queue;
+            const bool lossless;                // 逐笔通道, 队列满时等待不丢弃
+            std::atomic<uint64_t> dropped = 0;  // 逐笔通道为等待次数
+            uint64_t reported_dropped = 0;      // 分发线程已告警的数量
+        };
+        using SzeTickRaw = std::variant<EMQSzeTickOrder, EMQSzeTickExe>;
+    public:
+        EMTL2MDAdapter(MDAdapter::PushDataCallbacks push_data_callbacks, config_type::MDAdapterConfig config);
+        ~EMTL2MDAdapter() override;
+        bool login() override;
+        void logout() override;
+        bool subscribe(std::unordered_set<data_type::Symbol> symbols) override;
+        bool unsubscribe(std::unordered_set<data_type::Symbol> symbols) override;
+        std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>> query_symbol_detail() override;
+        std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> query_etf_detail() override;
+        bool start_l2() override;
+    private:
+        bool init_channel();
+        void OnLv2SnapSze(EMQSzeSnap *snap) override;
+        void OnLv2TickSze(EMQSzeTick *tick) override;
+        void OnLv2TreeSze(EMQSzeTree *tree) override;
+        void OnLv2SnapSse(EMQSseSnap *snap) override;
+        void OnLv2TickSse(EMQSseTick *tick) override;
+        void OnLv2TreeSse(EMQSseTree *tree) override;
+        template<typename Raw>
+        void enqueue(Channel<Raw>* channel, data_type::Exchange exchange, const void* ticker, size_t ticker_size, const Raw& raw, bool subscribed_only = false);
+        template<typename Raw, typename Handler>
+        size_t drain(Channel<Raw>* channel, Handler&& handler);
+        template<typename Raw>
+        void report_dropped(Channel<Raw>* channel, std::string_view quote_type);
+        void dispatching_loop(const std::stop_token& stop_token);
+        void push_snapshot(data_type::L2SnapshotData&& snapshot);
+        static std::optional<EMQ::API::EMQType> convert_quote_type(std::string_view quote_type);
+
+        std::unique_ptr<EMTMDAdapter> _static_adapter;                  // 查询合约与ETF信息
+        std::unique_ptr<Channel<EMQSseTick>> _sse_tick;
+        std::unique_ptr<Channel<EMQSseSnap>> _sse_snap;
+        std::unique_ptr<Channel<EMQSseTree>> _sse_tree;
+        std::unique_ptr<Channel<SzeTickRaw>> _sze_tick;
+        std::unique_ptr<Channel<EMQSzeSnap>> _sze_snap;
+        std::unique_ptr<Channel<EMQSzeTree>> _sze_tree;
+        std::vector<EMQ::API::EMQConfigLv2> _channel_config;
+        EMTTickDecoder _symbol_table;                                   // 代码查合约序号, 同时记录订阅标志, 只在首次查询合约时建立
+        EMTL2Decoder _decoder;                                          // 只在分发线程上使用
+        std::unique_ptr<EMQ::API::QuoteApiLv2, EMTL2Deleter> _l2_api;
+        std::unique_ptr<std::jthread> _dispatch_worker;
+    };
+}
@@ -0,0 +1,242 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <quote_sse_define.h>
+#include <quote_sze_define.h>
+#include "data_type.h"
+
+namespace rk::adapter
+{
+    /// EMT Level2行情解码, 只在分发线程上调用
+    /// 上交所价格/数量按1000倍, 金额按100000倍; 深交所价格按10000倍, 数量按100倍, 金额按1000000倍
+    /// 上交所逐笔只有当日时间, 按交易日零点换算; 其余消息日期等于交易日时同样免去日期换算
+    class EMTL2Decoder
+    {
+        static constexpr double sse_price_scale = 1000.;
+        static constexpr int64_t sse_volume_scale = 1000;
+        static constexpr double sse_value_scale = 100000.;
+        static constexpr double sze_price_scale = 10000.;
+        static constexpr int64_t sze_volume_scale = 100;
+        static constexpr double sze_value_scale = 1000000.;
+    public:
+        void set_trading_day(uint32_t trading_day)
+        {
+            _trading_day = trading_day;
+            _day_base = midnight(trading_day);
+        }
+        [[nodiscard]] uint32_t trading_day() const {return _trading_day;}
+
+        // 上交所逐笔合并中的新增/删除订单
+        bool decode(const data_type::Symbol& symbol, const EMQSseTick& tick, data_type::L2OrderData& order) const
+        {
+            if (tick.m_tick_type != 'A' && tick.m_tick_type != 'D') return false;
+            const bool is_buy = tick.m_side_flag == 0;
+            order.symbol = symbol;
+            order.update_time = sse_tick_time(tick.m_tick_time);
+            order.channel = tick.m_channel_num;
+            order.seq = tick.m_tick_index;
+            order.order_no = is_buy ? tick.m_buy_num : tick.m_sell_num;
+            order.direction = is_buy ? data_type::Direction::LONG : data_type::Direction::SHORT;
+            order.order_type = tick.m_tick_type == 'A' ? data_type::L2OrderType::LIMIT : data_type::L2OrderType::CANCEL;
+            order.price = tick.m_price / sse_price_scale;
+            order.volume = static_cast<int64_t>(tick.m_quantity) / sse_volume_scale;
+            // 新增订单的成交额字段为申报时已成交数量
+            order.traded_volume = tick.m_tick_type == 'A' ? static_cast<int64_t>(tick.m_trade_value) / sse_volume_scale : 0;
+            return true;
+        }
+        // 上交所逐笔合并中的成交
+        bool decode(const data_type::Symbol& symbol, const EMQSseTick& tick, data_type::L2TradeData& trade) const
+        {
+            if (tick.m_tick_type != 'T') return false;
+            trade.symbol = symbol;
+            trade.update_time = sse_tick_time(tick.m_tick_time);
+            trade.channel = tick.m_channel_num;
+            trade.seq = tick.m_tick_index;
+            trade.buy_order_no = tick.m_buy_num;
+            trade.sell_order_no = tick.m_sell_num;
+            trade.direction = tick.m_side_flag == 0 ? data_type::Direction::LONG : (tick.m_side_flag == 1 ? data_type::Direction::SHORT : data_type::Direction::UNKNOWN);
+            trade.price = tick.m_price / sse_price_scale;
+            trade.volume = static_cast<int64_t>(tick.m_quantity) / sse_volume_scale;
+            trade.turnover = tick.m_trade_value / sse_value_scale;
+            return true;
+        }
+        // 深交所逐笔委托, 委托编号即逐笔序号
+        void decode(const data_type::Symbol& symbol, const EMQSzeTickOrder& tick, data_type::L2OrderData& order) const
+        {
+            order.symbol = symbol;
+            order.update_time = sze_time(tick.m_head.m_quote_update_time);
+            order.channel = tick.m_head.m_channel_num;
+            order.seq = tick.m_head.m_sequence_num;
+            order.order_no = tick.m_head.m_sequence_num;
+            order.direction = tick.m_side_flag == '1' ? data_type::Direction::LONG : (tick.m_side_flag == '2' ? data_type::Direction::SHORT : data_type::Direction::UNKNOWN);
+            switch (tick.m_order_type)
+            {
+                case '1': order.order_type = data_type::L2OrderType::MARKET; break;
+                case '2': order.order_type = data_type::L2OrderType::LIMIT; break;
+                case 'U': order.order_type = data_type::L2OrderType::BEST_OWN; break;
+                default: order.order_type = data_type::L2OrderType::UNKNOWN; break;
+            }
+            order.price = tick.m_order_price / sze_price_scale;
+            order.volume = static_cast<int64_t>(tick.m_order_quantity) / sze_volume_scale;
+            order.traded_volume = 0;
+        }
+        // 深交所撤单以成交消息发布, 转为撤单委托
+        bool decode(const data_type::Symbol& symbol, const EMQSzeTickExe& tick, data_type::L2OrderData& order) const
+        {
+            if (tick.m_trade_type != '4') return false;
+            const bool is_buy = tick.m_trade_buy_num != 0;
+            order.symbol = symbol;
+            order.update_time = sze_time(tick.m_head.m_quote_update_time);
+            order.channel = tick.m_head.m_channel_num;
+            order.seq = tick.m_head.m_sequence_num;
+            order.order_no = static_cast<uint64_t>(is_buy ? tick.m_trade_buy_num : tick.m_trade_sell_num);
+            order.direction = is_buy ? data_type::Direction::LONG : data_type::Direction::SHORT;
+            order.order_type = data_type::L2OrderType::CANCEL;
+            order.price = 0.;
+            order.volume = tick.m_trade_quantity / sze_volume_scale;
+            order.traded_volume = 0;
+            return true;
+        }
+        // 深交所逐笔成交, 无主动方向字段, 委托编号较大的一方为主动方
+        bool decode(const data_type::Symbol& symbol, const EMQSzeTickExe& tick, data_type::L2TradeData& trade) const
+        {
+            if (tick.m_trade_type != 'F') return false;
+            trade.symbol = symbol;
+            trade.update_time = sze_time(tick.m_head.m_quote_update_time);
+            trade.channel = tick.m_head.m_channel_num;
+            trade.seq = tick.m_head.m_sequence_num;
+            trade.buy_order_no = static_cast<uint64_t>(tick.m_trade_buy_num);
+            trade.sell_order_no = static_cast<uint64_t>(tick.m_trade_sell_num);
+            trade.direction = trade.buy_order_no > trade.sell_order_no ? data_type::Direction::LONG :
+                (trade.buy_order_no < trade.sell_order_no ? data_type::Direction::SHORT : data_type::Direction::UNKNOWN);
+            trade.price = tick.m_trade_price / sze_price_scale;
+            trade.volume = tick.m_trade_quantity / sze_volume_scale;
+            trade.turnover = trade.price * static_cast<double>(trade.volume);
+            return true;
+        }
+        // 上交所快照不含涨跌停价
+        void decode(const data_type::Symbol& symbol, const EMQSseSnap& snap, data_type::L2SnapshotData& snapshot) const
+        {
+            decode_sse_snapshot(symbol, snap, snapshot);
+            snapshot.channel = 0;
+            snapshot.seq = 0;
+            snapshot.is_tree = false;
+            snapshot.tick.iopv = symbol.product_class == data_type::ProductClass::ETF ? snap.m_IOPV / sse_price_scale : 0.;
+        }
+        void decode(const data_type::Symbol& symbol, const EMQSseTree& tree, data_type::L2SnapshotData& snapshot) const
+        {
+            decode_sse_snapshot(symbol, tree, snapshot);
+            snapshot.channel = tree.m_channel_num;
+            snapshot.seq = tree.m_biz_index;
+            snapshot.is_tree = true;
+            snapshot.tick.iopv = 0.;
+        }
+        void decode(const data_type::Symbol& symbol, const EMQSzeSnap& snap, data_type::L2SnapshotData& snapshot) const
+        {
+            decode_sze_snapshot(symbol, snap, snapshot);
+            snapshot.channel = 0;
+            snapshot.seq = 0;
+            snapshot.is_tree = false;
+            snapshot.tick.iopv = symbol.product_class == data_type::ProductClass::ETF ? snap.m_iopv / sze_price_scale : 0.;
+        }
+        void decode(const data_type::Symbol& symbol, const EMQSzeTree& tree, data_type::L2SnapshotData& snapshot) const
+        {
+            decode_sze_snapshot(symbol, tree, snapshot);
+            snapshot.channel = tree.m_head.m_channel_num;
+            snapshot.seq = tree.m_head.m_sequence_num;
+            snapshot.is_tree = true;
+            snapshot.tick.iopv = 0.;
+        }
+
+    private:
+        static int64_t midnight(uint32_t ymd)
+        {
+            return util::detail::days_from_civil(ymd / 10000, ymd / 100 % 100, ymd % 100) * 86400 - util::DateTime::utc_offset();
+        }
+        [[nodiscard]] util::DateTime to_datetime(uint32_t ymd, uint32_t hms, uint32_t millisecond) const
+        {
+            const auto base = ymd == _trading_day ? _day_base : midnight(ymd);
+            const auto seconds = base + hms / 10000 * 3600 + hms / 100 % 100 * 60 + hms % 100;
+            return util::DateTime(seconds * 1'000'000'000 + static_cast<int64_t>(millisecond) * 1'000'000);
+        }
+        // HHMMSSss, 百分之一秒
+        [[nodiscard]] util::DateTime sse_tick_time(uint32_t time) const
+        {
+            return to_datetime(_trading_day, time / 100, time % 100 * 10);
+        }
+        // YYYYMMDDHHMMSSsss
+        [[nodiscard]] util::DateTime sze_time(uint64_t time) const
+        {
+            return to_datetime(static_cast<uint32_t>(time / 1000000000), static_cast<uint32_t>(time / 1000 % 1000000), static_cast<uint32_t>(time % 1000));
+        }
+        template<typename Unit, size_t N>
+        static void decode_levels(const Unit (&units)[N], double price_scale, int64_t volume_scale, std::array<double, 10>& price, std::array<int64_t, 10>& volume)
+        {
+            static_assert(N <= 10);
+            for (size_t i = 0; i < N; ++i)
+            {
+                price[i] = units[i].m_price / price_scale;
+                volume[i] = static_cast<int64_t>(units[i].m_quantity) / volume_scale;
+            }
+        }
+        // 上交所快照与建树字段同名
+        template<typename Snap>
+        void decode_sse_snapshot(const data_type::Symbol& symbol, const Snap& snap, data_type::L2SnapshotData& snapshot) const
+        {
+            const auto ymd = static_cast<uint32_t>(snap.m_head.m_quote_date_year * 10000 + snap.m_head.m_quote_date_month * 100 + snap.m_head.m_quote_date_day);
+            auto& tick = snapshot.tick;
+            tick.symbol = symbol;
+            tick.trading_day = ymd;
+            tick.update_time = to_datetime(ymd, snap.m_quote_update_time, 0);
+            tick.last_price = snap.m_last_price / sse_price_scale;
+            tick.open_price = snap.m_open_price / sse_price_scale;
+            tick.highest_price = snap.m_day_high_price / sse_price_scale;
+            tick.lowest_price = snap.m_day_low_price / sse_price_scale;
+            tick.volume = static_cast<int64_t>(snap.m_total_quantity) / sse_volume_scale;
+            tick.open_interest = 0.;
+            decode_levels(snap.m_bid_unit, sse_price_scale, sse_volume_scale, tick.bid_price, tick.bid_volume);
+            decode_levels(snap.m_ask_unit, sse_price_scale, sse_volume_scale, tick.ask_price, tick.ask_volume);
+            snapshot.pre_close_price = snap.m_pre_close_price / sse_price_scale;
+            snapshot.trade_num = snap.m_total_trade_num;
+            snapshot.turnover = snap.m_total_value / sse_value_scale;
+            snapshot.total_bid_volume = static_cast<int64_t>(snap.m_total_bid_quantity) / sse_volume_scale;
+            snapshot.total_ask_volume = static_cast<int64_t>(snap.m_total_ask_quantity) / sse_volume_scale;
+            snapshot.bid_average_price = snap.m_total_bid_weighted_avg_price / sse_price_scale;
+            snapshot.ask_average_price = snap.m_total_ask_weighted_avg_price / sse_price_scale;
+            tick.average_price = tick.volume > 0 ? snapshot.turnover / static_cast<double>(tick.volume) : 0.;
+        }
+        // 深交所快照与建树字段同名
+        template<typename Snap>
+        void decode_sze_snapshot(const data_type::Symbol& symbol, const Snap& snap, data_type::L2SnapshotData& snapshot) const
+        {
+            const uint64_t time = snap.m_head.m_quote_update_time;
+            auto& tick = snapshot.tick;
+            tick.symbol = symbol;
+            tick.trading_day = static_cast<uint32_t>(time / 1000000000);
+            tick.update_time = sze_time(time);
+            tick.last_price = snap.m_last_price / sze_price_scale;
+            tick.open_price = snap.m_open_price / sze_price_scale;
+            tick.highest_price = snap.m_day_high_price / sze_price_scale;
+            tick.lowest_price = snap.m_day_low_price / sze_price_scale;
+            tick.upper_limit_price = snap.m_upper_limit_price / sze_price_scale;
+            tick.lower_limit_price = snap.m_low_limit_price / sze_price_scale;
+            tick.volume = static_cast<int64_t>(snap.m_total_quantity) / sze_volume_scale;
+            tick.open_interest = 0.;
+            decode_levels(snap.m_bid_unit, sze_price_scale, sze_volume_scale, tick.bid_price, tick.bid_volume);
+            decode_levels(snap.m_ask_unit, sze_price_scale, sze_volume_scale, tick.ask_price, tick.ask_volume);
+            snapshot.pre_close_price = snap.m_pre_close_price / sze_price_scale;
+            snapshot.trade_num = static_cast<int64_t>(snap.m_total_trade_num);
+            snapshot.turnover = static_cast<double>(snap.m_total_value) / sze_value_scale;
+            snapshot.total_bid_volume = static_cast<int64_t>(snap.m_total_bid_quantity) / sze_volume_scale;
+            snapshot.total_ask_volume = static_cast<int64_t>(snap.m_total_ask_quantity) / sze_volume_scale;
+            snapshot.bid_average_price = snap.m_total_bid_weighted_avg_price / sze_price_scale;
+            snapshot.ask_average_price = snap.m_total_ask_weighted_avg_price / sze_price_scale;
+            tick.average_price = tick.volume > 0 ? snapshot.turnover / static_cast<double>(tick.volume) : 0.;
+        }
+
+        uint32_t _trading_day = 0;
+        int64_t _day_base = 0;          // 交易日零点的UTC秒数
+    };
+}
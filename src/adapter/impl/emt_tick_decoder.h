@@ -0,0 +1,143 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <quote_api.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "data_type.h"
+
+namespace rk::adapter
+{
+    /// EMT行情解码, 在行情回调线程上逐笔调用, 不分配内存
+    /// (交易所, 6位数字代码)直接索引到合约序号, 按代码前3位分页, 只为出现过的号段分配页
+    /// 订阅标志按合约序号存放, subscribe/unsubscribe可与行情回调并发
+    /// reset与decode不能并发, 合约表只在查询合约后重建, 重建后保留已订阅合约的订阅标志
+    class EMTTickDecoder
+    {
+        static constexpr uint32_t page_size = 1000;
+        static constexpr uint32_t page_num = 1000;
+        static constexpr uint32_t npos = 0;     // 页内存合约序号+1, 0表示无此代码
+        using Page = std::array<uint32_t, page_size>;
+        using ExchangeTable = std::array<std::unique_ptr<Page>, page_num>;
+    public:
+        template<typename SymbolDetailMap>
+        void reset(const SymbolDetailMap& symbol_details)
+        {
+            // 重连后重新查询合约不应丢失已有订阅, 按合约在新表中恢复
+            std::vector<data_type::Symbol> subscribed_symbols;
+            for (uint32_t symbol_id = 0; symbol_id < _symbols.size(); ++symbol_id)
+            {
+                if (is_subscribed(symbol_id)) subscribed_symbols.push_back(_symbols[symbol_id]);
+            }
+            for (auto& table : _tables) for (auto& page : table) page.reset();
+            _symbols.clear();
+            _symbols.reserve(symbol_details.size());
+            for (const auto& [symbol, _] : symbol_details)
+            {
+                const auto code = parse_code(symbol.trade_symbol.data(), symbol.trade_symbol.capacity());
+                const auto exchange_index = to_exchange_index(symbol.exchange);
+                if (!code || exchange_index < 0) continue;
+                auto& page = _tables[exchange_index][*code / page_size];
+                if (!page) page = std::make_unique<Page>();
+                (*page)[*code % page_size] = static_cast<uint32_t>(_symbols.size()) + 1;
+                _symbols.emplace_back(symbol);
+            }
+            _subscribed = std::make_unique<std::atomic<bool>[]>(_symbols.size());
+            for (const auto& symbol : subscribed_symbols) set_subscribed(symbol, true);
+        }
+        // 不在合约表中返回false
+        bool set_subscribed(const data_type::Symbol& symbol, bool subscribed)
+        {
+            const auto symbol_id = find(symbol.exchange, symbol.trade_symbol.data(), symbol.trade_symbol.capacity());
+            if (!symbol_id) return false;
+            _subscribed[*symbol_id].store(subscribed, std::memory_order_relaxed);
+            return true;
+        }
+        [[nodiscard]] std::optional<uint32_t> find(data_type::Exchange exchange, const char* ticker, size_t ticker_size) const
+        {
+            const auto exchange_index = to_exchange_index(exchange);
+            const auto code = parse_code(ticker, ticker_size);
+            if (exchange_index < 0 || !code) return std::nullopt;
+            const auto& page = _tables[exchange_index][*code / page_size];
+            if (!page) return std::nullopt;
+            const auto value = (*page)[*code % page_size];
+            if (value == npos) return std::nullopt;
+            return value - 1;
+        }
+        [[nodiscard]] const data_type::Symbol& symbol(uint32_t symbol_id) const {return _symbols[symbol_id];}
+        [[nodiscard]] bool is_subscribed(uint32_t symbol_id) const {return _subscribed[symbol_id].load(std::memory_order_relaxed);}
+        // 未知合约或未订阅返回false
+        bool decode(data_type::Exchange exchange, const EMTMarketDataStruct& market_data, data_type::TickData& tick) const
+        {
+            const auto symbol_id = find(exchange, market_data.ticker, sizeof(market_data.ticker));
+            if (!symbol_id || !_subscribed[*symbol_id].load(std::memory_order_relaxed)) return false;
+            const auto& symbol = _symbols[*symbol_id];
+            tick.symbol = symbol;
+            tick.symbol_id = *symbol_id;
+            tick.trading_day = static_cast<uint32_t>(market_data.data_time / 1000000000);
+            tick.update_time = convert_datetime(market_data.data_time);
+            tick.last_price = market_data.last_price;
+            tick.open_price = market_data.open_price;
+            tick.highest_price = market_data.high_price;
+            tick.lowest_price = market_data.low_price;
+            tick.upper_limit_price = market_data.upper_limit_price;
+            tick.lower_limit_price = market_data.lower_limit_price;
+            tick.volume = market_data.qty;
+            tick.open_interest = 0;
+            tick.average_price = market_data.avg_price;
+            static_assert(sizeof(tick.bid_price) == sizeof(market_data.bid) && sizeof(tick.ask_price) == sizeof(market_data.ask));
+            static_assert(sizeof(tick.bid_volume) == sizeof(market_data.bid_qty) && sizeof(tick.ask_volume) == sizeof(market_data.ask_qty));
+            std::memcpy(tick.bid_price.data(), market_data.bid, sizeof(market_data.bid));
+            std::memcpy(tick.ask_price.data(), market_data.ask, sizeof(market_data.ask));
+            std::memcpy(tick.bid_volume.data(), market_data.bid_qty, sizeof(market_data.bid_qty));
+            std::memcpy(tick.ask_volume.data(), market_data.ask_qty, sizeof(market_data.ask_qty));
+            tick.iopv = symbol.product_class == data_type::ProductClass::ETF ? market_data.fund.iopv : 0;
+            return true;
+        }
+        // yyyymmddHHMMSSsss
+        static util::DateTime convert_datetime(int64_t time)
+        {
+            const auto millisecond = static_cast<int>(time % 1000);
+            time /= 1000;
+            const auto hms = static_cast<int>(time % 1000000);
+            const auto ymd = static_cast<int>(time / 1000000);
+            return util::DateTime({ymd / 10000, ymd / 100 % 100, ymd % 100, hms / 10000, hms / 100 % 100, hms % 100, millisecond});
+        }
+        [[nodiscard]] size_t symbol_num() const {return _symbols.size();}
+
+    private:
+        static int to_exchange_index(data_type::Exchange exchange)
+        {
+            switch (exchange)
+            {
+                case data_type::Exchange::SSE: return 0;
+                case data_type::Exchange::SZSE: return 1;
+                case data_type::Exchange::BSE: return 2;
+                default: return -1;
+            }
+        }
+        // 恰好6位数字的代码, Level2行情的代码字段可能以空格补齐
+        static std::optional<uint32_t> parse_code(const char* ticker, size_t size)
+        {
+            if (size < 6 || (size > 6 && ticker[6] != '\0' && ticker[6] != ' ')) return std::nullopt;
+            uint32_t code = 0;
+            for (int i = 0; i < 6; ++i)
+            {
+                const auto digit = static_cast<unsigned char>(ticker[i] - '0');
+                if (digit >= 10) return std::nullopt;
+                code = code * 10 + digit;
+            }
+            return code;
+        }
+
+        std::array<ExchangeTable, 3> _tables;                   // 沪/深/北
+        std::vector<data_type::Symbol> _symbols;                // 按合约序号索引
+        std::unique_ptr<std::atomic<bool>[]> _subscribed;
+    };
+}
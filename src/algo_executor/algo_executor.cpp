@@ -0,0 +1,99 @@
+#include "algo_executor.h"
+#include "util/logger.h"
+#include "util/str.h"
+#include "util/ipc.h"
+#include <zmq_addon.hpp>
+namespace rk::executor
+{
+    AlgoExecutor::AlgoExecutor(config_type::AlgoExecutorConfig config)
+    :
+    _config{std::move(config)},
+    _engine{std::make_unique<EngineImpl>(_config.engine_config)}
+    {
+        for (const auto& [begin_time, end_time] : _config.schedule)
+        {
+            _scheduler.add_schedule(begin_time, end_time);
+        }
+        _scheduler.set_work_days({1, 2, 3, 4, 5});
+        _scheduler.set_callback([this]() {start_session();}, [this]() {stop_session();});
+    }
+    AlgoExecutor::~AlgoExecutor()
+    {
+        stop_session();
+    }
+    void AlgoExecutor::start_session()
+    {
+        RK_LOG_INFO("algo executor session begin, start trading...");
+        if (!_engine->start_trading()) RK_LOG_ERROR("algo executor start trading failed!");
+    }
+    void AlgoExecutor::stop_session()
+    {
+        if (!_engine->is_trading()) return;
+        // 阻塞到引擎线程停止运行中的算法并归还实例池
+        RK_LOG_INFO("algo executor session end, stop trading...");
+        _engine->stop_trading();
+    }
+    std::tuple<ipc::RspData, ipc::AlgoInsertRsp> AlgoExecutor::handle_algo_insert(const std::string& client_id, const ipc::AlgoInsertReq& req)
+    {
+        if (!_engine->is_trading())
+        {
+            RK_LOG_WARN("client id {} algo insert out of session, algo num {}", util::to_hex_string(client_id), req.algo_req_list.size());
+            return {{false, ipc::RPCType::ALGO_INSERT}, {}};
+        }
+        _engine->algo_insert(std::vector<data_type::AlgoReq>(req.algo_req_list.begin(), req.algo_req_list.end()));
+        RK_LOG_INFO("client id {} algo insert success, algo num {}", util::to_hex_string(client_id), req.algo_req_list.size());
+        return {{true, ipc::RPCType::ALGO_INSERT, req.algo_req_list.size()}, {}};
+    }
+    void AlgoExecutor::run()
+    {
+        auto& context = ipc::get_zmq_context_instance();
+        zmq::socket_t router(context, zmq::socket_type::router);
+        router.set(zmq::sockopt::router_mandatory, 1);
+        router.bind(_config.req_endpoint);
+        RK_LOG_INFO("algo executor listening on {}, session num {}", _config.req_endpoint, _config.schedule.size());
+        while (true)
+        {
+            _scheduler.poll();
+            zmq::pollitem_t items[] = {{router.handle(), 0, ZMQ_POLLIN, 0}};
+            zmq::poll(items, 1, std::chrono::milliseconds(100));
+            if (!(items[0].revents & ZMQ_POLLIN)) continue;
+            // 解析请求
+            std::vector<zmq::message_t> frames;
+            if (!zmq::recv_multipart(router, std::back_inserter(frames))) throw std::runtime_error("zmq::recv return null");
+            if (frames.size() != 4)
+            {
+                RK_LOG_ERROR("algo req frame num {} illegal!", frames.size());
+                continue;
+            }
+            const auto& zmq_client_id_buf = frames[0];
+            const std::string zmq_client_id{static_cast<const char*>(zmq_client_id_buf.data()), zmq_client_id_buf.size()};
+            const auto req_ipc_data = static_cast<const ipc::IPCData*>(frames[1].data());
+            const auto req_header = static_cast<const ipc::ReqData*>(frames[2].data());
+            const auto& req_payload_buf = frames[3];
+            if (
+                frames[1].size() != sizeof(ipc::IPCData) || req_ipc_data->type != ipc::IPCDataType::REQ ||
+                frames[2].size() != sizeof(ipc::ReqData) || req_header->type != ipc::RPCType::ALGO_INSERT ||
+                req_payload_buf.size() != req_header->list_len * sizeof(data_type::AlgoReq)
+            )
+            {
+                RK_LOG_ERROR("client id {} algo req illegal!", util::to_hex_string(zmq_client_id));
+                continue;
+            }
+            RK_LOG_DEBUG("req received: client id {} req {}", zmq_client_id, ipc::to_json(*req_header).dump());
+            ipc::AlgoInsertReq req{{static_cast<const data_type::AlgoReq*>(req_payload_buf.data()), req_header->list_len}};
+            const auto& [rsp_header, rsp_payload] = handle_algo_insert(zmq_client_id, req);
+            const auto rsp_ipc_data = ipc::IPCData{ipc::IPCDataType::RSP};
+            try
+            {
+                router.send(zmq::message_t{zmq_client_id_buf.data(), zmq_client_id_buf.size()}, zmq::send_flags::sndmore);
+                router.send(zmq::message_t{&rsp_ipc_data, sizeof(rsp_ipc_data)}, zmq::send_flags::sndmore);
+                router.send(zmq::message_t(&rsp_header, sizeof(rsp_header)), zmq::send_flags::sndmore);
+                router.send(zmq::message_t(&rsp_payload, sizeof(rsp_payload)), zmq::send_flags::dontwait);
+            }
+            catch (const zmq::error_t& zmq_error)
+            {
+                RK_LOG_WARN("client id {} error {}", util::to_hex_string(zmq_client_id), zmq_error.what());
+            }
+        }
+    }
+};
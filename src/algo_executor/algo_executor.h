@@ -0,0 +1,35 @@
+#pragma once
+#include <memory>
+#include <tuple>
+#include "data_type.h"
+#include "config_type.h"
+#include "engine_impl/engine_impl.h"
+#include "util/scheduler.h"
+namespace rk::executor
+{
+    /// 算法执行服务, 一个EngineImpl运行全部算法
+    /// req_endpoint接收批量算法目标, 帧格式与行情网关一致: 客户端id, IPCData, ReqData, AlgoReq数组
+    /// 一条请求整批转为一个引擎事件, 不按合约逐条调用
+    /// 按schedule在交易时段内登录交易, 时段外的请求拒绝
+    /// 时段开始在本线程初始化完成后才置交易状态, 引擎线程此前不处理事件; 时段结束交由引擎线程停止算法、生成快照后再登出
+    class AlgoExecutor
+    {
+    public:
+        explicit AlgoExecutor(config_type::AlgoExecutorConfig config);
+        AlgoExecutor() = delete;
+        AlgoExecutor(const AlgoExecutor&) = delete;
+        AlgoExecutor(AlgoExecutor&&) = delete;
+        ~AlgoExecutor();
+        // 阻塞处理请求和交易时段
+        void run();
+
+    private:
+        std::tuple<ipc::RspData, ipc::AlgoInsertRsp> handle_algo_insert(const std::string& client_id, const ipc::AlgoInsertReq& req);
+        void start_session();
+        void stop_session();
+    private:
+        config_type::AlgoExecutorConfig _config;
+        std::unique_ptr<EngineImpl> _engine;
+        util::Scheduler _scheduler;
+    };
+};
@@ -0,0 +1,9 @@
+#include "algo_executor.h"
+#include "config_type.h"
+using namespace rk;
+int main(int argc, char* argv[])
+{
+    const auto config_file_path = argc > 1 ? argv[1] : "algo_executor.toml";
+    auto algo_executor = executor::AlgoExecutor(config_type::load_algo_executor_config(config_file_path));
+    algo_executor.run();
+}
@@ -7,6 +7,46 @@
 
 namespace rk::config_type
 {
+    static std::vector<L2ChannelConfig> load_l2_channel_config(const auto& md_adapter_config)
+    {
+        std::vector<L2ChannelConfig> l2_channel;
+        auto* channels = md_adapter_config["l2_channel"].as_array();
+        if (!channels) return l2_channel;
+        for (const auto& c : *channels)
+        {
+            const auto* channel = c.as_table();
+            if (!channel) continue;
+            l2_channel.push_back({
+                (*channel)["quote_type"].value_or(""),
+                (*channel)["recv_mode"].value_or("normal"),
+                (*channel)["eth_name"].value_or(""),
+                (*channel)["multicast_ip"].value_or(""),
+                (*channel)["multicast_port"].value_or(uint16_t{0}),
+                (*channel)["rx_cpu_id"].value_or(-1),
+                (*channel)["handle_cpu_id"].value_or(-1),
+                (*channel)["rx_pkt_num"].value_or(8),
+                (*channel)["spsc_size"].value_or(8),
+                (*channel)["queue_capacity"].value_or(0u),
+            });
+        }
+        return l2_channel;
+    }
+    static OrderBookConfig load_order_book_config(const auto& order_book_config)
+    {
+        std::vector<int32_t> shard_cpu_id;
+        if (auto* cpu_ids = order_book_config["shard_cpu_id"].as_array())
+        {
+            for (const auto& c : *cpu_ids) shard_cpu_id.emplace_back(c.value_or(-1));
+        }
+        return {
+            order_book_config["shard_num"].value_or(0u),
+            shard_cpu_id,
+            order_book_config["queue_capacity"].value_or(32768u),
+            order_book_config["depth"].value_or(10u),
+            order_book_config["snapshot_interval_ms"].value_or(0u),
+            order_book_config["last_value_store"].value_or(""),
+        };
+    }
     EngineConfig load_engine_config(std::string_view config_file_path)
     {
         auto config = toml::parse_file(config_file_path);
@@ -33,6 +73,9 @@ namespace rk::config_type
         return {
             {
                 config["account_config"]["account_name"].value_or(""),
+                config["account_config"]["order_capacity"].value_or(16384u),
+                config["account_config"]["trade_capacity"].value_or(65536u),
+                config["account_config"]["journal_path"].value_or("./journal"),
             },
             {
                 config["md_adapter_config"]["adapter_name"].value_or(""),
@@ -48,6 +91,9 @@ namespace rk::config_type
                 config["md_adapter_config"]["password"].value_or(""),
                 config["md_adapter_config"]["app_id"].value_or(""),
                 config["md_adapter_config"]["auth_code"].value_or(""),
+                config["md_adapter_config"]["l2_front_ip"].value_or(""),
+                config["md_adapter_config"]["l2_front_port"].value_or(""),
+                load_l2_channel_config(config["md_adapter_config"]),
             },
             {
                 config["td_adapter_config"]["adapter_name"].value_or(""),
@@ -61,26 +107,51 @@ namespace rk::config_type
                 config["td_adapter_config"]["password"].value_or(""),
                 config["td_adapter_config"]["app_id"].value_or(""),
                 config["td_adapter_config"]["auth_code"].value_or(""),
+                config["account_config"]["order_capacity"].value_or(16384u),
             },
             {
                 config["risk_control_config"]["daily_order_num"].value_or(0),
                 config["risk_control_config"]["daily_cancel_num"].value_or(0),
                 config["risk_control_config"]["daily_repeat_order_num"].value_or(0),
+                config["risk_control_config"]["order_rate"].value_or(0u),
+                config["risk_control_config"]["order_burst"].value_or(0u),
             },
             {
                 config["db_config"]["user"].value_or(""),
                 config["db_config"]["password"].value_or(""),
                 config["db_config"]["ip"].value_or(""),
                 config["db_config"]["port"].value_or(0),
-                config["db_config"]["database"].value_or("")
+                config["db_config"]["database"].value_or(""),
+                config["db_config"]["batch_size"].value_or(1000u),
+                config["db_config"]["flush_interval_ms"].value_or(100u),
+                config["db_config"]["queue_capacity"].value_or(16384u),
+                config["db_config"]["backpressure"].value_or("drop"),
+                config["db_config"]["snapshot_interval_s"].value_or(60u)
+            },
+            {
+                config["algo_config"]["volume_profile_path"].value_or("./volume_profile"),
             }
         };
 
     }
     AlgoExecutorConfig load_algo_executor_config(std::string_view config_file_path)
     {
-
-        return {};
+        auto config = toml::parse_file(config_file_path);
+        std::vector<std::tuple<std::string, std::string>> schedule;
+        if (auto* sessions = config["schedule"].as_array())
+        {
+            for (const auto& session : *sessions)
+            {
+                const auto* times = session.as_array();
+                if (!times || times->size() != 2) continue;
+                schedule.emplace_back((*times)[0].value_or(""), (*times)[1].value_or(""));
+            }
+        }
+        return {
+            load_engine_config(config_file_path),
+            config["req_endpoint"].value_or(""),
+            std::move(schedule)
+        };
     }
     MDGatewayConfig MDGatewayConfig::load_config_file(std::string_view config_file_path)
     {
@@ -111,7 +182,12 @@ namespace rk::config_type
                 config["md_adapter_config"]["password"].value_or(""),
                 config["md_adapter_config"]["app_id"].value_or(""),
                 config["md_adapter_config"]["auth_code"].value_or(""),
-            }
+                config["md_adapter_config"]["l2_front_ip"].value_or(""),
+                config["md_adapter_config"]["l2_front_port"].value_or(""),
+                load_l2_channel_config(config["md_adapter_config"]),
+            },
+            load_order_book_config(config["order_book_config"]),
+            config["iopv"].value_or(false),
         };
     }
 
@@ -3,26 +3,50 @@
 //
 
 #include "algo.h"
+#include "impl/pov.h"
 #include "impl/twap.h"
+#include "impl/vwap.h"
 
 
 namespace rk::algo
 {
+    bool Algo::init_symbol_data()
+    {
+        const auto& market_info = _engine._market_info;
+        const auto& trade_info = _engine._trade_info;
+        // 最新行情按合约预先分配, 需以订阅集合判断是否会收到行情
+        if (!market_info || !trade_info || !_engine.is_subscribed(_symbol)) return false;
+        const auto detail_it = market_info->_symbol_details.find(_symbol);
+        const auto tick_it = market_info->_last_tick_data.find(_symbol);
+        const auto position_it = trade_info->_position_data.find(_symbol);
+        if (
+            detail_it == market_info->_symbol_details.end() ||
+            tick_it == market_info->_last_tick_data.end() ||
+            position_it == trade_info->_position_data.end()
+        )
+            return false;
+        _symbol_detail = detail_it->second;
+        _last_tick = tick_it->second;
+        _position_data = position_it->second;
+        return _symbol_detail && _last_tick && _position_data;
+    }
+    void Algo::release()
+    {
+        _engine.release_algo(*this);
+    }
     std::shared_ptr<Algo> create_algo(
         EngineImpl& engine,
+        AlgoType algo_type,
         const data_type::Symbol& symbol,
-        const std::string& algo_name,
         const std::string& algo_param_json
     )
     {
-        if (algo_name == "TWAP")
+        switch (algo_type)
         {
-            return std::make_shared<Twap>(
-                engine,
-                symbol,
-                algo_param_json
-            );
+            case AlgoType::TWAP: return std::make_shared<Twap>(engine, symbol, algo_param_json);
+            case AlgoType::VWAP: return std::make_shared<Vwap>(engine, symbol, algo_param_json);
+            case AlgoType::POV: return std::make_shared<Pov>(engine, symbol, algo_param_json);
+            default: return nullptr;
         }
-        return nullptr;
     }
 };
\ No newline at end of file
@@ -9,11 +9,29 @@
 
 namespace rk::algo
 {
+    // 与AlgoReq::algo_name一致
+    enum class AlgoType : uint8_t
+    {
+        TWAP,
+        VWAP,
+        POV,
+        UNKNOWN
+    };
     class Algo : public interface::Strategy
     {
     public:
         Algo(EngineImpl& engine, data_type::Symbol symbol): _engine(engine), _symbol(std::move(symbol)) {}
         ~Algo() override = default;
+        [[nodiscard]] virtual AlgoType algo_type() const = 0;
+        [[nodiscard]] const data_type::Symbol& symbol() const {return _symbol;}
+        // 从池中复用前重置到新合约, 策略号和定时器号保留
+        virtual void reset(const data_type::Symbol& symbol, const std::string& algo_param_json)
+        {
+            _symbol = symbol;
+            _last_tick = nullptr;
+            _symbol_detail = nullptr;
+            _position_data = nullptr;
+        }
         std::unordered_set<data_type::Symbol> on_init(uint32_t trading_day) final
         {
             std::unordered_set<data_type::Symbol> symbols_to_sub{};
@@ -29,7 +47,14 @@ namespace rk::algo
         void on_cancel(const data_type::CancelData& data) override {};
         void on_error(const data_type::OrderError& data) override {};
         void on_algo_req(const data_type::AlgoReq& data) override {};
+        // 会话结束由引擎调用, 停止执行并归还实例池
+        virtual void on_session_end() {release();}
     protected:
+        // 取合约信息、最新行情和持仓, 合约未订阅返回false
+        bool init_symbol_data();
+        // 停止或出错后归还实例池, 调用后不再收到该合约的行情
+        void release();
+
         uint32_t _strategy_id = 0;
         EngineImpl& _engine;
         data_type::Symbol _symbol;
@@ -40,8 +65,8 @@ namespace rk::algo
 
     std::shared_ptr<Algo> create_algo(
         EngineImpl& engine,
+        AlgoType algo_type,
         const data_type::Symbol& symbol,
-        const std::string& algo_name,
         const std::string& algo_param_json
     );
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "algo_pool.h"
+
+namespace rk::algo
+{
+    AlgoPool::AlgoPool(EngineImpl& engine, RegisterFunc register_func)
+        :   _engine(engine), _register_func(std::move(register_func))
+    {
+
+    }
+    Algo* AlgoPool::acquire(AlgoType algo_type, const data_type::Symbol& symbol, const std::string& algo_param_json)
+    {
+        if (algo_type == AlgoType::UNKNOWN) return nullptr;
+        auto& free_list = _free_lists[static_cast<size_t>(algo_type)];
+        if (!free_list.empty())
+        {
+            auto* algo = free_list.back();
+            free_list.pop_back();
+            algo->reset(symbol, algo_param_json);
+            return algo;
+        }
+        auto algo = create_algo(_engine, algo_type, symbol, algo_param_json);
+        if (!algo) return nullptr;
+        auto* ret = algo.get();
+        ret->set_strategy_id(_register_func(std::move(algo)));
+        ++_created_num;
+        return ret;
+    }
+    void AlgoPool::release(Algo& algo)
+    {
+        _free_lists[static_cast<size_t>(algo.algo_type())].push_back(&algo);
+    }
+};
@@ -0,0 +1,45 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "algo/algo.h"
+
+namespace rk::algo
+{
+    /// 算法实例池, 按算法类型分别保存空闲实例
+    /// 算法停止后归还, 下次同类型请求重置到新合约后复用; 实例只在新建时登记为策略, 策略表大小为同时运行算法数的峰值
+    /// 只在引擎线程使用
+    class AlgoPool
+    {
+    public:
+        // 新建实例的策略登记, 返回策略号
+        using RegisterFunc = std::function<uint32_t(std::shared_ptr<Algo> algo)>;
+
+        AlgoPool(EngineImpl& engine, RegisterFunc register_func);
+        ~AlgoPool() = default;
+        AlgoPool(const AlgoPool&) = delete;
+        AlgoPool& operator=(const AlgoPool&) = delete;
+
+        // 优先复用同类型空闲实例, 无空闲时新建; 类型不支持返回nullptr
+        Algo* acquire(AlgoType algo_type, const data_type::Symbol& symbol, const std::string& algo_param_json);
+        void release(Algo& algo);
+        [[nodiscard]] size_t created_num() const {return _created_num;}
+        [[nodiscard]] size_t free_num() const
+        {
+            size_t num = 0;
+            for (const auto& free_list : _free_lists) num += free_list.size();
+            return num;
+        }
+
+    private:
+        EngineImpl& _engine;
+        RegisterFunc _register_func;
+        std::array<std::vector<Algo*>, static_cast<size_t>(AlgoType::UNKNOWN)> _free_lists;    // 按算法类型索引, 实例由策略表持有
+        size_t _created_num = 0;
+    };
+};
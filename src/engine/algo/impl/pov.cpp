@@ -0,0 +1,38 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "pov.h"
+#include <cmath>
+namespace rk::algo
+{
+    Pov::Pov(EngineImpl& engine, const data_type::Symbol& symbol, const std::string& algo_param_json)
+        :   SliceAlgo(engine, symbol, SliceAlgoParam(algo_param_json))
+    {
+
+    }
+    void Pov::reset(const data_type::Symbol& symbol, const std::string& algo_param_json)
+    {
+        SliceAlgo::reset(symbol, algo_param_json);
+        _last_volume = 0;
+        _market_volume = 0;
+    }
+    void Pov::on_start(const util::DateTime& datetime)
+    {
+        _last_volume = _last_tick->volume;
+        _market_volume = 0;
+    }
+    void Pov::on_tick(const data_type::TickData& data)
+    {
+        const auto delta = data.volume - _last_volume;
+        _last_volume = data.volume;
+        if (!running() || delta <= 0 || data.update_time < _start_time) return;
+        _market_volume += delta;
+        try_send_order(util::DateTime::now());
+    }
+    uint32_t Pov::slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot)
+    {
+        const auto target = std::llround(_market_volume * _algo_param.participation_rate);
+        const auto executed = static_cast<int64_t>(executed_volume(remain_volume));
+        return target > executed ? static_cast<uint32_t>(target - executed) : 0u;
+    }
+};
@@ -0,0 +1,30 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include "algo/slice_algo.h"
+namespace rk::algo
+{
+    /// 成交量跟随, 目标完成量为开始后市场累计成交量乘参与率
+    /// 每笔行情只累加成交量增量, 无在途子单且缺口达到一手时立即报出; 未完成子单仍按定时器撤单重报
+    class Pov final : public SliceAlgo
+    {
+    public:
+        Pov(EngineImpl& engine, const data_type::Symbol& symbol, const std::string& algo_param_json);
+        ~Pov() override = default;
+        Pov() = delete;
+        Pov(Pov&&) = delete;
+        Pov(const Pov&) = delete;
+        [[nodiscard]] AlgoType algo_type() const override {return AlgoType::POV;}
+        void reset(const data_type::Symbol& symbol, const std::string& algo_param_json) override;
+        void on_tick(const data_type::TickData& data) override;
+    private:
+        [[nodiscard]] std::string_view algo_name() const override {return "pov";}
+        void on_start(const util::DateTime& datetime) override;
+        uint32_t slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot) override;
+
+        int64_t _last_volume = 0;               // 上一笔行情的当日累计成交量
+        int64_t _market_volume = 0;             // 开始后的市场成交量
+    };
+};
@@ -0,0 +1,40 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "vwap.h"
+#include <cmath>
+#include "util/logger.h"
+namespace rk::algo
+{
+    Vwap::Vwap(EngineImpl& engine, const data_type::Symbol& symbol, const std::string& algo_param_json)
+        :   SliceAlgo(engine, symbol, SliceAlgoParam(algo_param_json))
+    {
+
+    }
+    void Vwap::reset(const data_type::Symbol& symbol, const std::string& algo_param_json)
+    {
+        SliceAlgo::reset(symbol, algo_param_json);
+        _profile_loaded = false;
+        _profile = nullptr;
+        _window_volume = 0.;
+    }
+    void Vwap::on_start(const util::DateTime& datetime)
+    {
+        // 分布只在首次执行时查找, 重复下达目标沿用
+        if (!_profile_loaded)
+        {
+            _profile_loaded = true;
+            _profile = _engine.volume_profile(_symbol);
+            if (!_profile) RK_LOG_WARN("vwap {} volume profile not found, fallback to twap", _symbol.symbol.c_str());
+        }
+        _window_volume = _profile ? _profile->volume(_start_time, _algo_req.end_time) : 0.;
+    }
+    uint32_t Vwap::slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot)
+    {
+        if (_window_volume <= 0) return uniform_slice_volume(datetime, remain_volume, lot);
+        const auto next_time = std::min(datetime + util::TimeDelta(std::chrono::seconds(_algo_param.retry_interval_secs)), _algo_req.end_time);
+        const auto target = std::llround(_total_volume * std::min(_profile->volume(_start_time, next_time) / _window_volume, 1.));
+        const auto executed = static_cast<int64_t>(executed_volume(remain_volume));
+        return target > executed ? static_cast<uint32_t>(target - executed) : 0u;
+    }
+};
@@ -0,0 +1,31 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include "algo/slice_algo.h"
+#include "algo/volume_profile.h"
+namespace rk::algo
+{
+    /// 成交量加权, 按历史日内成交量分布分配目标: 每个切片补足到下个切片时刻应完成的比例
+    /// 分布文件为<volume_profile_path>/<合约>.csv, 会话开始时由引擎预加载, 缺失或执行时段内历史成交量为0时退化为TWAP
+    class Vwap final : public SliceAlgo
+    {
+    public:
+        Vwap(EngineImpl& engine, const data_type::Symbol& symbol, const std::string& algo_param_json);
+        ~Vwap() override = default;
+        Vwap() = delete;
+        Vwap(Vwap&&) = delete;
+        Vwap(const Vwap&) = delete;
+        [[nodiscard]] AlgoType algo_type() const override {return AlgoType::VWAP;}
+        void reset(const data_type::Symbol& symbol, const std::string& algo_param_json) override;
+    private:
+        [[nodiscard]] std::string_view algo_name() const override {return "vwap";}
+        void on_start(const util::DateTime& datetime) override;
+        uint32_t slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot) override;
+
+        bool _profile_loaded = false;
+        std::shared_ptr<const VolumeProfile> _profile;
+        double _window_volume = 0.;             // 执行时段内的历史成交量
+    };
+};
@@ -0,0 +1,208 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "slice_algo.h"
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include "util/logger.h"
+namespace rk::algo
+{
+    SliceAlgoParam::SliceAlgoParam(const std::string& algo_param_json)
+    {
+
+        const auto json = nlohmann::json::parse(algo_param_json, nullptr, false);
+
+        if (!json.is_discarded())
+        {
+            if (json.find("retry_interval_secs") != json.end()) retry_interval_secs = json["retry_interval_secs"];
+            if (json.find("rate") != json.end()) participation_rate = json["rate"];
+        }
+        retry_interval_secs = std::max(retry_interval_secs, 1);
+        participation_rate = std::clamp(participation_rate, 0., 1.);
+    }
+    SliceAlgo::SliceAlgo(EngineImpl& engine, const data_type::Symbol& symbol, SliceAlgoParam algo_param)
+        :   Algo(engine, symbol), _algo_param(algo_param)
+    {
+
+    }
+    void SliceAlgo::on_algo_req(const data_type::AlgoReq& data)
+    {
+        if (_algo_status == AlgoStatus::ERROR) return;
+        _algo_req = data;
+        if (!init_symbol_data())
+        {
+            _algo_status = AlgoStatus::ERROR;
+            RK_LOG_ERROR("{} {} symbol data not found, algo error", algo_name(), _symbol.symbol.c_str());
+            release();
+            return;
+        }
+        // 按T+1持仓对齐, 可平量取昨仓, 期货等T+0合约不支持
+        if (!_symbol_detail->is_cash_settled())
+        {
+            _algo_status = AlgoStatus::ERROR;
+            RK_LOG_ERROR("{} {} {} not supported, algo error", algo_name(), _symbol.symbol.c_str(), magic_enum::enum_name(_symbol_detail->product_class));
+            release();
+            return;
+        }
+        if (!_timer_id) _timer_id = _engine.add_timer(_strategy_id);
+        if (!_executing_order_ref) _algo_status = AlgoStatus::IDLE;
+        const auto now = util::DateTime::now();
+        const auto delta = delta_position();
+        _start_time = std::max(data.start_time, now);
+        _total_volume = static_cast<uint32_t>(delta >= 0 ? delta : -delta);
+        on_start(now);
+        // 新目标从开始时间起重新切片, 在途子单在首个切片时撤单重报
+        _engine.schedule_timer(*_timer_id, _start_time);
+        RK_LOG_INFO("{} {}", algo_name(), data_type::to_json(data).dump().c_str());
+    }
+    void SliceAlgo::reset(const data_type::Symbol& symbol, const std::string& algo_param_json)
+    {
+        Algo::reset(symbol, algo_param_json);
+        _algo_param = SliceAlgoParam(algo_param_json);
+        _algo_req = {};
+        _start_time = {};
+        _total_volume = 0;
+        _algo_status = AlgoStatus::UNKNOWN;
+        if (_timer_id) _engine.cancel_timer(*_timer_id);
+        _executing_order_ref = std::nullopt;
+        _working_volume = 0;
+    }
+    void SliceAlgo::on_session_end()
+    {
+        // 在途子单撤单, 停止后的回报不再处理
+        if (_executing_order_ref) _engine.order_cancel(_strategy_id, *_executing_order_ref);
+        if (running()) stop();
+        else release();
+    }
+    void SliceAlgo::on_timer(uint32_t timer_id)
+    {
+        retry_order(util::DateTime::now());
+    }
+    void SliceAlgo::on_trade(const data_type::TradeData& data)
+    {
+        if (!running() || _executing_order_ref != data.order_ref) return;
+        _working_volume -= std::min(data.trade_volume, _working_volume);
+        if (_working_volume == 0) on_order_finished(util::DateTime::now());
+    }
+    void SliceAlgo::on_cancel(const data_type::CancelData& data)
+    {
+        if (!running() || _executing_order_ref != data.order_ref) return;
+        _working_volume -= std::min(data.cancel_volume, _working_volume);
+        if (_working_volume == 0) on_order_finished(util::DateTime::now());
+    }
+    void SliceAlgo::on_error(const data_type::OrderError& data)
+    {
+        if (!running() || _executing_order_ref != data.order_ref) return;
+        // 撤单失败一般是已成交, 等待成交回报
+        if (data.error_type == data_type::ErrorType::ORDER_CANCEL_ERROR)
+        {
+            if (_algo_status == AlgoStatus::CANCELING) _algo_status = AlgoStatus::EXECUTING;
+            return;
+        }
+        // 报单被拒, 下个切片重新报
+        RK_LOG_WARN("{} {} order ref {} rejected, {}", algo_name(), _symbol.symbol.c_str(), data.order_ref, data.error_msg.c_str());
+        _executing_order_ref = std::nullopt;
+        _working_volume = 0;
+        _algo_status = AlgoStatus::IDLE;
+    }
+    uint32_t SliceAlgo::uniform_slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot) const
+    {
+        const auto remain_secs = std::max((_algo_req.end_time - datetime).seconds(), 0L);
+        const auto split_count = std::max((remain_secs + _algo_param.retry_interval_secs - 1) / _algo_param.retry_interval_secs, 1L);
+        return std::max(static_cast<uint32_t>(remain_volume / split_count), lot);
+    }
+    void SliceAlgo::try_send_order(const util::DateTime& datetime)
+    {
+        if (!running() || _executing_order_ref || datetime < _start_time || datetime >= _algo_req.end_time) return;
+        send_order(datetime);
+    }
+    void SliceAlgo::retry_order(const util::DateTime& datetime)
+    {
+        if (!running()) return;
+        const auto finished = datetime >= _algo_req.end_time;
+        if (finished && !_executing_order_ref)
+        {
+            stop();
+            return;
+        }
+        // 上一笔子单未完成, 撤单后在撤单回报中重报; 已到结束时间只撤不报
+        if (_executing_order_ref)
+        {
+            if (_algo_status != AlgoStatus::CANCELING && _engine.order_cancel(_strategy_id, *_executing_order_ref))
+            {
+                _algo_status = AlgoStatus::CANCELING;
+            }
+        }
+        else send_order(datetime);
+        // 撤单未完成时按间隔继续检查
+        const auto next_time = datetime + util::TimeDelta(std::chrono::seconds(_algo_param.retry_interval_secs));
+        _engine.schedule_timer(*_timer_id, finished ? next_time : std::min(next_time, _algo_req.end_time));
+    }
+    void SliceAlgo::send_order(const util::DateTime& datetime)
+    {
+        const auto req = align_position(datetime);
+        if (req.volume == 0)
+        {
+            _algo_status = AlgoStatus::IDLE;
+            return;
+        }
+        _algo_status = AlgoStatus::SENDING;
+        _executing_order_ref = _engine.order_insert(_strategy_id, req);
+        if (!_executing_order_ref)
+        {
+            _algo_status = AlgoStatus::IDLE;
+            return;
+        }
+        _working_volume = req.volume;
+        _algo_status = AlgoStatus::EXECUTING;
+    }
+    void SliceAlgo::on_order_finished(const util::DateTime& datetime)
+    {
+        const auto canceling = _algo_status == AlgoStatus::CANCELING;
+        _executing_order_ref = std::nullopt;
+        _algo_status = AlgoStatus::IDLE;
+        if (datetime >= _algo_req.end_time) stop();
+        // 撤单重报
+        else if (canceling) send_order(datetime);
+    }
+    void SliceAlgo::stop()
+    {
+        _algo_status = AlgoStatus::STOPPED;
+        if (_timer_id) _engine.cancel_timer(*_timer_id);
+        RK_LOG_INFO(
+            "{} {} stopped, target position {} position {}",
+            algo_name(), _symbol.symbol.c_str(), _algo_req.net_position, _position_data->net_position()
+        );
+        release();
+    }
+    int64_t SliceAlgo::delta_position() const
+    {
+        return static_cast<int64_t>(_algo_req.net_position) - _position_data->net_position();
+    }
+    data_type::OrderReq SliceAlgo::align_position(const util::DateTime& datetime) {
+        const auto delta = delta_position();
+        const auto direction = delta >= 0 ? data_type::Direction::LONG : data_type::Direction::SHORT;
+        const auto offset = delta >= 0 ? data_type::Offset::OPEN : data_type::Offset::CLOSE;
+        const auto remain_volume = static_cast<uint32_t>(delta >= 0 ? delta : -delta);
+        // 按最小下单单位取整, 不足一手的部分不报
+        const auto lot = std::max(direction == data_type::Direction::LONG ? _symbol_detail->min_buy_volume : _symbol_detail->min_sell_volume, 1u);
+        auto max_volume = remain_volume;
+        if (direction == data_type::Direction::SHORT) max_volume = std::min(max_volume, _position_data->closable_volume(direction, offset));
+        const auto order_max_volume = direction == data_type::Direction::LONG ? _symbol_detail->max_buy_volume : _symbol_detail->max_sell_volume;
+        if (order_max_volume > 0) max_volume = std::min(max_volume, order_max_volume);
+        const auto suborder_volume = remain_volume == 0 ? 0u : std::min(slice_volume(datetime, remain_volume, lot), max_volume) / lot * lot;
+        // 对手价, 无盘口时取最新价
+        const auto& tick = *_last_tick;
+        auto price = direction == data_type::Direction::LONG ? tick.ask_price[0] : tick.bid_price[0];
+        if (price <= 0) price = tick.last_price;
+        price = std::clamp(price, tick.lower_limit_price, tick.upper_limit_price);
+        return {
+            _symbol,
+            price,
+            price > 0 ? suborder_volume : 0u,
+            direction,
+            offset
+        };
+
+    }
+};
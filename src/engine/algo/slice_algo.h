@@ -0,0 +1,84 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <string_view>
+#include "algo/algo.h"
+#include "util/datetime.h"
+namespace rk::algo
+{
+    struct SliceAlgoParam
+    {
+        int retry_interval_secs = 30;
+        double participation_rate = 0.1;        // 仅POV使用
+        explicit SliceAlgoParam(const std::string& algo_param_json);
+    };
+    /// 切片执行算法的子单管理, TWAP/VWAP/POV共用
+    /// 按引擎定时器每个重试间隔检查一次: 无在途子单则按slice_volume报一笔, 有在途子单则撤单, 撤单回报后立即按剩余目标重报
+    /// 同一时刻最多一笔子单在途, 子单状态只保存报单号和在途数量, 切片不分配内存
+    /// 子单数量按最小下单单位取整, 卖出不超过可平数量; 到结束时间只撤不报, 子单结束后停止并归还实例池
+    class SliceAlgo : public Algo
+    {
+        enum class AlgoStatus
+        {
+            UNKNOWN,
+            STOPPED,
+            ERROR,
+            SENDING,
+            CANCELING,
+            EXECUTING,
+            IDLE
+        };
+    public:
+        SliceAlgo(EngineImpl& engine, const data_type::Symbol& symbol, SliceAlgoParam algo_param);
+        ~SliceAlgo() override = default;
+        SliceAlgo() = delete;
+        SliceAlgo(SliceAlgo&&) = delete;
+        SliceAlgo(const SliceAlgo&) = delete;
+        void on_timer(uint32_t timer_id) override;
+        void on_trade(const data_type::TradeData& data) override;
+        void on_cancel(const data_type::CancelData& data) override;
+        void on_error(const data_type::OrderError& data) override;
+        void on_algo_req(const data_type::AlgoReq& data) override;
+        void on_session_end() override;
+        void reset(const data_type::Symbol& symbol, const std::string& algo_param_json) override;
+    protected:
+        [[nodiscard]] virtual std::string_view algo_name() const = 0;
+        // 新目标开始执行
+        virtual void on_start(const util::DateTime& datetime) {}
+        // 本次切片的目标数量, remain_volume为距目标仓位的剩余数量, 返回值由调用方按lot取整并截断到剩余数量
+        virtual uint32_t slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot) = 0;
+        // 剩余时间均分
+        [[nodiscard]] uint32_t uniform_slice_volume(const util::DateTime& datetime, uint32_t remain_volume, uint32_t lot) const;
+        [[nodiscard]] bool running() const
+        {
+            return _algo_status != AlgoStatus::UNKNOWN && _algo_status != AlgoStatus::STOPPED && _algo_status != AlgoStatus::ERROR;
+        }
+        // 无在途子单且在执行时段内时报出一笔, 供行情驱动的算法调用
+        void try_send_order(const util::DateTime& datetime);
+        [[nodiscard]] uint32_t executed_volume(uint32_t remain_volume) const
+        {
+            return remain_volume < _total_volume ? _total_volume - remain_volume : 0;
+        }
+
+        SliceAlgoParam _algo_param;
+        data_type::AlgoReq _algo_req;
+        util::DateTime _start_time;             // 开始时间与收到请求时间的较晚者
+        uint32_t _total_volume = 0;             // 开始时距目标仓位的数量
+    private:
+        void retry_order(const util::DateTime& datetime);
+        void send_order(const util::DateTime& datetime);
+        // 子单成交或撤单完毕
+        void on_order_finished(const util::DateTime& datetime);
+        void stop();
+        [[nodiscard]] int64_t delta_position() const;
+        // 按目标持仓生成本次子单, 仅股票/ETF, 卖出不超过可平昨仓
+        data_type::OrderReq align_position(const util::DateTime& datetime);
+
+        AlgoStatus _algo_status = AlgoStatus::UNKNOWN;
+        std::optional<uint32_t> _timer_id = std::nullopt;
+        std::optional<data_type::OrderRef> _executing_order_ref = std::nullopt;
+        uint32_t _working_volume = 0;
+    };
+};
@@ -0,0 +1,48 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "volume_profile.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+namespace rk::algo
+{
+    std::optional<VolumeProfile> VolumeProfile::load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open()) return std::nullopt;
+        std::array<double, minutes_per_day> minute_volume{};
+        size_t line_num = 0;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            int hour = 0;
+            int minute = 0;
+            double volume = 0.;
+            if (std::sscanf(line.c_str(), "%d:%d,%lf", &hour, &minute, &volume) != 3) continue;
+            if (hour < 0 || hour >= 24 || minute < 0 || minute >= 60 || volume < 0) continue;
+            minute_volume[hour * 60 + minute] += volume;
+            ++line_num;
+        }
+        if (line_num == 0) return std::nullopt;
+        VolumeProfile profile;
+        for (size_t i = 0; i < minutes_per_day; ++i)
+        {
+            profile._cumulative[i + 1] = profile._cumulative[i] + minute_volume[i];
+        }
+        return profile;
+    }
+    double VolumeProfile::volume(const util::DateTime& begin, const util::DateTime& end) const
+    {
+        if (end <= begin) return 0.;
+        const auto begin_seconds = begin.hour() * 3600 + begin.minute() * 60 + begin.second();
+        const auto days = (begin_seconds + (end - begin).seconds()) / 86400;
+        return cumulative(end) - cumulative(begin) + static_cast<double>(days) * _cumulative[minutes_per_day];
+    }
+    double VolumeProfile::cumulative(const util::DateTime& datetime) const
+    {
+        const auto minute = static_cast<size_t>(datetime.hour() * 60 + datetime.minute());
+        const auto ratio = (datetime.second() + datetime.millisecond() / 1000.) / 60.;
+        return _cumulative[minute] + (_cumulative[minute + 1] - _cumulative[minute]) * ratio;
+    }
+};
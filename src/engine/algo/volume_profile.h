@@ -0,0 +1,27 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <array>
+#include <filesystem>
+#include <optional>
+#include "util/datetime.h"
+namespace rk::algo
+{
+    /// 日内成交量分布, 按本地时间每分钟一个桶, 保存当日零点起的累计成交量
+    /// 历史数据文件每行"HH:MM,成交量", 为该分钟的历史平均成交量; 无法解析的行(表头)跳过, 缺失的分钟按0处理
+    /// 区间成交量为两端累计量之差, 查询O(1)
+    class VolumeProfile
+    {
+    public:
+        static constexpr size_t minutes_per_day = 24 * 60;
+        static std::optional<VolumeProfile> load(const std::filesystem::path& path);
+        // [begin, end)区间的历史成交量, 分钟内线性插值, 跨零点按次日累加
+        [[nodiscard]] double volume(const util::DateTime& begin, const util::DateTime& end) const;
+    private:
+        [[nodiscard]] double cumulative(const util::DateTime& datetime) const;
+
+        std::array<double, minutes_per_day + 1> _cumulative{};
+    };
+};
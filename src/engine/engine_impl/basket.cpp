@@ -0,0 +1,226 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "basket.h"
+#include <algorithm>
+#include "engine_impl/engine_impl.h"
+#include "util/logger.h"
+namespace rk
+{
+    BasketManager::BasketManager(ProgressCallback on_progress)
+        :   _on_progress(std::move(on_progress))
+    {
+
+    }
+    std::optional<data_type::BasketId> BasketManager::insert(
+        uint32_t strategy_id,
+        data_type::BasketReq req,
+        const MarketInfo& market_info,
+        const std::unordered_set<data_type::Symbol>& subscribed_symbols
+    )
+    {
+        if (req.legs.empty())
+        {
+            RK_LOG_WARN("basket {} has no leg", req.basket_name.c_str());
+            return std::nullopt;
+        }
+        const auto basket_id = static_cast<data_type::BasketId>(_baskets.size());
+        Basket basket{strategy_id, req.basket_name};
+        basket.legs.reserve(req.legs.size());
+        for (uint32_t leg_id = 0; leg_id < req.legs.size(); ++leg_id)
+        {
+            auto& order_req = req.legs[leg_id];
+            const auto it = market_info._symbol_details.find(order_req.symbol);
+            if (
+                it == market_info._symbol_details.end() || !it->second ||
+                !subscribed_symbols.contains(order_req.symbol) ||
+                order_req.volume == 0
+            )
+            {
+                RK_LOG_WARN("basket {} leg {} {} unsubscribed or volume 0, basket rejected", req.basket_name.c_str(), leg_id, order_req.symbol.symbol.c_str());
+                return std::nullopt;
+            }
+            const auto multiplier = static_cast<double>(it->second->multiplier);
+            basket.progress.target_amount += order_req.limit_price * order_req.volume * multiplier;
+            basket.legs.push_back({std::move(order_req), multiplier});
+        }
+        auto& progress = basket.progress;
+        progress.basket_id = basket_id;
+        progress.status = data_type::BasketStatus::SENDING;
+        progress.leg_num = static_cast<uint32_t>(basket.legs.size());
+        progress.update_time = util::DateTime::now();
+        basket.pending_num = progress.leg_num;
+        basket.insert_time = std::chrono::steady_clock::now();
+        _baskets.push_back(std::move(basket));
+        for (uint32_t leg_id = 0; leg_id < progress.leg_num; ++leg_id)
+        {
+            _tasks.push_back({basket_id, leg_id, TaskType::INSERT});
+        }
+        return basket_id;
+    }
+    bool BasketManager::cancel(uint32_t strategy_id, data_type::BasketId basket_id)
+    {
+        if (basket_id >= _baskets.size() || _baskets[basket_id].strategy_id != strategy_id)
+        {
+            RK_LOG_WARN("strategy {} basket {} not found, basket cancel failed", strategy_id, basket_id);
+            return false;
+        }
+        auto& basket = _baskets[basket_id];
+        if (basket.progress.is_finished() || (basket.cancel_requested && basket.progress.cancel_failed_leg_num == 0)) return false;
+        const auto retry = basket.cancel_requested;
+        basket.cancel_requested = true;
+        // 撤单插到队首, 先于其他组合的待报子单
+        uint32_t cancel_num = 0;
+        for (auto leg_id = static_cast<uint32_t>(basket.legs.size()); leg_id-- > 0;)
+        {
+            auto& leg = basket.legs[leg_id];
+            if (leg.status != LegStatus::SENT || (retry && !leg.cancel_failed)) continue;
+            if (leg.cancel_failed) --basket.progress.cancel_failed_leg_num;
+            leg.cancel_failed = false;
+            leg.cancel_retry_num = 0;
+            _tasks.push_front({basket_id, leg_id, TaskType::CANCEL});
+            ++cancel_num;
+        }
+        RK_LOG_INFO("basket {} {} cancel, {} legs canceling, {} legs unsent", basket_id, basket.basket_name.c_str(), cancel_num, basket.pending_num);
+        refresh(basket);
+        return true;
+    }
+    std::optional<BasketManager::Task> BasketManager::next_task()
+    {
+        while (!_tasks.empty())
+        {
+            const auto task = _tasks.front();
+            _tasks.pop_front();
+            auto& basket = _baskets[task.basket_id];
+            auto& leg = basket.legs[task.leg_id];
+            if (task.type == TaskType::CANCEL)
+            {
+                if (leg.is_finished()) continue;
+                return task;
+            }
+            if (!basket.cancel_requested) return task;
+            // 已撤组合的待报子单不再报出
+            --basket.pending_num;
+            finish_leg(basket, leg, LegStatus::CANCELED);
+            if (basket.pending_num == 0) refresh(basket);
+        }
+        return std::nullopt;
+    }
+    bool BasketManager::on_cancel_refused(const Task& task)
+    {
+        auto& basket = _baskets[task.basket_id];
+        auto& leg = basket.legs[task.leg_id];
+        if (++leg.cancel_retry_num < max_cancel_retry_num)
+        {
+            _tasks.push_front(task);
+            return true;
+        }
+        leg.cancel_failed = true;
+        ++basket.progress.cancel_failed_leg_num;
+        RK_LOG_WARN(
+            "basket {} {} leg {} order ref {} cancel refused {} times",
+            task.basket_id, basket.basket_name.c_str(), task.leg_id, leg.order_ref, leg.cancel_retry_num
+        );
+        refresh(basket);
+        return false;
+    }
+    void BasketManager::on_sent(data_type::BasketId basket_id, uint32_t leg_id, std::optional<data_type::OrderRef> order_ref)
+    {
+        auto& basket = _baskets[basket_id];
+        auto& leg = basket.legs[leg_id];
+        --basket.pending_num;
+        if (order_ref)
+        {
+            leg.order_ref = *order_ref;
+            leg.status = LegStatus::SENT;
+            ++basket.progress.sent_leg_num;
+        }
+        else finish_leg(basket, leg, LegStatus::REJECTED);
+        if (basket.pending_num > 0) return;
+        RK_LOG_INFO(
+            "basket {} {} {} legs sent in {}us, rejected {}",
+            basket_id, basket.basket_name.c_str(), basket.progress.sent_leg_num,
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - basket.insert_time).count(),
+            basket.progress.rejected_leg_num
+        );
+        refresh(basket);
+    }
+    void BasketManager::handle_trade(data_type::BasketId basket_id, uint32_t leg_id, const data_type::TradeData& data)
+    {
+        auto& basket = _baskets[basket_id];
+        auto& leg = basket.legs[leg_id];
+        auto& progress = basket.progress;
+        leg.traded_volume += data.trade_volume;
+        const auto amount = data.trade_price * data.trade_volume * leg.multiplier;
+        progress.traded_amount += amount;
+        if (leg.req.direction == data_type::Direction::LONG) progress.long_traded_amount += amount;
+        else progress.short_traded_amount += amount;
+        if (!leg.is_finished() && leg.traded_volume + leg.canceled_volume >= leg.req.volume)
+        {
+            finish_leg(basket, leg, leg.canceled_volume == 0 ? LegStatus::TRADED : LegStatus::CANCELED);
+        }
+        refresh(basket);
+    }
+    void BasketManager::handle_cancel(data_type::BasketId basket_id, uint32_t leg_id, const data_type::CancelData& data)
+    {
+        auto& basket = _baskets[basket_id];
+        auto& leg = basket.legs[leg_id];
+        if (leg.is_finished()) return;
+        leg.canceled_volume += data.cancel_volume;
+        if (leg.traded_volume + leg.canceled_volume >= leg.req.volume) finish_leg(basket, leg, LegStatus::CANCELED);
+        refresh(basket);
+    }
+    void BasketManager::handle_error(data_type::BasketId basket_id, uint32_t leg_id, const data_type::OrderError& data)
+    {
+        auto& basket = _baskets[basket_id];
+        auto& leg = basket.legs[leg_id];
+        // 撤单失败不影响腿状态
+        if (data.error_type != data_type::ErrorType::ORDER_INSERT_ERROR || leg.is_finished()) return;
+        finish_leg(basket, leg, LegStatus::REJECTED);
+        refresh(basket);
+    }
+    void BasketManager::finish_leg(Basket& basket, Leg& leg, LegStatus status)
+    {
+        leg.status = status;
+        auto& progress = basket.progress;
+        if (leg.cancel_failed)
+        {
+            leg.cancel_failed = false;
+            --progress.cancel_failed_leg_num;
+        }
+        ++progress.finished_leg_num;
+        if (status == LegStatus::REJECTED) ++progress.rejected_leg_num;
+        else if (status == LegStatus::TRADED) ++progress.traded_leg_num;
+    }
+    void BasketManager::refresh(Basket& basket)
+    {
+        auto& progress = basket.progress;
+        double min_fill_ratio = 1.;
+        double max_fill_ratio = 0.;
+        for (const auto& leg : basket.legs)
+        {
+            const auto fill_ratio = static_cast<double>(leg.traded_volume) / leg.req.volume;
+            min_fill_ratio = std::min(min_fill_ratio, fill_ratio);
+            max_fill_ratio = std::max(max_fill_ratio, fill_ratio);
+        }
+        progress.min_fill_ratio = min_fill_ratio;
+        progress.max_fill_ratio = max_fill_ratio;
+        progress.update_time = util::DateTime::now();
+        const auto finished = progress.is_finished();
+        if (progress.finished_leg_num == progress.leg_num) progress.status = data_type::BasketStatus::FINISHED;
+        else if (basket.cancel_requested) progress.status = data_type::BasketStatus::CANCELING;
+        else if (basket.pending_num > 0) progress.status = data_type::BasketStatus::SENDING;
+        else progress.status = data_type::BasketStatus::WORKING;
+        if (!finished && progress.is_finished())
+        {
+            RK_LOG_INFO(
+                "basket {} {} finished in {}ms, traded legs {}/{} rejected {}, amount {:.2f}/{:.2f}, net exposure {:.2f}",
+                progress.basket_id, basket.basket_name.c_str(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - basket.insert_time).count(),
+                progress.traded_leg_num, progress.leg_num, progress.rejected_leg_num,
+                progress.traded_amount, progress.target_amount, progress.net_exposure()
+            );
+        }
+        if (_on_progress) _on_progress(basket.strategy_id, progress);
+    }
+};
@@ -0,0 +1,148 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+#include "data_type.h"
+
+namespace rk
+{
+    /// 组合下单, 一个逻辑订单拆为多个子单
+    /// 子单进入待报队列, 由引擎线程按风控流控剩余笔数分批报出; 撤单优先于待报子单
+    /// 子单回报按腿汇总为组合进度推送策略, 不逐腿打印日志, 报出完成和组合结束各输出一行汇总
+    /// 只在引擎线程使用
+    struct MarketInfo;
+    class BasketManager
+    {
+    public:
+        enum class TaskType
+        {
+            INSERT,
+            CANCEL
+        };
+        struct Task
+        {
+            data_type::BasketId basket_id = 0;
+            uint32_t leg_id = 0;
+            TaskType type = TaskType::INSERT;
+        };
+        using ProgressCallback = std::function<void(uint32_t strategy_id, const data_type::BasketProgress& progress)>;
+
+        explicit BasketManager(ProgressCallback on_progress);
+        ~BasketManager() = default;
+        BasketManager(const BasketManager&) = delete;
+        BasketManager& operator=(const BasketManager&) = delete;
+
+        // 各腿合约需已向柜台订阅行情(subscribed_symbols), 任一腿不合法则整个组合不报
+        std::optional<data_type::BasketId> insert(
+            uint32_t strategy_id,
+            data_type::BasketReq req,
+            const MarketInfo& market_info,
+            const std::unordered_set<data_type::Symbol>& subscribed_symbols
+        );
+        // 丢弃待报子单, 已报未完成的子单排队撤单; 撤单中再次调用只重试撤单失败的腿
+        bool cancel(uint32_t strategy_id, data_type::BasketId basket_id);
+
+        // 取下一个待执行任务, 已撤组合的待报子单直接丢弃
+        std::optional<Task> next_task();
+        [[nodiscard]] bool has_task() const {return !_tasks.empty();}
+        [[nodiscard]] uint32_t strategy_id(data_type::BasketId basket_id) const {return _baskets[basket_id].strategy_id;}
+        [[nodiscard]] const data_type::OrderReq& leg_req(data_type::BasketId basket_id, uint32_t leg_id) const {return _baskets[basket_id].legs[leg_id].req;}
+        [[nodiscard]] data_type::OrderRef leg_order_ref(data_type::BasketId basket_id, uint32_t leg_id) const {return _baskets[basket_id].legs[leg_id].order_ref;}
+        [[nodiscard]] const data_type::BasketProgress* progress(data_type::BasketId basket_id) const
+        {
+            return basket_id < _baskets.size() ? &_baskets[basket_id].progress : nullptr;
+        }
+
+        // 风控拒绝撤单, 重试次数内放回队首并返回true, 调用方等下次流控额度再执行; 用尽后记为撤单失败推送策略
+        bool on_cancel_refused(const Task& task);
+        // 子单报出结果, 风控拒绝为nullopt
+        void on_sent(data_type::BasketId basket_id, uint32_t leg_id, std::optional<data_type::OrderRef> order_ref);
+        void handle_trade(data_type::BasketId basket_id, uint32_t leg_id, const data_type::TradeData& data);
+        void handle_cancel(data_type::BasketId basket_id, uint32_t leg_id, const data_type::CancelData& data);
+        void handle_error(data_type::BasketId basket_id, uint32_t leg_id, const data_type::OrderError& data);
+
+        // ETF套利组合: ETF一腿, 成分股各腿方向与ETF相反, 数量为申赎清单数量乘申赎单位数
+        // 必须现金替代的成分股不下单, price_func(symbol, direction)返回各腿限价
+        template<typename PriceFunc>
+        static data_type::BasketReq make_etf_basket(const data_type::ETFDetail& etf, uint32_t unit_num, data_type::Direction etf_direction, PriceFunc&& price_func)
+        {
+            const auto offset = [](data_type::Direction direction)
+            {
+                return direction == data_type::Direction::LONG ? data_type::Offset::OPEN : data_type::Offset::CLOSE;
+            };
+            const auto component_direction = etf_direction == data_type::Direction::LONG ? data_type::Direction::SHORT : data_type::Direction::LONG;
+            data_type::BasketReq req;
+            req.basket_name.assign(etf.symbol.symbol.view());
+            req.legs.reserve(etf.component.size() + 1);
+            req.legs.push_back({
+                etf.symbol,
+                price_func(etf.symbol, etf_direction),
+                static_cast<uint32_t>(etf.unit * unit_num),
+                etf_direction,
+                offset(etf_direction)
+            });
+            for (const auto& component : etf.component)
+            {
+                if (component.replace_type == data_type::CashReplaceType::MUST || component.quantity <= 0) continue;
+                req.legs.push_back({
+                    component.symbol,
+                    price_func(component.symbol, component_direction),
+                    static_cast<uint32_t>(component.quantity * unit_num),
+                    component_direction,
+                    offset(component_direction)
+                });
+            }
+            return req;
+        }
+
+    private:
+        enum class LegStatus
+        {
+            PENDING,
+            SENT,
+            REJECTED,
+            TRADED,
+            CANCELED
+        };
+        struct Leg
+        {
+            data_type::OrderReq req;
+            double multiplier = 1.;
+            data_type::OrderRef order_ref = 0;
+            uint32_t traded_volume = 0;
+            uint32_t canceled_volume = 0;
+            uint32_t cancel_retry_num = 0;
+            bool cancel_failed = false;
+            LegStatus status = LegStatus::PENDING;
+            [[nodiscard]] bool is_finished() const
+            {
+                return status == LegStatus::REJECTED || status == LegStatus::TRADED || status == LegStatus::CANCELED;
+            }
+        };
+        struct Basket
+        {
+            uint32_t strategy_id = 0;
+            util::FixedString<32> basket_name;
+            std::vector<Leg> legs;
+            data_type::BasketProgress progress;
+            uint32_t pending_num = 0;           // 待报子单数
+            bool cancel_requested = false;
+            std::chrono::steady_clock::time_point insert_time;
+        };
+        static constexpr uint32_t max_cancel_retry_num = 3;
+        void finish_leg(Basket& basket, Leg& leg, LegStatus status);
+        // 重算腿间成交比例和组合状态, 推送策略
+        void refresh(Basket& basket);
+
+        ProgressCallback _on_progress;
+        std::vector<Basket> _baskets;           // 按BasketId索引
+        std::deque<Task> _tasks;
+    };
+};
@@ -2,7 +2,10 @@
 #include "util/db.h"
 #include "adapter/adapter.h"
 #include "algo/algo.h"
+#include "algo/algo_pool.h"
+#include "algo/volume_profile.h"
 #include "util/datetime.h"
+#include <algorithm>
 #include <chrono>
 #include <unordered_set>
 #include <filesystem>
@@ -42,24 +45,60 @@ namespace rk
             _config.td_adapter_config
         );
         if (!_td_adapter) throw std::runtime_error(std::format("create td gateway failed!"));
-        _oms = std::make_unique<OMS>(_config.account_config, _db_writer);
+        _oms = std::make_unique<OMS>(_config.account_config);
         _risk_control = std::make_unique<RiskControl>(_is_trading, _config.account_config, _config.risk_control_config, _db_writer);
-        _context = std::make_unique<TradingContext>();
+        _context = std::make_unique<TradingContext>(_config.account_config.order_capacity);
+        // 算法实例只在新建时登记为策略, 停止后回池复用
+        _algo_pool = std::make_unique<algo::AlgoPool>(
+            *this,
+            [this](std::shared_ptr<algo::Algo> algo)
+            {
+                _strategies.push_back(std::move(algo));
+                return static_cast<uint32_t>(_strategies.size() - 1);
+            }
+        );
+        _baskets = std::make_unique<BasketManager>(
+            [this](uint32_t strategy_id, const data_type::BasketProgress& progress) {_strategies[strategy_id]->on_basket(progress);}
+        );
+        _spreads = std::make_unique<SpreadManager>(
+            [this](const data_type::OrderReq& req, uint32_t spread_order_id, uint32_t leg_id)
+            {
+                return send_order(
+                    req,
+                    TradeHandler{
+                        [spread_order_id, leg_id, this](const data_type::TradeData& data)
+                        {
+                            _oms->handle_spread_trade(_spreads->spread_id(spread_order_id), leg_id, data);
+                            _spreads->handle_trade(spread_order_id, leg_id, data);
+                        },
+                        [spread_order_id, leg_id, this](const data_type::CancelData& data) {_spreads->handle_cancel(spread_order_id, leg_id, data);},
+                        [spread_order_id, leg_id, this](const data_type::OrderError& data)
+                        {
+                            _spreads->handle_error(spread_order_id, leg_id, data);
+                            _strategies[_spreads->strategy_id(spread_order_id)]->on_error(data);
+                        },
+                    },
+                    false
+                );
+            },
+            [this](data_type::OrderRef order_ref) {return cancel_order(order_ref, false);},
+            [this](uint32_t strategy_id, const data_type::SpreadTick& tick) {_strategies[strategy_id]->on_spread_tick(tick);},
+            [this](uint32_t strategy_id, const data_type::SpreadOrderData& data) {_strategies[strategy_id]->on_spread_order(data);}
+        );
         _event_loop->register_handler(
             event::EventType::EVENT_MD_DISCONNECTED,
             [this] (const std::any& event_data)
             {
                 RK_LOG_WARN("gateway market front disconnected, reconnecting...");
-                _db_writer.insert_async(
-                    db::table::logs::table_name,nullptr,
+                _db_writer.insert_async<db::table::logs>({
                     _market_info->_trading_day,
                     _config.account_config.account_name,
-                    nullptr, nullptr, nullptr, nullptr, nullptr,
+                    {}, std::nullopt,
                     magic_enum::enum_name(event::EventType::EVENT_MD_DISCONNECTED),
                     "",
                     "WARNING",
-                    util::DateTime::now().strftime(), util::DateTime::now().strftime()
-                );
+                    util::DateTime::now(), util::DateTime::now()
+                });
                 _md_adapter->logout();
                 if (!_md_adapter->login() || !init_market_info())
                 {
@@ -75,23 +114,24 @@ namespace rk
             [this] (const std::any& event_data)
             {
                 RK_LOG_WARN("gateway trade front disconnected, reconnecting...");
-                _db_writer.insert_async(
-                    db::table::logs::table_name,nullptr,
+                _db_writer.insert_async<db::table::logs>({
                     _market_info->_trading_day,
                     _config.account_config.account_name,
-                    nullptr, nullptr, nullptr, nullptr, nullptr,
+                    {}, std::nullopt,
                     magic_enum::enum_name(event::EventType::EVENT_TD_DISCONNECTED),
                     "",
                     "WARNING",
-                    util::DateTime::now().strftime(), util::DateTime::now().strftime()
-                );
-                if (!_td_adapter->login() || !init_trade_info())
+                    util::DateTime::now(), util::DateTime::now()
+                });
+                if (!_td_adapter->login())
                 {
                     RK_LOG_WARN("gateway trade front reconnect failed!");
                     _event_loop->push_event(event::EventType::EVENT_TD_DISCONNECTED, std::any());
                     return;
                 }
-                RK_LOG_WARN("gateway trade front reconnected");
+                // 本地交易数据仍有效, 断线期间的回报由对账补齐, 不重新回放日志
+                RK_LOG_WARN("gateway trade front reconnected, reconciling...");
+                reconcile_trade_info();
             }
         );
         _event_loop->register_handler(
@@ -102,6 +142,10 @@ namespace rk
                 if (!_risk_control->check_handle_tick(data)) return;
                 _oms->handle_tick(data);
                 _context->handle_tick(data);
+                // 算法按合约下标直接分发
+                if (auto* algo = tick_algo(data)) algo->on_tick(data);
+                // 价差在行情处理中直接计算和下单
+                _spreads->handle_tick(data);
             }
         );
         _event_loop->register_handler(
@@ -110,7 +154,7 @@ namespace rk
             {
                 const auto& data = std::any_cast<const data_type::TradeData&>(event_data);
                 if (!_risk_control->check_handle_trade(data)) return;
-                _oms->handle_trade(data);
+                if (!_oms->handle_trade(data)) return;
                 _context->handle_trade(data);
             }
         );
@@ -120,7 +164,7 @@ namespace rk
             {
                 const auto& data = std::any_cast<const data_type::CancelData&>(event_data);
                 if (!_risk_control->check_handle_cancel(data)) return;
-                _oms->handle_cancel(data);
+                if (!_oms->handle_cancel(data)) return;
                 _context->handle_cancel(data);
             }
         );
@@ -130,7 +174,7 @@ namespace rk
             {
                 const auto& data = std::any_cast<const data_type::OrderError&>(event_data);
                 if (!_risk_control->check_handle_error(data)) return;
-                _oms->handle_error(data);
+                if (!_oms->handle_error(data)) return;
                 _context->handle_error(data);
             }
         );
@@ -138,11 +182,36 @@ namespace rk
             event::EventType::EVENT_ALGO_REQ,
             [this] (const std::any& event_data)
             {
-                const auto& data = std::any_cast<const data_type::AlgoReq&>(event_data);
-                auto& [_, algo] = _algos[data.symbol];
-                algo->on_algo_req(data);
+                handle_algo_req(std::any_cast<const std::vector<data_type::AlgoReq>&>(event_data));
+            }
+        );
+        _event_loop->register_handler(
+            event::EventType::EVENT_RECONCILE,
+            [this] (const std::any& event_data)
+            {
+                const auto& [session_id, counter_info] = std::any_cast<const std::pair<uint32_t, std::shared_ptr<TradeInfo>>&>(event_data);
+                // 上一交易时段查询的结果留在队列中, 丢弃
+                if (session_id != _session_id)
+                {
+                    RK_LOG_WARN("reconcile result of session {} dropped, current session {}", session_id, _session_id);
+                    return;
+                }
+                _td_adapter->restore_order_refs();
+                if (_oms->reconcile(*counter_info))
+                {
+                    _reconcile_retry_num = 0;
+                }
+                else if (_reconcile_retry_num++ < max_reconcile_retry_num)
+                {
+                    reconcile_trade_info();
+                }
+                else
+                {
+                    RK_LOG_WARN("reconcile retry num {} exhausted, keep local trade info", max_reconcile_retry_num);
+                    _reconcile_retry_num = 0;
+                }
+                _risk_indicators = _risk_control->set_trade_info(_trade_info);
             }
-
         );
     }
     EngineImpl::EngineImpl(std::string_view config_file_path)
@@ -187,6 +256,7 @@ namespace rk
     bool EngineImpl::start_trading()
     {
         if (_is_trading) return false;
+        ++_session_id;
         RK_LOG_INFO("user {} login trade...", _config.td_adapter_config.user_id.c_str());
         if (!_td_adapter->login())
         {
@@ -211,6 +281,7 @@ namespace rk
             RK_LOG_ERROR("init trade info failed, start trading failed!");
             return false;
         }
+        load_volume_profiles();
         RK_LOG_INFO("trading_day {} start trading...", _market_info->_trading_day);
         _is_trading = true;
         return true;
@@ -219,64 +290,334 @@ namespace rk
     {
         RK_LOG_INFO("stop trading...");
         if (!_is_trading) return;
-        _is_trading = false;
+        // 最终快照在引擎线程生成, 引擎线程停止处理事件后才释放交易数据
+        if (std::this_thread::get_id() == _busy_worker->get_id())
+        {
+            stop_algos();
+            save_snapshot();
+            _is_trading = false;
+        }
+        else
+        {
+            std::promise<void> stopped;
+            auto future = stopped.get_future();
+            _stop_request.store(&stopped);
+            future.wait();
+        }
         _td_adapter->logout();
         _md_adapter->logout();
-        // TODO 落库
+        _reconcile_worker = nullptr;
+        for (const auto& [table_name, stats] : _db_writer.batch_stats())
+        {
+            RK_LOG_INFO(
+                "db table {} rows {} failed {} batches {} max batch {} flush time {}us",
+                table_name, stats.row_num, stats.failed_row_num, stats.batch_num, stats.max_batch_size, stats.flush_time.count()
+            );
+        }
         _market_info = nullptr;
         _trade_info = nullptr;
 
     }
     std::optional<data_type::OrderRef> EngineImpl::order_insert(uint32_t strategy_id, const data_type::OrderReq& req)
     {
-        if (_risk_control->check_order_insert(req))
+        return send_order(
+            req,
+            TradeHandler{
+                [strategy_id, this](const data_type::TradeData& data) {_strategies[strategy_id]->on_trade(data);},
+                [strategy_id, this](const data_type::CancelData& data) {_strategies[strategy_id]->on_cancel(data);},
+                [strategy_id, this](const data_type::OrderError& data) {_strategies[strategy_id]->on_error(data);},
+            }
+        );
+    }
+    bool EngineImpl::order_cancel(uint32_t strategy_id, data_type::OrderRef order_ref)
+    {
+        return cancel_order(order_ref);
+    }
+    std::optional<data_type::OrderRef> EngineImpl::send_order(const data_type::OrderReq& req, TradeHandler handler, bool verbose)
+    {
+        if (!_risk_control->check_order_insert(req)) return std::nullopt;
+        const auto order_ref = _oms->order_insert(req, verbose);
+        if (!order_ref) return std::nullopt;
+        _context->order_insert(std::move(handler), *order_ref);
+        _td_adapter->order_insert(*order_ref, req);
+        return order_ref;
+    }
+    bool EngineImpl::cancel_order(data_type::OrderRef order_ref, bool verbose)
+    {
+        if (!_risk_control->check_order_cancel(order_ref)) return false;
+        _oms->order_cancel(order_ref, verbose);
+        _td_adapter->order_cancel(order_ref);
+        return true;
+    }
+    std::optional<data_type::BasketId> EngineImpl::basket_insert(uint32_t strategy_id, data_type::BasketReq req)
+    {
+        if (!_is_trading)
         {
-            auto order_ref = _oms->order_insert(req);
-            _context->order_insert(
+            RK_LOG_WARN("trading stopped! basket {} insert failed", req.basket_name.c_str());
+            return std::nullopt;
+        }
+        auto basket_id = _baskets->insert(strategy_id, std::move(req), *_market_info, _subscribed_symbols);
+        if (!basket_id) return std::nullopt;
+        // 流控额度内的子单立即报出, 其余由引擎线程继续报
+        send_basket_tasks();
+        return basket_id;
+    }
+    bool EngineImpl::basket_cancel(uint32_t strategy_id, data_type::BasketId basket_id)
+    {
+        if (!_baskets->cancel(strategy_id, basket_id)) return false;
+        send_basket_tasks();
+        return true;
+    }
+    std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> EngineImpl::query_etf_detail()
+    {
+        return _md_adapter->query_etf_detail();
+    }
+    void EngineImpl::send_basket_tasks()
+    {
+        for (auto quota = _risk_control->order_quota(); quota > 0; --quota)
+        {
+            const auto task = _baskets->next_task();
+            if (!task) break;
+            const auto [basket_id, leg_id, type] = *task;
+            if (type == BasketManager::TaskType::CANCEL)
+            {
+                // 风控拒绝撤单时任务留在队首, 等下次额度重试
+                if (!cancel_order(_baskets->leg_order_ref(basket_id, leg_id), false) && _baskets->on_cancel_refused(*task)) break;
+                continue;
+            }
+            const auto order_ref = send_order(
+                _baskets->leg_req(basket_id, leg_id),
                 TradeHandler{
-                    [strategy_id, this](const data_type::TradeData& data) {_strategies[strategy_id]->on_trade(data);},
-                    [strategy_id, this](const data_type::CancelData& data) {_strategies[strategy_id]->on_cancel(data);},
-                    [strategy_id, this](const data_type::OrderError& data) {_strategies[strategy_id]->on_error(data);},
+                    [basket_id, leg_id, this](const data_type::TradeData& data) {_baskets->handle_trade(basket_id, leg_id, data);},
+                    [basket_id, leg_id, this](const data_type::CancelData& data) {_baskets->handle_cancel(basket_id, leg_id, data);},
+                    [basket_id, leg_id, this](const data_type::OrderError& data)
+                    {
+                        _baskets->handle_error(basket_id, leg_id, data);
+                        _strategies[_baskets->strategy_id(basket_id)]->on_error(data);
+                    },
                 },
-                order_ref
+                false
             );
-            _td_adapter->order_insert(order_ref, req);
-            return order_ref;
+            _baskets->on_sent(basket_id, leg_id, order_ref);
         }
-        return std::nullopt;
     }
-    bool EngineImpl::order_cancel(uint32_t strategy_id, data_type::OrderRef order_ref)
+    std::optional<data_type::SpreadId> EngineImpl::add_spread(uint32_t strategy_id, const data_type::SpreadDetail& detail)
     {
-        if (_risk_control->check_order_cancel(order_ref))
+        if (!_is_trading)
         {
-            _oms->order_cancel(order_ref);
-            _td_adapter->order_cancel(order_ref);
-            return true;
+            RK_LOG_WARN("trading stopped! spread {} add failed", detail.spread_name.c_str());
+            return std::nullopt;
         }
-        return false;
+        const auto spread_id = _spreads->add_spread(strategy_id, detail, *_market_info, _subscribed_symbols);
+        if (spread_id) _oms->add_spread_position(*spread_id, detail);
+        return spread_id;
+    }
+    std::optional<uint32_t> EngineImpl::spread_order_insert(uint32_t strategy_id, const data_type::SpreadOrderReq& req)
+    {
+        if (!_is_trading) return std::nullopt;
+        return _spreads->insert(strategy_id, req);
+    }
+    bool EngineImpl::spread_order_cancel(uint32_t strategy_id, uint32_t spread_order_id)
+    {
+        return _spreads->cancel(strategy_id, spread_order_id);
+    }
+    const data_type::SpreadTick* EngineImpl::spread_tick(data_type::SpreadId spread_id) const
+    {
+        return _spreads->spread_tick(spread_id);
+    }
+    uint32_t EngineImpl::add_timer(uint32_t strategy_id)
+    {
+        _timer_owners.push_back(strategy_id);
+        return _timers.add_timer();
+    }
+    void EngineImpl::schedule_timer(uint32_t timer_id, const util::DateTime& deadline)
+    {
+        _timers.schedule(timer_id, deadline);
+    }
+    void EngineImpl::cancel_timer(uint32_t timer_id)
+    {
+        _timers.cancel(timer_id);
     }
     void EngineImpl::algo_insert(const data_type::AlgoReq& req)
+    {
+        algo_insert(std::vector<data_type::AlgoReq>{req});
+    }
+    void EngineImpl::algo_insert(std::vector<data_type::AlgoReq> reqs)
     {
         // TODO 本地风控
-        if (
-            _algos.find(req.symbol) == _algos.end() ||
-            std::get<std::string>(_algos[req.symbol]) != req.algo_name
-        )
+        if (reqs.empty()) return;
+        _event_loop->push_event(event::EventType::EVENT_ALGO_REQ, std::move(reqs));
+    }
+    void EngineImpl::handle_algo_req(const std::vector<data_type::AlgoReq>& reqs)
+    {
+        if (_market_info == nullptr)
+        {
+            RK_LOG_WARN("market info not ready, algo req num {} dropped", reqs.size());
+            return;
+        }
+        // 先订阅新合约, 算法初始化时以订阅集合判断能否收到行情
+        std::unordered_set<data_type::Symbol> unsubscribed_symbols;
+        for (const auto& req : reqs)
         {
-            auto algo = algo::create_algo(*this, req.symbol, req.algo_name.to_string(), req.algo_param_json.to_string());
-            if (algo == nullptr)
+            if (!_subscribed_symbols.contains(req.symbol) && _market_info->_symbol_details.contains(req.symbol)) unsubscribed_symbols.insert(req.symbol);
+        }
+        const auto subscribe_num = unsubscribed_symbols.size();
+        if (!unsubscribed_symbols.empty())
+        {
+            if (_md_adapter->subscribe(unsubscribed_symbols)) _subscribed_symbols.merge(unsubscribed_symbols);
+            else RK_LOG_ERROR("algo subscribe failed, symbol num {}", unsubscribed_symbols.size());
+        }
+        for (const auto& req : reqs)
+        {
+            const auto algo_type = magic_enum::enum_cast<algo::AlgoType>(req.algo_name.view());
+            if (!algo_type || *algo_type == algo::AlgoType::UNKNOWN || !_market_info->_symbol_details.contains(req.symbol))
             {
-                RK_LOG_WARN("{}", std::format("create algo return nullptr, {}", data_type::to_json(req).dump(4)).c_str());
-                return;
+                RK_LOG_WARN("{}", std::format("algo req illegal, {}", data_type::to_json(req).dump()).c_str());
+                continue;
             }
-            auto strategy_id = register_strategy(algo);
-            algo->set_strategy_id(strategy_id);
-            _algos[req.symbol] = {req.algo_name.to_string(), algo};
+            auto [id_it, inserted] = _algo_symbol_ids.try_emplace(req.symbol, static_cast<uint32_t>(_algo_table.size()));
+            if (inserted) _algo_table.push_back(nullptr);
+            auto*& algo = _algo_table[id_it->second];
+            // 同一合约只运行一个算法, 运行中的算法只接受同类型的新目标
+            if (algo && algo->algo_type() != *algo_type)
+            {
+                RK_LOG_WARN("{}", std::format("algo {} running, {}", magic_enum::enum_name(algo->algo_type()), data_type::to_json(req).dump()).c_str());
+                continue;
+            }
+            if (!algo)
+            {
+                algo = _algo_pool->acquire(*algo_type, req.symbol, req.algo_param_json.to_string());
+                if (algo == nullptr)
+                {
+                    RK_LOG_WARN("{}", std::format("acquire algo return nullptr, {}", data_type::to_json(req).dump()).c_str());
+                    continue;
+                }
+            }
+            // 未订阅或出错时在回调内归还, 分发表随之清空
+            algo->on_algo_req(req);
+        }
+        RK_LOG_INFO(
+            "algo req num {} handled, algo created num {} free num {}, subscribe symbol num {}",
+            reqs.size(), _algo_pool->created_num(), _algo_pool->free_num(), subscribe_num
+        );
+    }
+    algo::Algo* EngineImpl::tick_algo(const data_type::TickData& data)
+    {
+        if (data.symbol_id < _tick_algo_ids.size())
+        {
+            const auto& [symbol, algo_id] = _tick_algo_ids[data.symbol_id];
+            if (symbol == data.symbol) return _algo_table[algo_id];
+        }
+        // 首次收到该合约行情时预留分发表下标, 之后启动的算法直接填入
+        const auto [id_it, inserted] = _algo_symbol_ids.try_emplace(data.symbol, static_cast<uint32_t>(_algo_table.size()));
+        if (inserted) _algo_table.push_back(nullptr);
+        if (data.symbol_id < max_tick_symbol_id)
+        {
+            if (data.symbol_id >= _tick_algo_ids.size()) _tick_algo_ids.resize(data.symbol_id + 1);
+            _tick_algo_ids[data.symbol_id] = {data.symbol, id_it->second};
+        }
+        return _algo_table[id_it->second];
+    }
+    void EngineImpl::stop_algos()
+    {
+        size_t algo_num = 0;
+        for (auto* algo : _algo_table)
+        {
+            if (algo == nullptr) continue;
+            algo->on_session_end();
+            ++algo_num;
+        }
+        // 归还后分发表不再保留指向本会话行情和持仓的算法
+        std::ranges::fill(_algo_table, nullptr);
+        if (algo_num > 0) RK_LOG_INFO("session end, algo stopped num {} free num {}", algo_num, _algo_pool->free_num());
+    }
+    void EngineImpl::load_volume_profiles()
+    {
+        // 在调用start_trading的线程整目录读取, 引擎线程只按合约查找
+        const auto& path = _config.algo_config.volume_profile_path;
+        std::error_code error_code;
+        if (path.empty() || !std::filesystem::is_directory(path, error_code)) return;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<const algo::VolumeProfile>> volume_profiles;
+        for (const auto& entry : std::filesystem::directory_iterator(path, error_code))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".csv") continue;
+            auto profile = algo::VolumeProfile::load(entry.path());
+            if (!profile) continue;
+            data_type::Symbol symbol;
+            symbol.symbol.assign(entry.path().stem().string());
+            volume_profiles.emplace(symbol, std::make_shared<const algo::VolumeProfile>(*profile));
         }
-        _event_loop->push_event(event::EventType::EVENT_ALGO_REQ, req);
+        RK_LOG_INFO("volume profile loaded, symbol num {}", volume_profiles.size());
+        _volume_profiles = std::move(volume_profiles);
+    }
+    std::shared_ptr<const algo::VolumeProfile> EngineImpl::volume_profile(const data_type::Symbol& symbol) const
+    {
+        const auto it = _volume_profiles.find(symbol);
+        return it == _volume_profiles.end() ? nullptr : it->second;
+    }
+    void EngineImpl::release_algo(algo::Algo& algo)
+    {
+        if (const auto it = _algo_symbol_ids.find(algo.symbol()); it != _algo_symbol_ids.end() && _algo_table[it->second] == &algo)
+        {
+            _algo_table[it->second] = nullptr;
+        }
+        _algo_pool->release(algo);
     }
 
     bool EngineImpl::init_trade_info()
+    {
+        // 优先从本地预写日志恢复, 柜台查询转为异步对账
+        if (auto trade_info = _oms->restore_trade_info())
+        {
+            _risk_indicators = _risk_control->set_trade_info(trade_info);
+            _trade_info = trade_info;
+            reconcile_trade_info();
+            return true;
+        }
+        auto trade_info = query_trade_info();
+        if (!trade_info) return false;
+        _td_adapter->restore_order_refs();
+        _risk_indicators = _risk_control->set_trade_info(trade_info);
+        _oms->set_trade_info(trade_info);
+        _oms->write_checkpoint();
+        _trade_info = trade_info;
+        return true;
+    }
+    void EngineImpl::reconcile_trade_info()
+    {
+        // 常驻对账线程, 引擎线程只投递请求, 不等待上一次查询结束
+        {
+            auto lock = std::lock_guard(_reconcile_mutex);
+            _reconcile_requested = true;
+            _reconcile_session_id = _session_id;
+        }
+        if (!_reconcile_worker)
+        {
+            _reconcile_worker = std::make_unique<std::jthread>([this](const std::stop_token& stop_token)
+            {
+                while (true)
+                {
+                    uint32_t session_id = 0;
+                    {
+                        auto lock = std::unique_lock(_reconcile_mutex);
+                        if (!_reconcile_condition_variable.wait(lock, stop_token, [this]() { return _reconcile_requested; })) return;
+                        _reconcile_requested = false;
+                        session_id = _reconcile_session_id;
+                    }
+                    auto counter_info = query_trade_info(stop_token);
+                    if (stop_token.stop_requested()) return;
+                    if (!counter_info)
+                    {
+                        RK_LOG_WARN("query counter trade info failed, reconcile skipped");
+                        continue;
+                    }
+                    _event_loop->push_event(event::EventType::EVENT_RECONCILE, std::pair{session_id, std::move(counter_info)});
+                }
+            });
+        }
+        _reconcile_condition_variable.notify_one();
+    }
+    std::shared_ptr<TradeInfo> EngineImpl::query_trade_info(const std::stop_token& stop_token)
     {
         RK_LOG_INFO("query position...");
         std::this_thread::sleep_for(std::chrono::seconds(1)); // 避免柜台查询流控
@@ -284,9 +625,9 @@ namespace rk
         if (!position_data_opt)
         {
             RK_LOG_ERROR("query position data failed!");
-            return false;
+            return nullptr;
         }
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::PositionData>> position_data{};
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::PositionData>> position_data(_market_info->_symbol_details.size());
         for (auto& [key, val] : position_data_opt.value())
         {
             auto it = _market_info->_symbol_details.find(key);
@@ -303,39 +644,45 @@ namespace rk
             }
         }
         RK_LOG_INFO("query position success! symbol num: {}", position_data.size());
+        if (stop_token.stop_requested()) return nullptr;
         RK_LOG_INFO("query order...");
         auto order_data_opt = _td_adapter->query_order_data();
         if (!order_data_opt)
         {
             RK_LOG_ERROR("query order data failed!");
-            return false;
+            return nullptr;
         }
-        std::vector<data_type::OrderData> order_data{};
+        util::PagedVector<data_type::OrderData> order_data(_config.account_config.order_capacity);
         for (auto& val : order_data_opt.value())
         {
+            // 按OrderRef索引, 未知合约也保留占位
             auto it = _market_info->_symbol_details.find(val.order_req.symbol);
-            if (it == _market_info->_symbol_details.end()) continue;
-            auto& symbol = _market_info->_symbol_details.find(val.order_req.symbol)->first;
-            val.order_req.symbol = symbol;
+            if (it != _market_info->_symbol_details.end()) val.order_req.symbol = it->first;
             order_data.emplace_back(std::move(val));
         }
         std::this_thread::sleep_for(std::chrono::seconds(1)); // 避免柜台查询流控
         RK_LOG_INFO("query order success! order num: {}", order_data.size());
+        if (stop_token.stop_requested()) return nullptr;
         RK_LOG_INFO("query trade...");
         auto trade_data_opt = _td_adapter->query_trade_data();
         if (!trade_data_opt)
         {
             RK_LOG_ERROR("query trade data failed!");
-            return false;
+            return nullptr;
         }
-        auto trade_data = trade_data_opt.value();
-        RK_LOG_INFO("query trade success! trade num: {}", std::accumulate(trade_data.begin(), trade_data.end(), 0, [](size_t sum, const auto& row) { return sum + row.size(); }));
+        util::PagedListPool<data_type::TradeData> trade_data(_config.account_config.order_capacity, _config.account_config.trade_capacity);
+        for (data_type::OrderRef order_ref = 0; order_ref < trade_data_opt.value().size(); ++order_ref)
+        {
+            for (auto& trade : trade_data_opt.value()[order_ref]) trade_data.push_back(order_ref, std::move(trade));
+        }
+        RK_LOG_INFO("query trade success! trade num: {}", trade_data.value_size());
+        if (stop_token.stop_requested()) return nullptr;
         RK_LOG_INFO("query account...");
         auto account_data_opt = _td_adapter->query_account_data();
         if (!account_data_opt)
         {
             RK_LOG_ERROR("query account data failed!");
-            return false;
+            return nullptr;
         }
         auto account_data = account_data_opt.value();
         RK_LOG_INFO("query account success! account data:\n{}", data_type::to_json(account_data).dump(4).c_str());
@@ -346,10 +693,76 @@ namespace rk
             std::move(trade_data),
             std::move(account_data)
         );
-        _risk_indicators = _risk_control->set_trade_info(trade_info);
-        _oms->set_trade_info(trade_info);
-        _trade_info = trade_info;
-        return true;
+        return trade_info;
+    }
+    void EngineImpl::save_snapshot()
+    {
+        _last_snapshot_time = std::chrono::steady_clock::now();
+        if (!_trade_info || !_market_info) return;
+        // 只拷贝上次快照后变化的委托, 交给写入线程, 引擎线程不等待落库
+        const auto full = _oms->take_snapshot_delta(_snapshot_order_refs) || _snapshot_dropped;
+        const auto trading_day = _market_info->_trading_day;
+        const util::FixedString<32> account_name = _config.account_config.account_name;
+        const auto now = util::DateTime::now();
+        auto snapshot = std::make_shared<db::Snapshot>();
+        snapshot->trading_day = trading_day;
+        snapshot->account_name = account_name;
+        snapshot->full = full;
+        const auto add_order = [&](data_type::OrderRef order_ref)
+        {
+            const auto& order = _trade_info->_order_data[order_ref];
+            snapshot->orders.push_back({trading_day, account_name, order, now});
+            if (order_ref >= _trade_info->_trade_data.size()) return;
+            for (const auto& trade : _trade_info->_trade_data[order_ref])
+            {
+                snapshot->trades.push_back({trading_day, account_name, order.order_req, trade, now});
+            }
+        };
+        if (full)
+        {
+            snapshot->orders.reserve(_trade_info->_order_data.size());
+            snapshot->trades.reserve(_trade_info->_trade_data.value_size());
+            for (data_type::OrderRef order_ref = 0; order_ref < _trade_info->_order_data.size(); ++order_ref) add_order(order_ref);
+            for (const auto& [symbol, position] : _trade_info->_position_data)
+            {
+                if (position && !position->empty()) snapshot->positions.push_back({trading_day, account_name, *position, now});
+            }
+        }
+        else
+        {
+            snapshot->order_refs = _snapshot_order_refs;
+            snapshot->orders.reserve(_snapshot_order_refs.size());
+            for (const auto order_ref : _snapshot_order_refs)
+            {
+                add_order(order_ref);
+                const auto& symbol = _trade_info->_order_data[order_ref].order_req.symbol;
+                if (std::find(snapshot->symbols.begin(), snapshot->symbols.end(), symbol) != snapshot->symbols.end()) continue;
+                snapshot->symbols.push_back(symbol);
+                const auto it = _trade_info->_position_data.find(symbol);
+                if (it != _trade_info->_position_data.end() && it->second && !it->second->empty())
+                {
+                    snapshot->positions.push_back({trading_day, account_name, *it->second, now});
+                }
+            }
+        }
+        snapshot->risk_indicators = {
+            trading_day,
+            account_name,
+            _risk_indicators->daily_order_num,
+            _risk_indicators->daily_cancel_num,
+            _risk_indicators->daily_repeat_order_num,
+            now
+        };
+        RK_LOG_INFO(
+            "save {} snapshot, order num {}, trade num {}, position num {}",
+            full ? "full" : "incremental", snapshot->orders.size(), snapshot->trades.size(), snapshot->positions.size()
+        );
+        // 丢弃的增量无法补写, 下次改为全量
+        _snapshot_dropped = !_db_writer.insert_snapshot_async(std::move(snapshot));
+        if (_snapshot_dropped)
+        {
+            RK_LOG_WARN("snapshot queue full, snapshot dropped");
+        }
     }
     bool EngineImpl::init_market_info()
     {
@@ -368,7 +781,15 @@ namespace rk
                 return false;
             }
             RK_LOG_INFO("query symbol success, symbol num {}", symbol_detail.value().size());
-            market_info->_symbol_details = std::move(symbol_detail.value());
+            if (!_md_adapter->start_l2())
+            {
+                RK_LOG_ERROR("start level2 market data failed!");
+                return false;
+            }
+            market_info->_symbol_details.insert(
+                std::make_move_iterator(symbol_detail.value().begin()),
+                std::make_move_iterator(symbol_detail.value().end())
+            );
             _oms->set_market_info(market_info);
             _risk_control->set_market_info(market_info);
             _market_info = market_info;
@@ -442,6 +863,24 @@ namespace rk
             if (_is_trading)
             {
                 _event_loop->handle_event();
+                if (_baskets->has_task()) send_basket_tasks();
+                if (!_timers.empty())
+                {
+                    _timers.expire(util::DateTime::now(), [this](uint32_t timer_id) {_strategies[_timer_owners[timer_id]]->on_timer(timer_id);});
+                }
+                // 定期快照在引擎线程生成, 与事件处理无竞争
+                const auto interval = std::chrono::seconds(_config.db_config.snapshot_interval_s);
+                if (interval.count() > 0 && std::chrono::steady_clock::now() - _last_snapshot_time >= interval)
+                {
+                    save_snapshot();
+                }
+                if (auto* stop_request = _stop_request.exchange(nullptr))
+                {
+                    stop_algos();
+                    save_snapshot();
+                    _is_trading = false;
+                    stop_request->set_value();
+                }
             }
             auto use_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - begin);
             auto duration = std::chrono::microseconds(100); // TODO 通过配置
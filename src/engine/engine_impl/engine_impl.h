@@ -1,4 +1,8 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <unordered_set>
@@ -8,28 +12,49 @@
 #include "event.h"
 #include "interface.h"
 #include "util/db.h"
+#include "util/flat_map.h"
+#include "util/paged_vector.h"
+#include "util/timer_queue.h"
+#include "basket.h"
 #include "oms.h"
 #include "risk_control.h"
+#include "spread.h"
 #include "trading_context.h"
 
 
 namespace rk
 {
     namespace adapter {class MDAdapter; class TDAdapter;}
-    namespace algo {class Algo;}
+    namespace algo {class Algo; class AlgoPool; class VolumeProfile;}
     struct TradeInfo
     {
         std::string _account_name;
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::PositionData>> _position_data;
-        std::vector<data_type::OrderData> _order_data;
-        std::vector<std::vector<data_type::TradeData>> _trade_data;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::PositionData>> _position_data;
+        util::PagedVector<data_type::OrderData> _order_data;         // 按OrderRef索引, 地址稳定
+        util::PagedListPool<data_type::TradeData> _trade_data;       // 成交平铺存储, 按OrderRef串联
         data_type::AccountData _account_data;
+        std::vector<std::shared_ptr<data_type::SpreadPositionData>> _spread_position_data;     // 按SpreadId索引
     };
     struct MarketInfo
     {
-        uint32_t _trading_day = std::stoul(util::DateTime::now().strftime("%Y%m%d"));
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_details;
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::TickData>> _last_tick_data;
+        uint32_t _trading_day = util::DateTime::now().date();
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_details;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::TickData>> _last_tick_data;
+        // 报单所需资金(保证金/市值+手续费), 市价单按最新价计算; 风控检查和OMS冻结共用
+        [[nodiscard]] double required_funds(const data_type::OrderReq& req, uint32_t volume) const
+        {
+            const auto detail_it = _symbol_details.find(req.symbol);
+            if (detail_it == _symbol_details.end() || !detail_it->second) return 0.;
+            const auto& detail = *detail_it->second;
+            auto price = req.limit_price;
+            if (price <= 0.)
+            {
+                const auto tick_it = _last_tick_data.find(req.symbol);
+                if (tick_it != _last_tick_data.end() && tick_it->second) price = tick_it->second->last_price;
+            }
+            const auto amount = price * volume * detail.multiplier;
+            return detail.margin(req.direction, amount) + detail.commission(req.offset, amount, volume);
+        }
     };
     struct RiskIndicators
     {
@@ -48,10 +73,32 @@ namespace rk
         void register_strategy(uint32_t strategy_id, std::shared_ptr<interface::Strategy> strategy);
         bool start_trading();
         void stop_trading();
+        [[nodiscard]] bool is_trading() const {return _is_trading;}
         // trade TODO 接口线程安全
         std::optional<data_type::OrderRef> order_insert(uint32_t strategy_id, const data_type::OrderReq& req);
         bool order_cancel(uint32_t strategy_id, data_type::OrderRef order_ref);
         void algo_insert(const data_type::AlgoReq& req);
+        // 批量下达算法目标, 整批作为一个事件在引擎线程创建算法并统一订阅行情
+        void algo_insert(std::vector<data_type::AlgoReq> reqs);
+        // 组合下单, 子单按流控分批报出, 进度通过Strategy::on_basket推送
+        std::optional<data_type::BasketId> basket_insert(uint32_t strategy_id, data_type::BasketReq req);
+        bool basket_cancel(uint32_t strategy_id, data_type::BasketId basket_id);
+        std::optional<std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>>> query_etf_detail();
+        // 价差组合, 合成盘口通过Strategy::on_spread_tick推送, 订单进度通过Strategy::on_spread_order推送
+        std::optional<data_type::SpreadId> add_spread(uint32_t strategy_id, const data_type::SpreadDetail& detail);
+        std::optional<uint32_t> spread_order_insert(uint32_t strategy_id, const data_type::SpreadOrderReq& req);
+        bool spread_order_cancel(uint32_t strategy_id, uint32_t spread_order_id);
+        [[nodiscard]] const data_type::SpreadTick* spread_tick(data_type::SpreadId spread_id) const;
+        // 定时器, 到期回调Strategy::on_timer; 重新定时覆盖上一次未到期的定时
+        uint32_t add_timer(uint32_t strategy_id);
+        void schedule_timer(uint32_t timer_id, const util::DateTime& deadline);
+        void cancel_timer(uint32_t timer_id);
+        // 算法停止后归还实例池并移出行情分发表
+        void release_algo(algo::Algo& algo);
+        // 合约是否已向行情接口订阅, 只在引擎线程调用
+        [[nodiscard]] bool is_subscribed(const data_type::Symbol& symbol) const {return _subscribed_symbols.contains(symbol);}
+        // 会话开始时预加载的成交量分布, 未加载返回nullptr
+        [[nodiscard]] std::shared_ptr<const algo::VolumeProfile> volume_profile(const data_type::Symbol& symbol) const;
 
         config_type::EngineConfig _config;
         std::shared_ptr<const TradeInfo> _trade_info;
@@ -59,10 +106,25 @@ namespace rk
     private:
         void working_loop(const std::stop_token& stop_token);
         bool init_trade_info();
+        // 柜台查询, 各步之间检查stop_token, 停止时返回nullptr
+        std::shared_ptr<TradeInfo> query_trade_info(const std::stop_token& stop_token = {});
+        void reconcile_trade_info();
+        void save_snapshot();
         bool init_market_info();
         std::unordered_set<data_type::Symbol> init_strategy(uint32_t strategy_id);
+        // 风控检查后报单/撤单, verbose为false不逐笔打印日志
+        std::optional<data_type::OrderRef> send_order(const data_type::OrderReq& req, TradeHandler handler, bool verbose = true);
+        bool cancel_order(data_type::OrderRef order_ref, bool verbose = true);
+        void send_basket_tasks();
+        void handle_algo_req(const std::vector<data_type::AlgoReq>& reqs);
+        void load_volume_profiles();
+        // 按行情携带的合约序号取运行中的算法, 每个合约只查一次合约表
+        algo::Algo* tick_algo(const data_type::TickData& data);
+        // 会话结束停止运行中的算法并归还实例池, 只在引擎线程调用
+        void stop_algos();
 
-        bool _is_trading;
+        std::atomic<bool> _is_trading;        // 启动在调用线程完成初始化后置位, 引擎线程置位前不处理事件
+        std::atomic<std::promise<void>*> _stop_request = nullptr;     // 其他线程停止交易, 由引擎线程完成后通知
         std::shared_ptr<event::EventLoop> _event_loop;
         pqxx::connection _db_reader;
         db::Executor _db_writer;
@@ -74,7 +136,27 @@ namespace rk
         std::unique_ptr<OMS> _oms;
         std::unique_ptr<RiskControl> _risk_control;
         std::unique_ptr<TradingContext> _context;
+        std::unique_ptr<BasketManager> _baskets;
+        std::unique_ptr<SpreadManager> _spreads;
         std::vector<std::shared_ptr<interface::Strategy>> _strategies;
-        std::unordered_map<data_type::Symbol, std::tuple<std::string, std::shared_ptr<algo::Algo>>> _algos;
+        util::TimerQueue _timers;
+        std::vector<uint32_t> _timer_owners;        // 按定时器号索引的策略号
+        util::FlatMap<data_type::Symbol, uint32_t> _algo_symbol_ids;     // 合约到算法分发表下标, 收到行情或算法请求时分配, 只增不删
+        std::vector<algo::Algo*> _algo_table;       // 按合约下标索引的运行中算法, 空闲为nullptr
+        std::vector<std::pair<data_type::Symbol, uint32_t>> _tick_algo_ids;     // 按行情合约序号缓存的分发表下标, 合约不一致时重新查找
+        static constexpr uint32_t max_tick_symbol_id = 1 << 20;
+        std::unique_ptr<algo::AlgoPool> _algo_pool;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<const algo::VolumeProfile>> _volume_profiles;     // 按合约代码索引
+        std::mutex _reconcile_mutex;
+        std::condition_variable_any _reconcile_condition_variable;
+        bool _reconcile_requested = false;
+        uint32_t _reconcile_session_id = 0;
+        std::unique_ptr<std::jthread> _reconcile_worker;      // 常驻对账线程, 停止交易时退出
+        static constexpr uint32_t max_reconcile_retry_num = 3;     // 柜台快照落后本地时的重新查询次数
+        uint32_t _reconcile_retry_num = 0;
+        uint32_t _session_id = 0;       // 每次开始交易递增, 对账结果按会话校验
+        std::chrono::steady_clock::time_point _last_snapshot_time = std::chrono::steady_clock::now();
+        std::vector<data_type::OrderRef> _snapshot_order_refs;     // 增量快照的委托, 复用容量
+        bool _snapshot_dropped = false;
     };
 };
\ No newline at end of file
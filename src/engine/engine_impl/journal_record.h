@@ -0,0 +1,83 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include "data_type.h"
+namespace rk
+{
+	/// OMS事件日志记录类型, 快照(资金/持仓/委托/成交)以CHECKPOINT_BEGIN/END包围, 其后为增量事件
+	/// 新增类型只能追加在UNKNOWN之前, 保证已落盘的日志可解码
+	enum class JournalType : uint32_t
+	{
+		CHECKPOINT_BEGIN,
+		ACCOUNT,
+		POSITION,
+		ORDER,
+		TRADE,
+		CHECKPOINT_END,
+		ORDER_INSERT,
+		TRADE_DATA,
+		CANCEL_DATA,
+		ORDER_ERROR,
+		ORDER_CANCEL,
+		UNKNOWN
+	};
+	/// 定长二进制记录, 载荷为可平凡复制的数据类型, 由rk_journal工具离线解码为json
+	struct JournalRecord
+	{
+		static constexpr uint64_t version = 3;		// 2: 增加写入时间 3: FixedString记录长度
+		JournalType									type = JournalType::UNKNOWN;
+		uint32_t									size = 0;
+		int64_t										timestamp = 0;		// 写入时间, 纳秒
+		std::array<std::byte, 240>					payload{};
+		template<typename T>
+		static JournalRecord make(JournalType type, const T& data)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(payload));
+			JournalRecord record{
+				type,
+				sizeof(T),
+				std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+			};
+			std::memcpy(record.payload.data(), &data, sizeof(T));
+			return record;
+		}
+		template<typename T>
+		[[nodiscard]] T get() const
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(payload));
+			T data;
+			std::memcpy(&data, payload.data(), sizeof(T));
+			return data;
+		}
+	};
+	static_assert(sizeof(JournalRecord) == 256);
+	/// 解码为json, 供离线工具使用
+	inline nlohmann::ordered_json to_json(const JournalRecord& record)
+	{
+		nlohmann::ordered_json j;
+		j["type"] = magic_enum::enum_name(record.type);
+		j["timestamp"] = util::DateTime(record.timestamp).strftime();
+		switch (record.type)
+		{
+			case JournalType::CHECKPOINT_BEGIN:
+			case JournalType::CHECKPOINT_END: j["trading_day"] = record.get<uint32_t>(); break;
+			case JournalType::ACCOUNT: j["data"] = data_type::to_json(record.get<data_type::AccountData>()); break;
+			case JournalType::POSITION: j["data"] = data_type::to_json(record.get<data_type::PositionData>()); break;
+			case JournalType::ORDER:
+			case JournalType::ORDER_INSERT: j["data"] = data_type::to_json(record.get<data_type::OrderData>()); break;
+			case JournalType::TRADE:
+			case JournalType::TRADE_DATA: j["data"] = data_type::to_json(record.get<data_type::TradeData>()); break;
+			case JournalType::CANCEL_DATA: j["data"] = data_type::to_json(record.get<data_type::CancelData>()); break;
+			case JournalType::ORDER_ERROR: j["data"] = data_type::to_json(record.get<data_type::OrderError>()); break;
+			case JournalType::ORDER_CANCEL: j["order_ref"] = record.get<data_type::OrderRef>(); break;
+			default: break;
+		}
+		return j;
+	}
+};
@@ -2,30 +2,125 @@
 // Created by root on 2025/9/29.
 //
 #include "oms.h"
+#include <array>
+#include <cstdlib>
+#include <filesystem>
 #include "engine_impl/engine_impl.h"
 #include "util/datetime.h"
 #include <magic_enum/magic_enum.hpp>
 #include "util/logger.h"
 namespace rk
 {
+    namespace
+    {
+        enum class PositionEvent
+        {
+            INSERT,
+            TRADE,
+            CANCEL,
+            ERROR
+        };
+        // 单位委托量对持仓字段的变动
+        struct PositionTransition
+        {
+            data_type::PositionInfo data_type::PositionData::* side = nullptr;
+            int8_t position = 0;
+            int8_t frozen = 0;
+            int8_t pending = 0;
+        };
+        constexpr size_t event_num = magic_enum::enum_count<PositionEvent>();
+        constexpr size_t direction_num = magic_enum::enum_count<data_type::Direction>();
+        constexpr size_t offset_num = magic_enum::enum_count<data_type::Offset>();
+        using PositionTransitionTable = std::array<std::array<std::array<PositionTransition, offset_num>, direction_num>, event_num>;
+        // (事件, 方向, 开平) -> 持仓变动, 开仓作用于同向持仓的pending, 平仓作用于反向持仓的frozen
+        constexpr PositionTransitionTable make_position_transition_table()
+        {
+            PositionTransitionTable table{};
+            for (auto direction : {data_type::Direction::LONG, data_type::Direction::SHORT})
+            {
+                for (auto offset : {data_type::Offset::OPEN, data_type::Offset::CLOSE, data_type::Offset::CLOSE_TD, data_type::Offset::CLOSE_YD})
+                {
+                    const bool is_open = offset == data_type::Offset::OPEN;
+                    const auto side = (direction == data_type::Direction::LONG) == is_open
+                        ? &data_type::PositionData::long_position
+                        : &data_type::PositionData::short_position;
+                    const auto d = static_cast<size_t>(direction);
+                    const auto o = static_cast<size_t>(offset);
+                    if (is_open)
+                    {
+                        table[static_cast<size_t>(PositionEvent::INSERT)][d][o] = {side, 0, 0, 1};
+                        table[static_cast<size_t>(PositionEvent::TRADE)][d][o] = {side, 1, 0, -1};
+                        table[static_cast<size_t>(PositionEvent::CANCEL)][d][o] = {side, 0, 0, -1};
+                        table[static_cast<size_t>(PositionEvent::ERROR)][d][o] = {side, 0, 0, -1};
+                    }
+                    else
+                    {
+                        table[static_cast<size_t>(PositionEvent::INSERT)][d][o] = {side, 0, 1, 0};
+                        table[static_cast<size_t>(PositionEvent::TRADE)][d][o] = {side, -1, -1, 0};
+                        table[static_cast<size_t>(PositionEvent::CANCEL)][d][o] = {side, 0, -1, 0};
+                        table[static_cast<size_t>(PositionEvent::ERROR)][d][o] = {side, 0, -1, 0};
+                    }
+                }
+            }
+            return table;
+        }
+        constexpr auto position_transition_table = make_position_transition_table();
+        static_assert(position_transition_table[static_cast<size_t>(PositionEvent::TRADE)][static_cast<size_t>(data_type::Direction::SHORT)][static_cast<size_t>(data_type::Offset::CLOSE_TD)].side == &data_type::PositionData::long_position);
+        static_assert(position_transition_table[static_cast<size_t>(PositionEvent::INSERT)][static_cast<size_t>(data_type::Direction::UNKNOWN)][static_cast<size_t>(data_type::Offset::OPEN)].side == nullptr);
+
+        bool apply_position_transition(PositionEvent event, const data_type::OrderReq& req, data_type::PositionData& position, uint32_t volume)
+        {
+            const auto d = static_cast<size_t>(req.direction);
+            const auto o = static_cast<size_t>(req.offset);
+            if (d >= direction_num || o >= offset_num) return false;
+            const auto& transition = position_transition_table[static_cast<size_t>(event)][d][o];
+            if (transition.side == nullptr) return false;
+            auto& info = position.*transition.side;
+            const auto v = static_cast<int64_t>(volume);
+            info.position = static_cast<uint32_t>(info.position + transition.position * v);
+            info.frozen = static_cast<uint32_t>(info.frozen + transition.frozen * v);
+            info.pending = static_cast<uint32_t>(info.pending + transition.pending * v);
+            return true;
+        }
+        // 根据成交/撤单/剩余数量推进委托状态, 拒单为终态
+        void update_order_status(data_type::OrderData& order)
+        {
+            if (order.status == data_type::OrderStatus::REJECTED) return;
+            if (order.remain_volume > 0)
+            {
+                order.status = order.traded_volume > 0 ? data_type::OrderStatus::PARTIAL_TRADED : data_type::OrderStatus::QUEUEING;
+            }
+            else if (order.canceled_volume == 0)
+            {
+                order.status = data_type::OrderStatus::ALL_TRADED;
+            }
+            else
+            {
+                order.status = order.traded_volume > 0 ? data_type::OrderStatus::PARTIAL_CANCELED : data_type::OrderStatus::ALL_CANCELED;
+            }
+        }
+    }
     OMS::OMS(
-        const config_type::AccountConfig& account_config,
-        db::Executor& db_writer
+        const config_type::AccountConfig& account_config
     )
-    : _account_config(account_config), _db_writer(db_writer)
+    : _account_config(account_config)
     {
-
+        _dirty_order_refs.reserve(_account_config.order_capacity);
     }
-    void OMS::set_trade_info(std::shared_ptr<TradeInfo> trade_info)
+    void OMS::set_trade_info(std::shared_ptr<TradeInfo> trade_info, bool counter_account)
     {
+        // 价差组合持仓不在柜台和日志中, 重建交易数据时保留
+        auto spread_position_data = std::move(_trade_info->_spread_position_data);
         _trade_info = std::move(trade_info);
+        if (_trade_info->_spread_position_data.empty()) _trade_info->_spread_position_data = std::move(spread_position_data);
         if (_market_info)
         {
+            _trade_info->_position_data.reserve(_market_info->_symbol_details.size());
             for (const auto& [symbol, detail] : _market_info->_symbol_details)
             {
                 if (_trade_info->_position_data.find(symbol) == _trade_info->_position_data.end())
                 {
-                    _trade_info->_position_data[symbol] = std::make_shared<data_type::PositionData>();
+                    _trade_info->_position_data[symbol] = std::make_shared<data_type::PositionData>(symbol);
                 }
             }
         }
@@ -33,409 +128,752 @@ namespace rk
         {
             _trade_info->_trade_data.resize(_trade_info->_order_data.size());
         }
-
+        // 柜台查询的在途委托无本地冻结记录, 释放时按报单重新计算
+        _frozen_funds.clear();
+        _frozen_funds.resize(_trade_info->_order_data.size());
+        _trade_ids.clear();
+        _trade_ids.reserve(std::max<size_t>(_account_config.trade_capacity, _trade_info->_trade_data.value_size()));
+        for (size_t order_ref = 0; order_ref < _trade_info->_trade_data.size(); ++order_ref)
+        {
+            for (const auto& trade : _trade_info->_trade_data[order_ref]) _trade_ids.emplace(trade_key(trade));
+        }
+        rebase_account(counter_account);
+        _snapshot_full = true;
     }
     void OMS::set_market_info(std::shared_ptr<MarketInfo> market_info)
     {
         _market_info = std::move(market_info);
+        // 预留全部合约, 行情/持仓表在交易时段不再扩容
+        _market_info->_last_tick_data.reserve(_market_info->_symbol_details.size());
+        if (_trade_info) _trade_info->_position_data.reserve(_market_info->_symbol_details.size());
         for (const auto& [symbol, detail] : _market_info->_symbol_details)
         {
             if (_trade_info && _trade_info->_position_data.find(symbol) == _trade_info->_position_data.end())
             {
-                _trade_info->_position_data[symbol] = std::make_shared<data_type::PositionData>();
+                _trade_info->_position_data[symbol] = std::make_shared<data_type::PositionData>(symbol);
             }
             _market_info->_last_tick_data[symbol] = std::make_shared<data_type::TickData>();
         }
 
     }
-    data_type::OrderRef OMS::order_insert(const data_type::OrderReq& req)
+    std::optional<data_type::OrderRef> OMS::order_insert(const data_type::OrderReq& req, bool verbose)
     {
+        // 日志写不进的委托恢复时会丢失, 不报出
+        if (!_replaying && !journal_writable())
+        {
+            RK_LOG_ERROR(
+                "journal not writable, record num {} capacity {}, order {} rejected",
+                _journal ? _journal->size() : 0, _journal ? _journal->capacity() : 0, req.symbol.symbol.c_str()
+            );
+            return std::nullopt;
+        }
         auto& position = _trade_info->_position_data[req.symbol];
         auto order_ref = static_cast<data_type::OrderRef>(_trade_info->_order_data.size());
         _trade_info->_order_data.emplace_back(data_type::OrderData{
             order_ref,
             req,
             _market_info->_trading_day, util::DateTime::now(),
-            // data_type::OrderStatus::QUEUEING,
+            data_type::OrderStatus::QUEUEING,
             0, req.volume, 0
         });
-        _trade_info->_trade_data.emplace_back();
-        switch (req.direction)
+        if (_trade_info->_trade_data.size() <= order_ref) _trade_info->_trade_data.resize(order_ref + 1);
+        if (req.offset == data_type::Offset::OPEN) freeze(order_ref, req, req.volume);
+        if (!apply_position_transition(PositionEvent::INSERT, req, *position, req.volume))
         {
-            case data_type::Direction::LONG:
-            {
-                switch (req.offset)
-                {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->long_position.pending += req.volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->short_position.frozen += req.volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", req.symbol.symbol.c_str());
-                        break;
-                    }
-                }
-                break;
-            }
-            case data_type::Direction::SHORT:
-            {
-                switch (req.offset)
-                {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->short_position.pending += req.volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->long_position.frozen += req.volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", req.symbol.symbol.c_str());
-                        break;
-                    }
-                }
-                break;
-            }
-            default:
-            {
-                RK_LOG_ERROR("unknown direction {}", req.symbol.symbol.c_str());
-            }
+            RK_LOG_ERROR("unknown direction or offset {} {}", req.symbol.symbol.c_str(), magic_enum::enum_name(req.offset));
+        }
+        update_yd_position(req, *position, req.volume, 0);
+        mark_dirty(order_ref);
+        // 先写日志再报单
+        append_journal(JournalType::ORDER_INSERT, _trade_info->_order_data[order_ref]);
+        if (_replaying) return order_ref;
+        if (verbose)
+        {
+            RK_LOG_INFO(
+                "order_insert: ref {} {} {} {} price {} volume {}",
+                order_ref, req.symbol.symbol.c_str(), magic_enum::enum_name(req.direction), magic_enum::enum_name(req.offset), req.limit_price, req.volume
+            );
         }
-        auto log = std::format("order_insert: {}", data_type::to_json(_trade_info->_order_data[order_ref]).dump(4));
-        RK_LOG_INFO("{}", log.c_str());
-        const auto& symbol = req.symbol;
-        _db_writer.insert_async(
-            db::table::logs::table_name,
-            nullptr,
-            _market_info->_trading_day,
-            _account_config.account_name,
-            symbol.symbol.to_string(),
-            symbol.trade_symbol.to_string(),
-            magic_enum::enum_name(symbol.exchange),
-            magic_enum::enum_name(symbol.product_class),
-            order_ref,
-            "order_insert",
-            log,
-            "INFO",
-            util::DateTime::now().strftime(), util::DateTime::now().strftime()
-        );
         return order_ref;
     }
 
-    void OMS::order_cancel(data_type::OrderRef order_ref)
+    void OMS::order_cancel(data_type::OrderRef order_ref, bool verbose)
     {
-        auto log = std::format("order_cancel: {}", data_type::to_json(_trade_info->_order_data[order_ref]).dump(4));
-        RK_LOG_INFO("{}", log.c_str());
-        const auto& symbol = _trade_info->_order_data[order_ref].order_req.symbol;
-        _db_writer.insert_async(
-            db::table::logs::table_name,
-            nullptr,
-            _market_info->_trading_day,
-            _account_config.account_name,
-            symbol.symbol.to_string(),
-            symbol.trade_symbol.to_string(),
-            magic_enum::enum_name(symbol.exchange),
-            magic_enum::enum_name(symbol.product_class),
-            order_ref,
-            "order_cancel",
-            log,
-            "INFO",
-            util::DateTime::now().strftime(), util::DateTime::now().strftime()
-        );
+        const auto& order_data = _trade_info->_order_data[order_ref];
+        append_journal(JournalType::ORDER_CANCEL, order_ref);
+        if (verbose) RK_LOG_INFO("order_cancel: ref {} {} remain volume {}", order_ref, order_data.order_req.symbol.symbol.c_str(), order_data.remain_volume);
         return;
     }
 	void OMS::handle_tick(const data_type::TickData& data)
 	{
         *_market_info->_last_tick_data[data.symbol] = data;
+        if (!_spread_legs.empty() && data.last_price > 0.)
+        {
+            if (const auto spread_it = _spread_legs.find(data.symbol); spread_it != _spread_legs.end())
+            {
+                for (const auto& [spread_id, leg_id] : spread_it->second)
+                {
+                    auto& spread = *_trade_info->_spread_position_data[spread_id];
+                    spread.leg_last_price[leg_id] = data.last_price;
+                    update_spread_position(spread);
+                }
+            }
+        }
+        auto position_it = _trade_info->_position_data.find(data.symbol);
+        if (position_it == _trade_info->_position_data.end() || position_it->second->empty()) return;
+        auto detail_it = _market_info->_symbol_details.find(data.symbol);
+        if (detail_it == _market_info->_symbol_details.end()) return;
+        mark_to_market(*detail_it->second, *position_it->second, data.last_price);
 	}
     void OMS::handle_bar(const data_type::BarData& data)
     {
 
     }
-	void OMS::handle_trade(const data_type::TradeData& data)
+    void OMS::add_spread_position(data_type::SpreadId spread_id, const data_type::SpreadDetail& detail)
+    {
+        auto& spread_position_data = _trade_info->_spread_position_data;
+        if (spread_position_data.size() <= spread_id) spread_position_data.resize(spread_id + 1);
+        auto spread = std::make_shared<data_type::SpreadPositionData>();
+        spread->spread_id = spread_id;
+        spread->detail = detail;
+        spread->leg_position.resize(detail.legs.size());
+        spread->leg_multiplier.resize(detail.legs.size(), 1.);
+        spread->leg_last_price.resize(detail.legs.size());
+        for (uint32_t leg_id = 0; leg_id < detail.legs.size(); ++leg_id)
+        {
+            const auto& symbol = detail.legs[leg_id].symbol;
+            if (const auto it = _market_info->_symbol_details.find(symbol); it != _market_info->_symbol_details.end() && it->second)
+            {
+                spread->leg_multiplier[leg_id] = it->second->multiplier;
+            }
+            if (const auto it = _market_info->_last_tick_data.find(symbol); it != _market_info->_last_tick_data.end() && it->second)
+            {
+                spread->leg_last_price[leg_id] = it->second->last_price;
+            }
+            _spread_legs[symbol].emplace_back(spread_id, leg_id);
+        }
+        spread_position_data[spread_id] = std::move(spread);
+    }
+    void OMS::handle_spread_trade(data_type::SpreadId spread_id, uint32_t leg_id, const data_type::TradeData& data)
+    {
+        if (spread_id >= _trade_info->_spread_position_data.size() || !_trade_info->_spread_position_data[spread_id]) return;
+        auto& spread = *_trade_info->_spread_position_data[spread_id];
+        const auto& order_req = _trade_info->_order_data[data.order_ref].order_req;
+        const auto volume = static_cast<int64_t>(data.trade_volume);
+        const auto signed_volume = order_req.direction == data_type::Direction::LONG ? volume : -volume;
+        const auto amount = data.trade_price * data.trade_volume * spread.leg_multiplier[leg_id];
+        spread.leg_position[leg_id] += signed_volume;
+        spread.cash -= order_req.direction == data_type::Direction::LONG ? amount : -amount;
+        if (data.fee != 0.) spread.fee += data.fee;
+        else if (const auto it = _market_info->_symbol_details.find(order_req.symbol); it != _market_info->_symbol_details.end())
+        {
+            spread.fee += it->second->commission(order_req.offset, amount, data.trade_volume);
+        }
+        if (spread.leg_last_price[leg_id] <= 0.) spread.leg_last_price[leg_id] = data.trade_price;
+        update_spread_position(spread);
+    }
+    void OMS::update_spread_position(data_type::SpreadPositionData& spread)
+    {
+        // 各腿持仓按比例折算的组合数同号时, 取绝对值最小者为已配平组合数
+        int64_t position = 0;
+        double value = 0.;
+        for (uint32_t leg_id = 0; leg_id < spread.leg_position.size(); ++leg_id)
+        {
+            const auto units = spread.leg_position[leg_id] / spread.detail.legs[leg_id].ratio;
+            if (leg_id == 0) position = units;
+            else if ((units > 0) != (position > 0) || units == 0) position = 0;
+            else if (std::abs(units) < std::abs(position)) position = units;
+            value += static_cast<double>(spread.leg_position[leg_id]) * spread.leg_last_price[leg_id] * spread.leg_multiplier[leg_id];
+        }
+        spread.position = position;
+        spread.profit = spread.cash + value - spread.fee;
+    }
+	bool OMS::handle_trade(const data_type::TradeData& data)
 	{
-        _trade_info->_trade_data[data.order_ref].emplace_back(data);
+        // 成交回报去重(柜台重推, 断线重连)
+        if (!_trade_ids.emplace(trade_key(data)).second)
+        {
+            RK_LOG_WARN("duplicate trade {} order ref {}, ignored", data.trade_id.c_str(), data.order_ref);
+            return false;
+        }
         auto& order_data = _trade_info->_order_data[data.order_ref];
+        const auto& order_req = order_data.order_req;
+        auto& position = _trade_info->_position_data[order_req.symbol];
+        // 成交回报晚于撤单回报且撤单数量多计, 回滚多撤的部分
+        if (data.trade_volume > order_data.remain_volume)
+        {
+            const auto excess = std::min(data.trade_volume - order_data.remain_volume, order_data.canceled_volume);
+            RK_LOG_WARN("order ref {} trade volume {} exceed remain volume {}, rollback canceled volume {}", data.order_ref, data.trade_volume, order_data.remain_volume, excess);
+            order_data.canceled_volume -= excess;
+            order_data.remain_volume += excess;
+            if (order_req.offset == data_type::Offset::OPEN) freeze(data.order_ref, order_req, excess);
+            apply_position_transition(PositionEvent::INSERT, order_req, *position, excess);
+            update_yd_position(order_req, *position, excess, 0);
+        }
+        auto& trade_data = _trade_info->_trade_data.push_back(data.order_ref, data);
         order_data.traded_volume += data.trade_volume;
-        order_data.remain_volume -= data.trade_volume;
+        order_data.remain_volume -= std::min(data.trade_volume, order_data.remain_volume);
+        update_order_status(order_data);
+        auto detail_it = _market_info->_symbol_details.find(order_req.symbol);
+        if (detail_it != _market_info->_symbol_details.end())
+        {
+            auto fee = settle_trade(*detail_it->second, order_req, *position, data);
+            if (data.fee == 0.) trade_data.fee = fee;
+        }
+        else
+        {
+            RK_LOG_ERROR("symbol detail not found {}, account not updated", order_req.symbol.symbol.c_str());
+        }
+        if (!apply_position_transition(PositionEvent::TRADE, order_req, *position, data.trade_volume))
+        {
+            RK_LOG_ERROR("unknown direction or offset {} {}", order_req.symbol.symbol.c_str(), magic_enum::enum_name(order_req.offset));
+        }
+        update_yd_position(order_req, *position, -static_cast<int64_t>(data.trade_volume), data.trade_volume);
+        if (detail_it != _market_info->_symbol_details.end())
+        {
+            const auto& last_tick = _market_info->_last_tick_data[order_req.symbol];
+            mark_to_market(
+                *detail_it->second,
+                *position,
+                (last_tick && last_tick->last_price > 0.) ? last_tick->last_price : data.trade_price
+            );
+        }
+        mark_dirty(data.order_ref);
+        append_journal(JournalType::TRADE_DATA, trade_data);
+        if (_replaying) return true;
+        RK_LOG_INFO(
+            "handle_trade: ref {} trade_id {} price {} volume {} fee {}",
+            data.order_ref, data.trade_id.c_str(), data.trade_price, data.trade_volume, trade_data.fee
+        );
+        return true;
+	}
+    bool OMS::handle_cancel(const data_type::CancelData& data)
+    {
+        auto& order_data = _trade_info->_order_data[data.order_ref];
+        if (order_data.is_finished())
+        {
+            RK_LOG_WARN("order ref {} finished with status {}, cancel ignored", data.order_ref, magic_enum::enum_name(order_data.status));
+            return false;
+        }
+        // 成交回报先于撤单回报到达时, 撤单数量不超过本地剩余数量
+        const auto cancel_volume = std::min(data.cancel_volume, order_data.remain_volume);
+        order_data.remain_volume -= cancel_volume;
+        order_data.canceled_volume += cancel_volume;
+        update_order_status(order_data);
 
         const auto& order_req = order_data.order_req;
         auto& position = _trade_info->_position_data[order_req.symbol];
-        switch (order_req.direction)
+        if (order_req.offset == data_type::Offset::OPEN) unfreeze(data.order_ref, order_req, cancel_volume);
+        if (!apply_position_transition(PositionEvent::CANCEL, order_req, *position, cancel_volume))
         {
-            case data_type::Direction::LONG:
+            RK_LOG_ERROR("unknown direction or offset {} {}", order_req.symbol.symbol.c_str(), magic_enum::enum_name(order_req.offset));
+        }
+        update_yd_position(order_req, *position, -static_cast<int64_t>(cancel_volume), 0);
+        mark_dirty(data.order_ref);
+        append_journal(JournalType::CANCEL_DATA, data);
+        if (_replaying) return true;
+        RK_LOG_INFO("handle_cancel: ref {} cancel volume {} remain volume {}", data.order_ref, cancel_volume, order_data.remain_volume);
+        return true;
+    }
+    bool OMS::handle_error(const data_type::OrderError& data)
+    {
+        auto& order_data = _trade_info->_order_data[data.order_ref];
+        const auto& order_req = order_data.order_req;
+        auto& position = _trade_info->_position_data[order_req.symbol];
+        switch (data.error_type)
+        {
+            case data_type::ErrorType::ORDER_INSERT_ERROR:
             {
-                switch (order_req.offset)
+                if (order_data.is_finished())
                 {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->long_position.position += data.trade_volume;
-                        position->long_position.pending -= data.trade_volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->short_position.position -= data.trade_volume;
-                        position->short_position.frozen -= data.trade_volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                        break;
-                    }
+                    RK_LOG_WARN("order ref {} finished with status {}, error ignored", data.order_ref, magic_enum::enum_name(order_data.status));
+                    return false;
+                }
+                // 释放剩余委托的冻结
+                const auto volume = order_data.remain_volume;
+                order_data.remain_volume = 0;
+                order_data.status = data_type::OrderStatus::REJECTED;
+                if (order_req.offset == data_type::Offset::OPEN) unfreeze(data.order_ref, order_req, volume);
+                update_yd_position(order_req, *position, -static_cast<int64_t>(volume), 0);
+                if (!apply_position_transition(PositionEvent::ERROR, order_req, *position, volume))
+                {
+                    RK_LOG_ERROR("unknown direction or offset {} {}", order_req.symbol.symbol.c_str(), magic_enum::enum_name(order_req.offset));
                 }
+                mark_dirty(data.order_ref);
                 break;
             }
-            case data_type::Direction::SHORT:
+            case data_type::ErrorType::ORDER_CANCEL_ERROR:
             {
-                switch (order_req.offset)
-                {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->short_position.position += data.trade_volume;
-                        position->short_position.pending -= data.trade_volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->long_position.position -= data.trade_volume;
-                        position->long_position.frozen -= data.trade_volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                        break;
-                    }
-                }
                 break;
             }
             default:
             {
-                RK_LOG_ERROR("unknown direction {}", order_req.symbol.symbol.c_str());
+                RK_LOG_ERROR("unknown error type {}", order_req.symbol.symbol.c_str());
                 break;
             }
         }
-        auto log = std::format("handle_trade: {}", data_type::to_json(data).dump(4));
-        RK_LOG_INFO("{}", log.c_str());
-        const auto& symbol = _trade_info->_order_data[data.order_ref].order_req.symbol;
-        _db_writer.insert_async(
-            db::table::logs::table_name,
-            nullptr,
-            _market_info->_trading_day,
-            _account_config.account_name,
-            symbol.symbol.to_string(),
-            symbol.trade_symbol.to_string(),
-            magic_enum::enum_name(symbol.exchange),
-            magic_enum::enum_name(symbol.product_class),
-            data.order_ref,
-            "handle_trade",
-            log,
-            "INFO",
-            util::DateTime::now().strftime(), util::DateTime::now().strftime()
-        );
-        return;
-	}
-    void OMS::handle_cancel(const data_type::CancelData& data)
+        append_journal(JournalType::ORDER_ERROR, data);
+        if (_replaying) return true;
+        RK_LOG_INFO("handle_error: ref {} {} {}", data.order_ref, magic_enum::enum_name(data.error_type), data.error_msg.c_str());
+        return true;
+    }
+    std::shared_ptr<TradeInfo> OMS::restore_trade_info()
     {
-        auto& order_data = _trade_info->_order_data[data.order_ref];
-        order_data.remain_volume -= data.cancel_volume;
-        order_data.canceled_volume += data.cancel_volume;
-
-        const auto& order_req = order_data.order_req;
-        auto& position = _trade_info->_position_data[order_req.symbol];
-        switch (order_req.direction)
+        if (!open_journal()) return nullptr;
+        // 定位最后一个完整快照, 快照写到一半崩溃则回退到柜台查询
+        const auto size = _journal->size();
+        size_t checkpoint_begin = size;
+        size_t checkpoint_end = size;
+        for (auto i = size; i > 0; --i)
         {
-            case data_type::Direction::LONG:
+            const auto type = (*_journal)[i - 1].type;
+            if (type == JournalType::CHECKPOINT_END && checkpoint_end == size) checkpoint_end = i - 1;
+            else if (type == JournalType::CHECKPOINT_BEGIN && checkpoint_end != size)
             {
-                switch (order_req.offset)
-                {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->long_position.pending -= data.cancel_volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->short_position.frozen -= data.cancel_volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                        break;
-                    }
-                }
+                checkpoint_begin = i - 1;
                 break;
             }
-            case data_type::Direction::SHORT:
+        }
+        if (checkpoint_begin == size)
+        {
+            RK_LOG_INFO("no checkpoint in journal, trading_day {}", _journal_trading_day);
+            return nullptr;
+        }
+        auto trade_info = std::make_shared<TradeInfo>();
+        trade_info->_account_name = _account_config.account_name;
+        trade_info->_order_data.reserve(_account_config.order_capacity);
+        trade_info->_trade_data.reserve(_account_config.order_capacity, _account_config.trade_capacity);
+        for (auto i = checkpoint_begin + 1; i < checkpoint_end; ++i)
+        {
+            const auto record = (*_journal)[i];
+            switch (record.type)
             {
-                switch (order_req.offset)
+                case JournalType::ACCOUNT:
                 {
-                    case data_type::Offset::OPEN:
-                    {
-                        position->short_position.pending -= data.cancel_volume;
-                        break;
-                    }
-                    case data_type::Offset::CLOSE:
-                    case data_type::Offset::CLOSE_TD:
-                    case data_type::Offset::CLOSE_YD:
-                    {
-                        position->long_position.frozen -= data.cancel_volume;
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                        break;
-                    }
+                    trade_info->_account_data = record.get<data_type::AccountData>();
+                    break;
                 }
-                break;
+                case JournalType::POSITION:
+                {
+                    const auto position = record.get<data_type::PositionData>();
+                    trade_info->_position_data[position.symbol] = std::make_shared<data_type::PositionData>(position);
+                    break;
+                }
+                case JournalType::ORDER:
+                {
+                    const auto order = record.get<data_type::OrderData>();
+                    if (trade_info->_order_data.size() <= order.order_ref) trade_info->_order_data.resize(order.order_ref + 1);
+                    trade_info->_order_data[order.order_ref] = order;
+                    break;
+                }
+                case JournalType::TRADE:
+                {
+                    const auto trade = record.get<data_type::TradeData>();
+                    trade_info->_trade_data.push_back(trade.order_ref, trade);
+                    break;
+                }
+                default: break;
             }
-            default:
+        }
+        // 快照之后的增量事件按原顺序回放
+        _replaying = true;
+        set_trade_info(trade_info, false);
+        size_t event_num = 0;
+        for (auto i = checkpoint_end + 1; i < size; ++i)
+        {
+            const auto record = (*_journal)[i];
+            switch (record.type)
             {
-                RK_LOG_ERROR("unknown direction {}", order_req.symbol.symbol.c_str());
-                break;
+                case JournalType::ORDER_INSERT:
+                {
+                    const auto order = record.get<data_type::OrderData>();
+                    const auto order_ref = *order_insert(order.order_req);
+                    _trade_info->_order_data[order_ref].req_time = order.req_time;
+                    if (order_ref != order.order_ref) RK_LOG_ERROR("journal order ref {} replayed as {}", order.order_ref, order_ref);
+                    break;
+                }
+                case JournalType::TRADE_DATA:
+                {
+                    const auto data = record.get<data_type::TradeData>();
+                    if (data.order_ref < _trade_info->_order_data.size()) handle_trade(data);
+                    break;
+                }
+                case JournalType::CANCEL_DATA:
+                {
+                    const auto data = record.get<data_type::CancelData>();
+                    if (data.order_ref < _trade_info->_order_data.size()) handle_cancel(data);
+                    break;
+                }
+                case JournalType::ORDER_ERROR:
+                {
+                    const auto data = record.get<data_type::OrderError>();
+                    if (data.order_ref < _trade_info->_order_data.size()) handle_error(data);
+                    break;
+                }
+                default: continue;
             }
+            ++event_num;
         }
-        auto log = std::format("handle_cancel: {}", data_type::to_json(data).dump(4));
-        RK_LOG_INFO("{}", log.c_str());
-        const auto& symbol = _trade_info->_order_data[data.order_ref].order_req.symbol;
-        _db_writer.insert_async(
-            db::table::logs::table_name,
-            nullptr,
-            _market_info->_trading_day,
-            _account_config.account_name,
-            symbol.symbol.to_string(),
-            symbol.trade_symbol.to_string(),
-            magic_enum::enum_name(symbol.exchange),
-            magic_enum::enum_name(symbol.product_class),
-            data.order_ref,
-            "handle_cancel",
-            log,
-            "INFO",
-            util::DateTime::now().strftime(), util::DateTime::now().strftime()
+        _replaying = false;
+        RK_LOG_INFO(
+            "journal restored, trading_day {}, order num {}, trade num {}, replayed event num {}",
+            _journal_trading_day, _trade_info->_order_data.size(), _trade_info->_trade_data.value_size(), event_num
         );
+        return _trade_info;
     }
-    void OMS::handle_error(const data_type::OrderError& data)
+    bool OMS::reconcile(const TradeInfo& counter_info)
     {
-        auto& order_data = _trade_info->_order_data[data.order_ref];
-        order_data.remain_volume = 0;
-        order_data.canceled_volume = 0;
-        order_data.traded_volume = 0;
-        const auto& order_req = order_data.order_req;
-        auto& position = _trade_info->_position_data[order_req.symbol];
-        switch (data.error_type)
+        // 补齐的委托和以柜台为准的持仓下次全量快照
+        _snapshot_full = true;
+        // 日志未覆盖的委托(掉电丢失的尾部记录), 以柜台数据补齐
+        for (size_t order_ref = _trade_info->_order_data.size(); order_ref < counter_info._order_data.size(); ++order_ref)
         {
-            case data_type::ErrorType::ORDER_INSERT_ERROR:
+            RK_LOG_WARN("reconcile order ref {} missing in journal", order_ref);
+            _trade_info->_order_data.emplace_back(counter_info._order_data[order_ref]);
+            _trade_info->_order_data.back().order_ref = static_cast<data_type::OrderRef>(order_ref);
+            if (order_ref >= counter_info._trade_data.size()) continue;
+            for (const auto& trade : counter_info._trade_data[order_ref])
+            {
+                _trade_info->_trade_data.push_back(order_ref, trade);
+                _trade_ids.emplace(trade_key(trade));
+            }
+        }
+        if (_trade_info->_trade_data.size() < _trade_info->_order_data.size()) _trade_info->_trade_data.resize(_trade_info->_order_data.size());
+        // 遗漏的成交和撤单按回报处理
+        size_t trade_num = 0;
+        size_t cancel_num = 0;
+        for (size_t order_ref = 0; order_ref < counter_info._trade_data.size() && order_ref < _trade_info->_order_data.size(); ++order_ref)
+        {
+            for (const auto& trade : counter_info._trade_data[order_ref])
+            {
+                if (!_trade_ids.contains(trade_key(trade)) && handle_trade(trade)) ++trade_num;
+            }
+        }
+        for (size_t order_ref = 0; order_ref < counter_info._order_data.size() && order_ref < _trade_info->_order_data.size(); ++order_ref)
+        {
+            const auto& counter_order = counter_info._order_data[order_ref];
+            const auto& order = _trade_info->_order_data[order_ref];
+            if (counter_order.canceled_volume <= order.canceled_volume || order.is_finished()) continue;
+            if (handle_cancel(data_type::CancelData{
+                static_cast<data_type::OrderRef>(order_ref),
+                counter_order.canceled_volume - order.canceled_volume,
+                _market_info->_trading_day,
+                util::DateTime::now()
+            })) ++cancel_num;
+        }
+        // 柜台快照须覆盖本地全部委托和成交才以其持仓资金为准, 否则查询之后的成交会被抹掉, 保留本地并重新查询
+        size_t uncovered_num = 0;
+        for (size_t order_ref = 0; order_ref < _trade_info->_order_data.size(); ++order_ref)
+        {
+            uint32_t counter_volume = 0;
+            if (order_ref < counter_info._trade_data.size())
+            {
+                for (const auto& trade : counter_info._trade_data[order_ref]) counter_volume += trade.trade_volume;
+            }
+            const auto& order = _trade_info->_order_data[order_ref];
+            if (order_ref < counter_info._order_data.size() && counter_volume >= order.traded_volume) continue;
+            if (uncovered_num++ == 0)
             {
-                switch (order_req.direction)
+                RK_LOG_WARN("reconcile order ref {} traded local {} counter {}", order_ref, order.traded_volume, counter_volume);
+            }
+        }
+        if (uncovered_num > 0)
+        {
+            for (const auto& [symbol, counter_position] : counter_info._position_data)
+            {
+                const auto it = _trade_info->_position_data.find(symbol);
+                if (it == _trade_info->_position_data.end() || !it->second) continue;
+                const auto& position = it->second;
+                for (auto side : {&data_type::PositionData::long_position, &data_type::PositionData::short_position})
                 {
-                    case data_type::Direction::LONG:
-                    {
-                        switch (order_req.offset)
-                        {
-                            case data_type::Offset::OPEN:
-                            {
-                                position->long_position.pending -= order_req.volume;
-                                break;
-                            }
-                            case data_type::Offset::CLOSE:
-                            case data_type::Offset::CLOSE_TD:
-                            case data_type::Offset::CLOSE_YD:
-                            {
-                                position->short_position.frozen -= order_req.volume;
-                                break;
-                            }
-                            default:
-                            {
-                                RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                                break;
-                            }
-                        }
-                        break;
-                    }
-                    case data_type::Direction::SHORT:
-                    {
-                        switch (order_req.offset)
-                        {
-                            case data_type::Offset::OPEN:
-                            {
-                                position->short_position.pending -= order_req.volume;
-                                break;
-                            }
-                            case data_type::Offset::CLOSE:
-                            case data_type::Offset::CLOSE_TD:
-                            case data_type::Offset::CLOSE_YD:
-                            {
-                                position->long_position.frozen -= order_req.volume;
-                                break;
-                            }
-                            default:
-                            {
-                                RK_LOG_ERROR("unknown offset {}", order_req.symbol.symbol.c_str());
-                                break;
-                            }
-                        }
-                        break;
-                    }
-                    default:
-                    {
-                        RK_LOG_ERROR("unknown direction {}", order_req.symbol.symbol.c_str());
-                        break;
-                    }
+                    const auto& info = (*position).*side;
+                    const auto& counter = (*counter_position).*side;
+                    if (info.position == counter.position && info.yd_position == counter.yd_position) continue;
+                    RK_LOG_WARN(
+                        "reconcile position {} local {}/{} counter {}/{}",
+                        symbol.symbol.c_str(), info.position, info.yd_position, counter.position, counter.yd_position
+                    );
                 }
-                break;
             }
-            case data_type::ErrorType::ORDER_CANCEL_ERROR:
+            RK_LOG_WARN(
+                "reconcile counter snapshot behind local, uncovered order num {}, missed trade num {}, missed cancel num {}",
+                uncovered_num, trade_num, cancel_num
+            );
+            return false;
+        }
+        // 持仓数量和资金以柜台为准, 冻结保留本地在途委托
+        for (const auto& [symbol, counter_position] : counter_info._position_data)
+        {
+            auto& position = _trade_info->_position_data[symbol];
+            if (!position) position = std::make_shared<data_type::PositionData>(symbol);
+            for (auto side : {&data_type::PositionData::long_position, &data_type::PositionData::short_position})
             {
-                break;
+                auto& info = (*position).*side;
+                const auto& counter = (*counter_position).*side;
+                if (info.position != counter.position || info.yd_position != counter.yd_position)
+                {
+                    RK_LOG_WARN(
+                        "reconcile position {} local {}/{} counter {}/{}",
+                        symbol.symbol.c_str(), info.position, info.yd_position, counter.position, counter.yd_position
+                    );
+                }
+                info.position = counter.position;
+                info.yd_position = counter.yd_position;
+                info.cost = counter.cost;
+                info.margin = counter.margin;
             }
-            default:
+        }
+        const auto available = _trade_info->_account_data.available;
+        _trade_info->_account_data = counter_info._account_data;
+        rebase_account(true);
+        RK_LOG_INFO(
+            "reconcile finished, missed trade num {}, missed cancel num {}, available local {} counter {}",
+            trade_num, cancel_num, available, _trade_info->_account_data.available
+        );
+        write_checkpoint();
+        return true;
+    }
+    bool OMS::take_snapshot_delta(std::vector<data_type::OrderRef>& order_refs)
+    {
+        order_refs.clear();
+        order_refs.swap(_dirty_order_refs);
+        for (const auto order_ref : order_refs) _dirty_flags[order_ref] = 0;
+        const auto full = _snapshot_full;
+        _snapshot_full = false;
+        return full;
+    }
+    void OMS::mark_dirty(data_type::OrderRef order_ref)
+    {
+        if (_snapshot_full) return;
+        if (_dirty_flags.size() <= order_ref) _dirty_flags.resize(order_ref + 1);
+        if (_dirty_flags[order_ref]) return;
+        _dirty_flags[order_ref] = 1;
+        _dirty_order_refs.push_back(order_ref);
+    }
+    bool OMS::open_journal()
+    {
+        const auto trading_day = _market_info->_trading_day;
+        if (_journal && _journal_trading_day == trading_day) return true;
+        // 每个交易日一个文件, 快照和增量事件约为委托数的两倍加成交数
+        const auto path = std::filesystem::path(_account_config.journal_path) / std::format("{}_{}.journal", _account_config.account_name, trading_day);
+        _journal = std::make_unique<util::Journal<JournalRecord>>(
+            path,
+            4ull * _account_config.order_capacity + 2ull * _account_config.trade_capacity,
+            std::chrono::milliseconds(10)
+        );
+        // 格式版本不一致的旧文件移走后重建, 不按新格式解码
+        if (!_journal->is_open() && std::filesystem::exists(path))
+        {
+            auto invalid_path = path;
+            invalid_path += ".invalid";
+            std::error_code ec;
+            std::filesystem::rename(path, invalid_path, ec);
+            RK_LOG_WARN("journal {} incompatible, moved to {}", path.c_str(), invalid_path.c_str());
+            if (!ec) _journal = std::make_unique<util::Journal<JournalRecord>>(
+                path,
+                4ull * _account_config.order_capacity + 2ull * _account_config.trade_capacity,
+                std::chrono::milliseconds(10)
+            );
+        }
+        if (!_journal->is_open())
+        {
+            RK_LOG_ERROR("open journal {} failed", path.c_str());
+            _journal = nullptr;
+            return false;
+        }
+        _journal_trading_day = trading_day;
+        _journal_failed = false;
+        RK_LOG_INFO("journal {} opened, record num {}", path.c_str(), _journal->size());
+        return true;
+    }
+    void OMS::write_checkpoint()
+    {
+        if (_replaying || !open_journal()) return;
+        append_journal(JournalType::CHECKPOINT_BEGIN, _market_info->_trading_day);
+        append_journal(JournalType::ACCOUNT, _trade_info->_account_data);
+        for (const auto& [symbol, position] : _trade_info->_position_data)
+        {
+            if (position && !position->empty()) append_journal(JournalType::POSITION, *position);
+        }
+        for (const auto& order : _trade_info->_order_data) append_journal(JournalType::ORDER, order);
+        for (size_t order_ref = 0; order_ref < _trade_info->_trade_data.size(); ++order_ref)
+        {
+            for (const auto& trade : _trade_info->_trade_data[order_ref]) append_journal(JournalType::TRADE, trade);
+        }
+        append_journal(JournalType::CHECKPOINT_END, _market_info->_trading_day);
+    }
+    bool OMS::journal_writable() const
+    {
+        return _journal && !_journal_failed && _journal->size() + _journal->capacity() / 8 < _journal->capacity();
+    }
+    template<typename T>
+    bool OMS::append_journal(JournalType type, const T& data)
+    {
+        if (_replaying) return true;
+        if (_journal && _journal->append(JournalRecord::make(type, data))) return true;
+        if (!_journal_failed)
+        {
+            RK_LOG_ERROR(
+                "journal append failed, capacity {}, record {} lost, new orders rejected",
+                _journal ? _journal->capacity() : 0, magic_enum::enum_name(type)
+            );
+        }
+        _journal_failed = true;
+        return false;
+    }
+    void OMS::update_yd_position(
+        const data_type::OrderReq& req,
+        data_type::PositionData& position,
+        int64_t frozen_delta,
+        uint32_t traded_volume
+    )
+    {
+        if (req.offset == data_type::Offset::OPEN) return;
+        auto& info = req.direction == data_type::Direction::LONG ? position.short_position : position.long_position;
+        if (position.symbol.is_close_yesterday(req.offset))
+        {
+            info.yd_frozen = static_cast<uint32_t>(std::max<int64_t>(0, info.yd_frozen + frozen_delta));
+            info.yd_position -= std::min(info.yd_position, traded_volume);
+        }
+        // 交易所自动先平今/先平昨的合约, 昨仓不超过总持仓即可
+        info.yd_position = std::min(info.yd_position, info.position);
+    }
+    void OMS::freeze(data_type::OrderRef order_ref, const data_type::OrderReq& req, uint32_t volume)
+    {
+        const auto amount = _market_info->required_funds(req, volume);
+        if (_frozen_funds.size() <= order_ref) _frozen_funds.resize(order_ref + 1);
+        auto& frozen = _frozen_funds[order_ref];
+        frozen.amount += amount;
+        frozen.volume += volume;
+        auto& account = _trade_info->_account_data;
+        account.frozen_margin += amount;
+        account.available -= amount;
+    }
+    void OMS::unfreeze(data_type::OrderRef order_ref, const data_type::OrderReq& req, uint32_t volume)
+    {
+        auto& account = _trade_info->_account_data;
+        double amount = 0.;
+        if (order_ref < _frozen_funds.size() && _frozen_funds[order_ref].volume > 0)
+        {
+            // 最后一笔释放剩余全部, 避免比例释放的舍入残留
+            auto& frozen = _frozen_funds[order_ref];
+            amount = volume >= frozen.volume ? frozen.amount : frozen.amount * volume / frozen.volume;
+            frozen.amount -= amount;
+            frozen.volume -= std::min(volume, frozen.volume);
+        }
+        else amount = _market_info->required_funds(req, volume);
+        amount = std::min(amount, account.frozen_margin);
+        account.frozen_margin -= amount;
+        account.available += amount;
+    }
+    double OMS::settle_trade(
+        const data_type::SymbolDetail& detail,
+        const data_type::OrderReq& req,
+        data_type::PositionData& position,
+        const data_type::TradeData& data
+    )
+    {
+        auto& account = _trade_info->_account_data;
+        const auto cash_settled = detail.is_cash_settled();
+        const auto amount = data.trade_price * data.trade_volume * detail.multiplier;
+        const auto fee = data.fee != 0. ? data.fee : detail.commission(req.offset, amount, data.trade_volume);
+        const auto is_open = req.offset == data_type::Offset::OPEN;
+        // 开多/平空作用于多头持仓, 开空/平多作用于空头持仓
+        const auto is_long = (req.direction == data_type::Direction::LONG) == is_open;
+        auto& info = is_long ? position.long_position : position.short_position;
+        // 先撤销该持仓盯市盈亏, 成交后按最新价重新盯市
+        update_profit(detail, info, 0.);
+        account.commission += fee;
+        account.balance -= fee;
+        account.available -= fee;
+        if (is_open)
+        {
+            unfreeze(data.order_ref, req, data.trade_volume);
+            info.cost += amount;
+            if (cash_settled)
             {
-                RK_LOG_ERROR("unknown error type {}", order_req.symbol.symbol.c_str());
-                break;
+                account.market_value += amount;
+                account.available -= amount;
+            }
+            else
+            {
+                const auto margin = detail.margin(req.direction, amount);
+                info.margin += margin;
+                account.margin += margin;
+                account.available -= margin;
             }
         }
-        auto log = std::format("handle_error: {}", data_type::to_json(data).dump(4));
-        RK_LOG_INFO("{}", log.c_str());
-        const auto& symbol = _trade_info->_order_data[data.order_ref].order_req.symbol;
-        _db_writer.insert_async(
-            db::table::logs::table_name,
-            nullptr,
-            _market_info->_trading_day,
-            _account_config.account_name,
-            symbol.symbol.to_string(),
-            symbol.trade_symbol.to_string(),
-            magic_enum::enum_name(symbol.exchange),
-            magic_enum::enum_name(symbol.product_class),
-            data.order_ref,
-            "handle_error",
-            log,
-            "INFO",
-            util::DateTime::now().strftime(), util::DateTime::now().strftime()
-        );
+        else
+        {
+            const auto ratio = info.position ? std::min(1., static_cast<double>(data.trade_volume) / info.position) : 0.;
+            const auto released_cost = info.cost * ratio;
+            const auto released_margin = info.margin * ratio;
+            const auto close_profit = is_long ? amount - released_cost : released_cost - amount;
+            info.cost -= released_cost;
+            info.margin -= released_margin;
+            account.close_profit += close_profit;
+            account.balance += close_profit;
+            if (cash_settled)
+            {
+                account.market_value -= released_cost;
+                account.available += amount;
+            }
+            else
+            {
+                account.margin -= released_margin;
+                account.available += released_margin + close_profit;
+            }
+        }
+        account.update_time = data.trade_time;
+        return fee;
+    }
+    void OMS::mark_to_market(const data_type::SymbolDetail& detail, data_type::PositionData& position, double last_price)
+    {
+        if (last_price <= 0.) return;
+        const auto unit = last_price * detail.multiplier;
+        update_profit(detail, position.long_position, unit * position.long_position.position - position.long_position.cost);
+        update_profit(detail, position.short_position, position.short_position.cost - unit * position.short_position.position);
+    }
+    void OMS::update_profit(const data_type::SymbolDetail& detail, data_type::PositionInfo& info, double profit)
+    {
+        const auto delta = profit - info.profit;
+        if (delta == 0.) return;
+        info.profit = profit;
+        auto& account = _trade_info->_account_data;
+        account.position_profit += delta;
+        account.balance += delta;
+        if (detail.is_cash_settled()) account.market_value += delta;
+        else account.available += delta;
+    }
+    void OMS::rebase_account(bool counter_account)
+    {
+        // 持仓盈亏扣除后由行情重新盯市, 避免重复计算
+        // 本地口径下股票盈亏已同时计入持仓盈亏和市值, 柜台资金的持仓盈亏不含股票, 股票盈亏只在市值中
+        auto& account = _trade_info->_account_data;
+        double stock_cost = 0.;
+        for (auto& [symbol, position] : _trade_info->_position_data)
+        {
+            if (!position) continue;
+            if (symbol.product_class == data_type::ProductClass::STOCK || symbol.product_class == data_type::ProductClass::ETF)
+            {
+                stock_cost += position->long_position.cost;
+            }
+            position->long_position.profit = 0.;
+            position->short_position.profit = 0.;
+        }
+        const auto stock_profit = account.market_value - stock_cost;
+        if (counter_account)
+        {
+            account.balance -= stock_profit + account.position_profit;
+            account.available -= account.position_profit;
+        }
+        else
+        {
+            account.balance -= account.position_profit;
+            account.available -= account.position_profit - stock_profit;
+        }
+        account.market_value = stock_cost;
+        account.position_profit = 0.;
     }
 
 
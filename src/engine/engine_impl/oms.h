@@ -4,10 +4,13 @@
 
 #pragma once
 #include <unordered_map>
-#include <unordered_set>
 #include <memory>
 #include "data_type.h"
-#include "util/db.h"
+#include "config_type.h"
+#include "util/flat_map.h"
+#include "util/journal.h"
+#include "util/paged_vector.h"
+#include "journal_record.h"
 namespace rk
 {
 	/// 订单管理系统, 本地维护数据(资金, 持仓, 委托, 成交)
@@ -16,28 +19,92 @@ namespace rk
 	struct MarketInfo;
 	class OMS
 	{
+		struct FrozenFunds
+		{
+			double amount = 0.;
+			uint32_t volume = 0;
+		};
+		// 成交去重键, 成交编号只在委托内唯一
+		struct TradeKey
+		{
+			data_type::OrderRef order_ref = 0;
+			util::FixedString<64> trade_id;
+			bool operator==(const TradeKey&) const = default;
+		};
+		struct TradeKeyHash
+		{
+			size_t operator()(const TradeKey& key) const noexcept
+			{
+				return util::IntegerHash{}(key.order_ref) ^ key.trade_id.hash();
+			}
+		};
 	public:
 
-		explicit OMS(
-			const config_type::AccountConfig& account_config,
-			db::Executor& db_writer
-		);
-		void set_trade_info(std::shared_ptr<TradeInfo> trade_info);
+		explicit OMS(const config_type::AccountConfig& account_config);
+		// counter_account为false表示资金来自本地日志快照(已按本地口径盯市)
+		void set_trade_info(std::shared_ptr<TradeInfo> trade_info, bool counter_account = true);
 		void set_market_info(std::shared_ptr<MarketInfo> market_info);
+		// 从当日预写日志重建交易数据, 日志不存在或快照不完整返回nullptr
+		std::shared_ptr<TradeInfo> restore_trade_info();
+		// 以柜台查询结果对账: 补齐遗漏的成交/撤单, 快照覆盖本地全部成交时持仓和资金以柜台为准
+		// 返回false表示快照早于本地回报, 未覆盖持仓资金, 需重新查询
+		bool reconcile(const TradeInfo& counter_info);
 		// trade
-		data_type::OrderRef order_insert(const data_type::OrderReq& req);
-		void order_cancel(data_type::OrderRef order_ref);
+		// verbose为false不打印报单日志(篮子子单), 预写日志不变
+		// 预写日志不可写(未打开/写满/写入失败)时拒绝报单, 返回nullopt
+		std::optional<data_type::OrderRef> order_insert(const data_type::OrderReq& req, bool verbose = true);
+		void order_cancel(data_type::OrderRef order_ref, bool verbose = true);
 		// handler
 		void handle_tick(const data_type::TickData& data);
 		void handle_bar(const data_type::BarData& data);
-		void handle_trade(const data_type::TradeData& data);
-		void handle_cancel(const data_type::CancelData& data);
-		void handle_error(const data_type::OrderError& data);
+		// 返回false表示重复或过期回报, 不再推送策略
+		bool handle_trade(const data_type::TradeData& data);
+		bool handle_cancel(const data_type::CancelData& data);
+		bool handle_error(const data_type::OrderError& data);
+		// 价差组合持仓, 与合约持仓同存于TradeInfo, 由各腿成交累加并按腿行情盯市
+		void add_spread_position(data_type::SpreadId spread_id, const data_type::SpreadDetail& detail);
+		void handle_spread_trade(data_type::SpreadId spread_id, uint32_t leg_id, const data_type::TradeData& data);
+		// 交易数据重建成功(柜台查询初始化/对账覆盖)后写全量快照, 日志回放时跳过
+		void write_checkpoint();
+		// 快照增量: 取出上次调用后变化的委托(与order_refs交换, 复用容量), 返回true表示交易数据整体重建过, 需全量快照
+		bool take_snapshot_delta(std::vector<data_type::OrderRef>& order_refs);
 
 	private:
+		// 资金, 由成交和行情增量维护
+		// 冻结金额按报单记录, 释放时按冻结时的金额比例释放, 不随行情变化
+		void freeze(data_type::OrderRef order_ref, const data_type::OrderReq& req, uint32_t volume);
+		void unfreeze(data_type::OrderRef order_ref, const data_type::OrderReq& req, uint32_t volume);
+		double settle_trade(const data_type::SymbolDetail& detail, const data_type::OrderReq& req, data_type::PositionData& position, const data_type::TradeData& data);
+		void mark_to_market(const data_type::SymbolDetail& detail, data_type::PositionData& position, double last_price);
+		void update_profit(const data_type::SymbolDetail& detail, data_type::PositionInfo& info, double profit);
+		void rebase_account(bool counter_account);
+		void update_spread_position(data_type::SpreadPositionData& spread);
+		// 昨仓, 平昨冻结
+		void update_yd_position(const data_type::OrderReq& req, data_type::PositionData& position, int64_t frozen_delta, uint32_t traded_volume);
+
+		void mark_dirty(data_type::OrderRef order_ref);
+		// 成交去重
+		static TradeKey trade_key(const data_type::TradeData& data) {return {data.order_ref, data.trade_id};}
+		// 预写日志, 同时作为结构化事件日志
+		bool open_journal();
+		// 新报单须留出1/8容量, 余量供在途委托的回报和对账快照写入
+		[[nodiscard]] bool journal_writable() const;
+		// 写满返回false, 此后拒绝新报单直到下一交易日日志
+		template<typename T>
+		bool append_journal(JournalType type, const T& data);
+
 		std::shared_ptr<TradeInfo> _trade_info = std::make_shared<TradeInfo>();
 		std::shared_ptr<MarketInfo> _market_info = std::make_shared<MarketInfo>();
 		const config_type::AccountConfig& _account_config;
-		db::Executor& _db_writer;
+		util::FlatMap<TradeKey, bool, TradeKeyHash> _trade_ids;		// 只用键, 按成交容量预留
+		util::PagedVector<FrozenFunds> _frozen_funds;		// 按OrderRef索引, 开仓报单的剩余冻结
+		std::vector<data_type::OrderRef> _dirty_order_refs;	// 上次快照后变化的委托
+		util::PagedVector<uint8_t> _dirty_flags;		// 按OrderRef索引, 去重
+		bool _snapshot_full = true;
+		util::FlatMap<data_type::Symbol, std::vector<std::pair<data_type::SpreadId, uint32_t>>> _spread_legs;	// 腿合约 -> (价差, 腿序号)
+		std::unique_ptr<util::Journal<JournalRecord>> _journal;
+		uint32_t _journal_trading_day = 0;
+		bool _journal_failed = false;
+		bool _replaying = false;    // 回放日志时不重复写日志和落库
 	};
 };
\ No newline at end of file
@@ -12,12 +12,13 @@ namespace rk
         return std::fabs(q - n) <= std::max(1e-9 * std::fabs(q), 1e-12);
     }
     RiskControl::RiskControl(
-        const bool& is_trading,
+        const std::atomic<bool>& is_trading,
         const config_type::AccountConfig& account_config,
         const config_type::RiskControlConfig& risk_control_config,
         db::Executor& db_writer
     )
-    : _is_trading(is_trading), _account_config(account_config), _db_writer(db_writer)
+    : _is_trading(is_trading), _account_config(account_config),
+    _order_rate_limiter(risk_control_config.order_rate, risk_control_config.order_burst), _db_writer(db_writer)
     {
         _thresholds = std::make_unique<RiskIndicators>(
             risk_control_config.daily_order_num,
@@ -32,16 +33,16 @@ namespace rk
         _risk_indicators->daily_order_num = 0;
         _risk_indicators->daily_cancel_num = 0;
         _risk_indicators->daily_repeat_order_num = 0;
-        std::unordered_map<data_type::OrderReq, int> repeat_order_cnt;
+        _order_req_count.clear();
         for (const auto& order : _trade_info->_order_data)
         {
-            ++repeat_order_cnt[order.order_req];
+            ++_order_req_count[order.order_req];
             ++(_risk_indicators->daily_order_num);
             if (order.canceled_volume != 0) ++(_risk_indicators->daily_cancel_num);
         }
         _risk_indicators->daily_repeat_order_num = static_cast<int>(std::count_if(
-            repeat_order_cnt.begin(),
-            repeat_order_cnt.end(),
+            _order_req_count.begin(),
+            _order_req_count.end(),
             [](const auto& pair){return pair.second > 1;}
         ));
         RK_LOG_INFO("risk indicators inited! daily_order_num: {}, daily_cancel_num: {}, daily_repeat_order_num: {}", _risk_indicators->daily_order_num, _risk_indicators->daily_cancel_num, _risk_indicators->daily_repeat_order_num);
@@ -64,6 +65,12 @@ namespace rk
             log = "trading stopped! order insert failed";
             pass = false;
         }
+        // 报撤单流控
+        else if (_order_rate_limiter.available() == 0)
+        {
+            log = "order rate limit exceeded!";
+            pass = false;
+        }
         // 报单笔数阈值
         else if (_risk_indicators->daily_order_num + 1 > _thresholds->daily_order_num)
         {
@@ -121,14 +128,26 @@ namespace rk
             log = std::format( "lower limit price {} upper limit price {}, price illegal", last_tick->lower_limit_price, last_tick->upper_limit_price);
             pass = false;
         }
-        // 重复报单监测和阈值(放在最后检查)
+        // 可平数量检查(平今平昨, 股票T+1)
+        else if (
+            req.offset != data_type::Offset::OPEN &&
+            req.volume > closable_volume(req)
+        )
+        {
+            log = std::format("closable volume {}, volume exceed", closable_volume(req));
+            pass = false;
+        }
+        // 开仓资金检查(保证金/现金及手续费)
         else if (
-            std::find_if(
-                _trade_info->_order_data.begin(),
-                _trade_info->_order_data.end(),
-                [&req](const auto& order) {return order.order_req == req;}
-            ) != _trade_info->_order_data.end()
+            req.offset == data_type::Offset::OPEN &&
+            _market_info->required_funds(req, req.volume) > _trade_info->_account_data.available
         )
+        {
+            log = std::format("required funds {} available {}, funds insufficient", _market_info->required_funds(req, req.volume), _trade_info->_account_data.available);
+            pass = false;
+        }
+        // 重复报单监测和阈值(放在最后检查)
+        else if (_order_req_count.contains(req))
         {
             RK_LOG_INFO("repeat order detected: {}", data_type::to_json(req).dump(4).c_str());
             if (_risk_indicators->daily_repeat_order_num + 1 > _thresholds->daily_repeat_order_num)
@@ -143,25 +162,35 @@ namespace rk
             log = std::format("{}\n{}", log, data_type::to_json(req).dump(4));
             RK_LOG_WARN("{}", log.c_str());
             const auto& symbol = req.symbol;
-            _db_writer.insert_async(
-                db::table::logs::table_name,
-                nullptr,
+            _db_writer.insert_async<db::table::logs>({
                 _market_info->_trading_day,
                 _account_config.account_name,
-                symbol.symbol.to_string(),
-                symbol.trade_symbol.to_string(),
-                magic_enum::enum_name(symbol.exchange),
-                magic_enum::enum_name(symbol.product_class),
-                nullptr,
+                symbol,
+                std::nullopt,
                 "order_insert",
                 log,
                 "WARN",
-                util::DateTime::now().strftime(), util::DateTime::now().strftime()
-            );
+                util::DateTime::now(), util::DateTime::now()
+            });
+        }
+        else
+        {
+            ++(_risk_indicators->daily_order_num);
+            ++_order_req_count[req];
+            _order_rate_limiter.try_acquire();
         }
-        else ++(_risk_indicators->daily_order_num);
         return pass;
     }
+    size_t RiskControl::order_quota()
+    {
+        return _order_rate_limiter.available();
+    }
+    uint32_t RiskControl::closable_volume(const data_type::OrderReq& req) const
+    {
+        auto it = _trade_info->_position_data.find(req.symbol);
+        if (it == _trade_info->_position_data.end() || !it->second) return 0;
+        return it->second->closable_volume(req.direction, req.offset);
+    }
     bool RiskControl::check_order_cancel(data_type::OrderRef order_ref)
     {
         std::string log;
@@ -171,17 +200,13 @@ namespace rk
             log = "trading stopped! order cancel failed";
             pass = false;
         }
+        // 越界时不取委托判断是否已结束
         if (order_ref >= _trade_info->_order_data.size())
         {
             log = std::format("order ref {} not found!", order_ref);
             pass = false;
         }
-        if (_risk_indicators->daily_cancel_num + 1 > _thresholds->daily_cancel_num)
-        {
-            log = std::format("order ref {} daily cancel num({}) exceed max num({})!", order_ref, _risk_indicators->daily_cancel_num + 1, _thresholds->daily_cancel_num);
-            pass = false;
-        }
-        if (
+        else if (
             const auto& order = _trade_info->_order_data[order_ref];
             order.is_finished()
         )
@@ -189,46 +214,53 @@ namespace rk
             log = std::format("order ref {} order finished!", order_ref);
             pass = false;
         }
+        if (_order_rate_limiter.available() == 0)
+        {
+            log = std::format("order ref {} order rate limit exceeded!", order_ref);
+            pass = false;
+        }
+        if (_risk_indicators->daily_cancel_num + 1 > _thresholds->daily_cancel_num)
+        {
+            log = std::format("order ref {} daily cancel num({}) exceed max num({})!", order_ref, _risk_indicators->daily_cancel_num + 1, _thresholds->daily_cancel_num);
+            pass = false;
+        }
         if (!pass)
         {
             log = std::format("{}\n{}", log, order_ref);
             RK_LOG_WARN("{}", log.c_str());
             if (order_ref >= _trade_info->_order_data.size())
             {
-                _db_writer.insert_async(
-                    db::table::logs::table_name,
-                    nullptr,
+                _db_writer.insert_async<db::table::logs>({
                     _market_info->_trading_day,
                     _account_config.account_name,
-                    nullptr, nullptr, nullptr, nullptr,
+                    {},
                     order_ref,
                     "order_cancel",
                     log,
                     "WARN",
-                    util::DateTime::now().strftime(), util::DateTime::now().strftime()
-                );
+                    util::DateTime::now(), util::DateTime::now()
+                });
             }
             else
             {
                 const auto& symbol = _trade_info->_order_data[order_ref].order_req.symbol;
-                _db_writer.insert_async(
-                    db::table::logs::table_name,
-                    nullptr,
+                _db_writer.insert_async<db::table::logs>({
                     _market_info->_trading_day,
                     _account_config.account_name,
-                    symbol.symbol.to_string(),
-                    symbol.trade_symbol.to_string(),
-                    magic_enum::enum_name(symbol.exchange),
-                    magic_enum::enum_name(symbol.product_class),
+                    symbol,
                     order_ref,
                     "order_cancel",
                     log,
                     "WARN",
-                    util::DateTime::now().strftime(), util::DateTime::now().strftime()
-                );
+                    util::DateTime::now(), util::DateTime::now()
+                });
             }
         }
-        else ++(_risk_indicators->daily_cancel_num);
+        else
+        {
+            ++(_risk_indicators->daily_cancel_num);
+            _order_rate_limiter.try_acquire();
+        }
         return pass;
     }
     bool RiskControl::check_handle_tick(const data_type::TickData& data)
@@ -1,8 +1,10 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include "data_type.h"
 #include "config_type.h"
 #include "util/db.h"
+#include "util/rate_limiter.h"
 namespace rk
 {
     struct TradeInfo;
@@ -12,7 +14,7 @@ namespace rk
     {
     public:
         RiskControl(
-            const bool& is_trading,
+            const std::atomic<bool>& is_trading,
             const config_type::AccountConfig& account_config,
             const config_type::RiskControlConfig& risk_control_config,
             db::Executor& db_writer
@@ -22,6 +24,8 @@ namespace rk
 
         bool check_order_insert(const data_type::OrderReq& req);
         bool check_order_cancel(data_type::OrderRef order_ref);
+        // 流控剩余可报撤笔数, 不限流为SIZE_MAX
+        [[nodiscard]] size_t order_quota();
 
         bool check_handle_tick(const data_type::TickData& data);
         bool check_handle_bar(const data_type::BarData& data);
@@ -30,12 +34,16 @@ namespace rk
         bool check_handle_error(const data_type::OrderError& data);
 
     private:
-        const bool& _is_trading;
+        [[nodiscard]] uint32_t closable_volume(const data_type::OrderReq& req) const;
+
+        const std::atomic<bool>& _is_trading;
         std::shared_ptr<const TradeInfo> _trade_info = std::make_shared<const TradeInfo>();
         std::shared_ptr<const MarketInfo> _market_info = std::make_shared<const MarketInfo>();
         std::shared_ptr<RiskIndicators> _risk_indicators;
         const config_type::AccountConfig& _account_config;
         std::unique_ptr<RiskIndicators> _thresholds;
+        util::RateLimiter _order_rate_limiter;
+        std::unordered_map<data_type::OrderReq, int> _order_req_count;     // 重复报单检测
         db::Executor& _db_writer;
     };
 
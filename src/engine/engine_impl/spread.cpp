@@ -0,0 +1,359 @@
+//
+// Created by root on 2026/10/19.
+//
+#include "spread.h"
+#include <algorithm>
+#include <limits>
+#include <magic_enum/magic_enum.hpp>
+#include "engine_impl/engine_impl.h"
+#include "util/logger.h"
+namespace rk
+{
+    namespace
+    {
+        constexpr double price_epsilon = 1e-9;
+    }
+    SpreadManager::SpreadManager(InsertFunc insert_func, CancelFunc cancel_func, TickCallback on_tick, OrderCallback on_order)
+        :   _insert_func(std::move(insert_func)), _cancel_func(std::move(cancel_func)), _on_tick(std::move(on_tick)), _on_order(std::move(on_order))
+    {
+
+    }
+    std::optional<data_type::SpreadId> SpreadManager::add_spread(
+        uint32_t strategy_id,
+        const data_type::SpreadDetail& detail,
+        const MarketInfo& market_info,
+        const std::unordered_set<data_type::Symbol>& subscribed_symbols
+    )
+    {
+        if (detail.legs.size() < 2)
+        {
+            RK_LOG_WARN("spread {} leg num {} less than 2", detail.spread_name.c_str(), detail.legs.size());
+            return std::nullopt;
+        }
+        Spread spread{strategy_id, detail.spread_name};
+        spread.legs.reserve(detail.legs.size());
+        for (const auto& [symbol, ratio] : detail.legs)
+        {
+            const auto it = market_info._symbol_details.find(symbol);
+            if (it == market_info._symbol_details.end() || !it->second || !subscribed_symbols.contains(symbol) || ratio == 0)
+            {
+                RK_LOG_WARN("spread {} leg {} unsubscribed or ratio 0", detail.spread_name.c_str(), symbol.symbol.c_str());
+                return std::nullopt;
+            }
+            const auto& symbol_detail = *it->second;
+            auto& leg = spread.legs.emplace_back();
+            leg.symbol = it->first;
+            leg.ratio = ratio;
+            leg.price_tick = symbol_detail.price_tick;
+            leg.upper_limit_price = symbol_detail.upper_limit_price;
+            leg.lower_limit_price = symbol_detail.lower_limit_price;
+        }
+        const auto spread_id = static_cast<data_type::SpreadId>(_spreads.size());
+        spread.missing = static_cast<uint32_t>(spread.legs.size());
+        spread.tick.spread_id = spread_id;
+        auto& added = _spreads.emplace_back(std::move(spread));
+        for (uint32_t leg_id = 0; leg_id < added.legs.size(); ++leg_id)
+        {
+            auto& leg = added.legs[leg_id];
+            _leg_index[leg.symbol].emplace_back(spread_id, leg_id);
+            // 以已收到的最新行情初始化盘口
+            const auto tick_it = market_info._last_tick_data.find(leg.symbol);
+            if (tick_it != market_info._last_tick_data.end() && tick_it->second && tick_it->second->last_price > 0.) update_leg(added, leg, *tick_it->second);
+        }
+        RK_LOG_INFO("spread {} {} added, leg num {}", spread_id, added.spread_name.c_str(), added.legs.size());
+        return spread_id;
+    }
+    std::optional<uint32_t> SpreadManager::insert(uint32_t strategy_id, const data_type::SpreadOrderReq& req)
+    {
+        if (
+            req.spread_id >= _spreads.size() || _spreads[req.spread_id].strategy_id != strategy_id ||
+            req.volume == 0 || (req.direction != data_type::Direction::LONG && req.direction != data_type::Direction::SHORT)
+        )
+        {
+            RK_LOG_WARN("strategy {} spread order illegal, {}", strategy_id, data_type::to_json(data_type::SpreadOrderData{0, req}).dump().c_str());
+            return std::nullopt;
+        }
+        auto& spread = _spreads[req.spread_id];
+        const auto spread_order_id = static_cast<uint32_t>(_orders.size());
+        auto& order = _orders.emplace_back();
+        order.strategy_id = strategy_id;
+        order.data = {spread_order_id, req, data_type::SpreadOrderStatus::WORKING};
+        order.data.update_time = util::DateTime::now();
+        order.legs.resize(spread.legs.size());
+        // 主动腿取对手盘按比例折算后最薄的腿, 对冲腿在流动性较好的一侧
+        auto min_units = std::numeric_limits<int64_t>::max();
+        for (uint32_t leg_id = 0; leg_id < spread.legs.size(); ++leg_id)
+        {
+            const auto& leg = spread.legs[leg_id];
+            const auto units = (leg_buy(leg, req.direction) ? leg.ask_volume : leg.bid_volume) / leg.abs_ratio();
+            if (units >= min_units) continue;
+            min_units = units;
+            order.active_leg = leg_id;
+        }
+        spread.orders.push_back(spread_order_id);
+        RK_LOG_INFO(
+            "spread order {} {} {} volume {} limit price {} active leg {}",
+            spread_order_id, spread.spread_name.c_str(), magic_enum::enum_name(req.direction), req.volume, req.limit_price,
+            spread.legs[order.active_leg].symbol.symbol.c_str()
+        );
+        process(order, spread);
+        return spread_order_id;
+    }
+    bool SpreadManager::cancel(uint32_t strategy_id, uint32_t spread_order_id)
+    {
+        if (spread_order_id >= _orders.size() || _orders[spread_order_id].strategy_id != strategy_id)
+        {
+            RK_LOG_WARN("strategy {} spread order {} not found, cancel failed", strategy_id, spread_order_id);
+            return false;
+        }
+        auto& order = _orders[spread_order_id];
+        if (order.cancel_requested || order.data.is_finished()) return false;
+        order.cancel_requested = true;
+        auto& spread = _spreads[order.data.req.spread_id];
+        process(order, spread);
+        refresh(order, spread);
+        return true;
+    }
+    void SpreadManager::handle_tick(const data_type::TickData& data)
+    {
+        const auto it = _leg_index.find(data.symbol);
+        if (it == _leg_index.end()) return;
+        // 回调中新增价差会使索引扩容, 按下标遍历进入时的腿并每次重新查找
+        const auto leg_num = it->second.size();
+        for (size_t leg_pos = 0; leg_pos < leg_num; ++leg_pos)
+        {
+            const auto [spread_id, leg_id] = _leg_index.find(data.symbol)->second[leg_pos];
+            auto& spread = _spreads[spread_id];
+            update_leg(spread, spread.legs[leg_id], data);
+            if (spread.missing > 0) continue;
+            if (_on_tick) _on_tick(spread.strategy_id, spread.tick);
+            // 回调中可能新增价差订单, 按下标遍历; 同步拒单达到上限的订单在此刷新状态, 结束时会移出列表
+            for (size_t i = 0; i < spread.orders.size();)
+            {
+                auto& order = _orders[spread.orders[i]];
+                process(order, spread);
+                if (order.failed && order.data.status != data_type::SpreadOrderStatus::CANCELING) refresh(order, spread);
+                if (!order.data.is_finished()) ++i;
+            }
+        }
+    }
+    void SpreadManager::handle_trade(uint32_t spread_order_id, uint32_t leg_id, const data_type::TradeData& data)
+    {
+        auto& order = _orders[spread_order_id];
+        auto& spread = _spreads[order.data.req.spread_id];
+        release(order, data.order_ref, data.trade_volume, false);
+        auto& leg_order = order.legs[leg_id];
+        leg_order.traded += data.trade_volume;
+        leg_order.traded_amount += data.trade_price * data.trade_volume;
+        leg_order.rejected = 0;
+        // 主动腿成交立即对冲
+        if (leg_id == order.active_leg) hedge(order, spread);
+        refresh(order, spread);
+    }
+    void SpreadManager::handle_cancel(uint32_t spread_order_id, uint32_t leg_id, const data_type::CancelData& data)
+    {
+        auto& order = _orders[spread_order_id];
+        release(order, data.order_ref, data.cancel_volume, false);
+        refresh(order, _spreads[order.data.req.spread_id]);
+    }
+    void SpreadManager::handle_error(uint32_t spread_order_id, uint32_t leg_id, const data_type::OrderError& data)
+    {
+        auto& order = _orders[spread_order_id];
+        // 撤单失败, 下一笔行情重新判断是否撤主动腿
+        if (data.error_type == data_type::ErrorType::ORDER_CANCEL_ERROR)
+        {
+            if (leg_id == order.active_leg) order.active_canceling = false;
+            return;
+        }
+        auto& spread = _spreads[order.data.req.spread_id];
+        release(order, data.order_ref, 0, true);
+        leg_rejected(order, spread, leg_id);
+        refresh(order, spread);
+    }
+    void SpreadManager::update_leg(Spread& spread, Leg& leg, const data_type::TickData& tick)
+    {
+        const auto priced = leg.priced();
+        if (priced)
+        {
+            spread.bid_sum -= leg.bid_contribution();
+            spread.ask_sum -= leg.ask_contribution();
+        }
+        leg.bid_price = tick.bid_price[0];
+        leg.ask_price = tick.ask_price[0];
+        leg.bid_volume = tick.bid_volume[0];
+        leg.ask_volume = tick.ask_volume[0];
+        if (tick.upper_limit_price > 0 && tick.upper_limit_price < std::numeric_limits<double>::max()) leg.upper_limit_price = tick.upper_limit_price;
+        if (tick.lower_limit_price > 0) leg.lower_limit_price = tick.lower_limit_price;
+        if (leg.priced())
+        {
+            spread.bid_sum += leg.bid_contribution();
+            spread.ask_sum += leg.ask_contribution();
+        }
+        if (priced && !leg.priced()) ++spread.missing;
+        else if (!priced && leg.priced()) --spread.missing;
+        if (spread.missing > 0) return;
+        // 价格增量累加, 可成交组合数取各腿按比例折算后的最小值
+        auto& spread_tick = spread.tick;
+        spread_tick.update_time = tick.update_time;
+        spread_tick.bid_price = spread.bid_sum;
+        spread_tick.ask_price = spread.ask_sum;
+        auto bid_volume = std::numeric_limits<int64_t>::max();
+        auto ask_volume = std::numeric_limits<int64_t>::max();
+        for (const auto& spread_leg : spread.legs)
+        {
+            const auto ratio = static_cast<int64_t>(spread_leg.abs_ratio());
+            bid_volume = std::min(bid_volume, (spread_leg.ratio > 0 ? spread_leg.bid_volume : spread_leg.ask_volume) / ratio);
+            ask_volume = std::min(ask_volume, (spread_leg.ratio > 0 ? spread_leg.ask_volume : spread_leg.bid_volume) / ratio);
+        }
+        spread_tick.bid_volume = static_cast<uint32_t>(std::max<int64_t>(bid_volume, 0));
+        spread_tick.ask_volume = static_cast<uint32_t>(std::max<int64_t>(ask_volume, 0));
+    }
+    bool SpreadManager::spread_crossed(const Spread& spread, const data_type::SpreadOrderReq& req) const
+    {
+        if (spread.missing > 0) return false;
+        if (req.direction == data_type::Direction::LONG) return spread.tick.ask_price <= req.limit_price + price_epsilon;
+        return spread.tick.bid_price >= req.limit_price - price_epsilon;
+    }
+    void SpreadManager::process(SpreadOrder& order, Spread& spread)
+    {
+        if (order.data.is_finished() || order.failed) return;
+        if (order.legs[order.active_leg].working == 0) send_active(order, spread);
+        else if (!order.active_canceling && (order.cancel_requested || !spread_crossed(spread, order.data.req)))
+        {
+            for (const auto& working_order : order.working_orders)
+            {
+                if (working_order.leg_id == order.active_leg && _cancel_func(working_order.order_ref)) order.active_canceling = true;
+            }
+        }
+        hedge(order, spread);
+    }
+    void SpreadManager::send_active(SpreadOrder& order, Spread& spread)
+    {
+        const auto& req = order.data.req;
+        if (order.cancel_requested || hedge_pending(order, spread) || !spread_crossed(spread, req)) return;
+        const auto& leg = spread.legs[order.active_leg];
+        const auto& leg_order = order.legs[order.active_leg];
+        const auto target = req.volume * leg.abs_ratio();
+        if (leg_order.traded >= target) return;
+        if (leg_order.rejected > 0 && util::DateTime::now() < leg_order.retry_time) return;
+        const auto units = req.direction == data_type::Direction::LONG ? spread.tick.ask_volume : spread.tick.bid_volume;
+        const auto volume = std::min(target - leg_order.traded, units * leg.abs_ratio());
+        if (volume == 0) return;
+        const auto price = leg_buy(leg, req.direction) ? leg.ask_price : leg.bid_price;
+        if (!send(order, spread, order.active_leg, price, volume)) leg_rejected(order, spread, order.active_leg);
+    }
+    void SpreadManager::hedge(SpreadOrder& order, Spread& spread)
+    {
+        if (order.failed || order.data.is_finished()) return;
+        const auto& req = order.data.req;
+        const auto& active_leg = spread.legs[order.active_leg];
+        const auto active_traded = static_cast<uint64_t>(order.legs[order.active_leg].traded);
+        for (uint32_t leg_id = 0; leg_id < spread.legs.size(); ++leg_id)
+        {
+            if (leg_id == order.active_leg) continue;
+            const auto& leg = spread.legs[leg_id];
+            const auto& leg_order = order.legs[leg_id];
+            const auto target = static_cast<uint32_t>(active_traded * leg.abs_ratio() / active_leg.abs_ratio());
+            const auto done = leg_order.traded + leg_order.working;
+            if (target <= done || !leg.priced()) continue;
+            if (leg_order.rejected > 0 && util::DateTime::now() < leg_order.retry_time) continue;
+            // 对冲腿超价报单, 不超过涨跌停
+            const auto slippage = req.hedge_slippage * leg.price_tick;
+            const auto price = leg_buy(leg, req.direction) ?
+                std::min(leg.ask_price + slippage, leg.upper_limit_price) :
+                std::max(leg.bid_price - slippage, leg.lower_limit_price);
+            if (!send(order, spread, leg_id, price, target - done)) leg_rejected(order, spread, leg_id);
+            if (order.failed) return;
+        }
+    }
+    void SpreadManager::leg_rejected(SpreadOrder& order, const Spread& spread, uint32_t leg_id)
+    {
+        auto& leg_order = order.legs[leg_id];
+        ++leg_order.rejected;
+        leg_order.retry_time = util::DateTime::now() + util::TimeDelta(leg_retry_interval * leg_order.rejected);
+        if (leg_order.rejected < max_leg_reject_num || order.failed) return;
+        order.failed = true;
+        RK_LOG_ERROR(
+            "spread order {} {} {} leg {} rejected {} times, spread order stopped",
+            order.data.spread_order_id, spread.spread_name.c_str(), leg_id == order.active_leg ? "active" : "hedge", spread.legs[leg_id].symbol.symbol.c_str(), leg_order.rejected
+        );
+        for (const auto& working_order : order.working_orders) _cancel_func(working_order.order_ref);
+    }
+    bool SpreadManager::hedge_pending(const SpreadOrder& order, const Spread& spread) const
+    {
+        const auto& active_leg = spread.legs[order.active_leg];
+        const auto active_traded = static_cast<uint64_t>(order.legs[order.active_leg].traded);
+        for (uint32_t leg_id = 0; leg_id < spread.legs.size(); ++leg_id)
+        {
+            if (leg_id == order.active_leg) continue;
+            const auto target = active_traded * spread.legs[leg_id].abs_ratio() / active_leg.abs_ratio();
+            if (order.legs[leg_id].traded < target) return true;
+        }
+        return false;
+    }
+    bool SpreadManager::send(SpreadOrder& order, const Spread& spread, uint32_t leg_id, double price, uint32_t volume)
+    {
+        const auto& leg = spread.legs[leg_id];
+        const data_type::OrderReq req{
+            leg.symbol,
+            price,
+            volume,
+            leg_buy(leg, order.data.req.direction) ? data_type::Direction::LONG : data_type::Direction::SHORT,
+            order.data.req.offset
+        };
+        const auto order_ref = _insert_func(req, order.data.spread_order_id, leg_id);
+        if (!order_ref) return false;
+        order.working_orders.push_back({*order_ref, leg_id, volume});
+        order.legs[leg_id].working += volume;
+        return true;
+    }
+    void SpreadManager::release(SpreadOrder& order, data_type::OrderRef order_ref, uint32_t volume, bool all)
+    {
+        const auto it = std::find_if(
+            order.working_orders.begin(), order.working_orders.end(),
+            [order_ref](const WorkingOrder& working_order) {return working_order.order_ref == order_ref;}
+        );
+        if (it == order.working_orders.end()) return;
+        const auto released = all ? it->remain : std::min(volume, it->remain);
+        it->remain -= released;
+        order.legs[it->leg_id].working -= released;
+        if (it->leg_id == order.active_leg && order.legs[it->leg_id].working == 0) order.active_canceling = false;
+        if (it->remain == 0) order.working_orders.erase(it);
+    }
+    void SpreadManager::refresh(SpreadOrder& order, Spread& spread)
+    {
+        if (order.data.is_finished()) return;
+        auto& data = order.data;
+        auto units = std::numeric_limits<uint32_t>::max();
+        double traded_price = 0.;
+        bool working = false;
+        for (uint32_t leg_id = 0; leg_id < spread.legs.size(); ++leg_id)
+        {
+            const auto& leg = spread.legs[leg_id];
+            const auto& leg_order = order.legs[leg_id];
+            units = std::min(units, leg_order.traded / leg.abs_ratio());
+            if (leg_order.traded > 0) traded_price += leg.ratio * leg_order.traded_amount / leg_order.traded;
+            working |= leg_order.working > 0;
+        }
+        data.traded_volume = units;
+        data.traded_price = units > 0 ? traded_price : 0.;
+        data.update_time = util::DateTime::now();
+        // 拒单失败后等在途腿单撤完再结束
+        if (order.failed) data.status = working ? data_type::SpreadOrderStatus::CANCELING : data_type::SpreadOrderStatus::HEDGE_FAILED;
+        else if (units >= data.req.volume && !working) data.status = data_type::SpreadOrderStatus::FINISHED;
+        else if (order.cancel_requested)
+        {
+            data.status = !working && !hedge_pending(order, spread) ? data_type::SpreadOrderStatus::CANCELED : data_type::SpreadOrderStatus::CANCELING;
+        }
+        else data.status = data_type::SpreadOrderStatus::WORKING;
+        if (data.is_finished())
+        {
+            std::erase(spread.orders, data.spread_order_id);
+            RK_LOG_INFO(
+                "spread order {} {} {}, traded {}/{} price {}",
+                data.spread_order_id, spread.spread_name.c_str(), magic_enum::enum_name(data.status), data.traded_volume, data.req.volume, data.traded_price
+            );
+        }
+        if (_on_order) _on_order(order.strategy_id, data);
+    }
+};
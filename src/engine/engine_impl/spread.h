@@ -0,0 +1,142 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+#include "data_type.h"
+#include "util/flat_map.h"
+
+namespace rk
+{
+    /// 多腿价差组合下单(期货)
+    /// 合成价差盘口由腿行情增量维护: 腿一档价格变化只把差值乘比例累加到所属价差
+    /// 价差订单按腿下单: 下单时选盘口最薄的腿为主动腿, 价差满足限价时以对手价报主动腿, 主动腿成交即按比例以超价对冲其余腿
+    /// 价差不再满足限价时撤主动腿; 对冲腿撤单后在该腿下一笔行情重新对冲, 主动腿和对冲腿拒单均按次数退避重试, 任一腿连续拒单超过上限撤销在途腿单并置HEDGE_FAILED
+    /// 均在引擎线程行情/回报处理中直接执行, 不经过额外队列; 回调中可以下单撤单和新增价差
+    struct MarketInfo;
+    class SpreadManager
+    {
+    public:
+        using InsertFunc = std::function<std::optional<data_type::OrderRef>(const data_type::OrderReq& req, uint32_t spread_order_id, uint32_t leg_id)>;
+        using CancelFunc = std::function<bool(data_type::OrderRef order_ref)>;
+        using TickCallback = std::function<void(uint32_t strategy_id, const data_type::SpreadTick& tick)>;
+        using OrderCallback = std::function<void(uint32_t strategy_id, const data_type::SpreadOrderData& data)>;
+
+        SpreadManager(InsertFunc insert_func, CancelFunc cancel_func, TickCallback on_tick, OrderCallback on_order);
+        ~SpreadManager() = default;
+        SpreadManager(const SpreadManager&) = delete;
+        SpreadManager& operator=(const SpreadManager&) = delete;
+
+        // 各腿合约需已订阅行情
+        // 各腿合约需已向柜台订阅行情(subscribed_symbols)
+        std::optional<data_type::SpreadId> add_spread(
+            uint32_t strategy_id,
+            const data_type::SpreadDetail& detail,
+            const MarketInfo& market_info,
+            const std::unordered_set<data_type::Symbol>& subscribed_symbols
+        );
+        std::optional<uint32_t> insert(uint32_t strategy_id, const data_type::SpreadOrderReq& req);
+        // 撤主动腿, 已成交部分继续对冲
+        bool cancel(uint32_t strategy_id, uint32_t spread_order_id);
+
+        void handle_tick(const data_type::TickData& data);
+        void handle_trade(uint32_t spread_order_id, uint32_t leg_id, const data_type::TradeData& data);
+        void handle_cancel(uint32_t spread_order_id, uint32_t leg_id, const data_type::CancelData& data);
+        void handle_error(uint32_t spread_order_id, uint32_t leg_id, const data_type::OrderError& data);
+
+        [[nodiscard]] const data_type::SpreadTick* spread_tick(data_type::SpreadId spread_id) const
+        {
+            if (spread_id >= _spreads.size() || _spreads[spread_id].missing > 0) return nullptr;
+            return &_spreads[spread_id].tick;
+        }
+        [[nodiscard]] data_type::SpreadId spread_id(uint32_t spread_order_id) const {return _orders[spread_order_id].data.req.spread_id;}
+        [[nodiscard]] uint32_t strategy_id(uint32_t spread_order_id) const {return _orders[spread_order_id].strategy_id;}
+
+    private:
+        struct Leg
+        {
+            data_type::Symbol symbol;
+            int32_t ratio = 0;
+            double price_tick = 0.;
+            double bid_price = 0.;
+            double ask_price = 0.;
+            int64_t bid_volume = 0;
+            int64_t ask_volume = 0;
+            double upper_limit_price = 0.;
+            double lower_limit_price = 0.;
+            [[nodiscard]] bool priced() const {return bid_price > 0 && ask_price > 0;}
+            [[nodiscard]] uint32_t abs_ratio() const {return static_cast<uint32_t>(ratio > 0 ? ratio : -ratio);}
+            // 买入组合时该腿对价差买价/卖价的贡献
+            [[nodiscard]] double bid_contribution() const {return ratio * (ratio > 0 ? bid_price : ask_price);}
+            [[nodiscard]] double ask_contribution() const {return ratio * (ratio > 0 ? ask_price : bid_price);}
+        };
+        struct Spread
+        {
+            uint32_t strategy_id = 0;
+            util::FixedString<32> spread_name;
+            std::vector<Leg> legs;
+            double bid_sum = 0.;                // 有价格的腿的贡献之和
+            double ask_sum = 0.;
+            uint32_t missing = 0;               // 无盘口的腿数
+            data_type::SpreadTick tick;
+            std::vector<uint32_t> orders;       // 未结束的价差订单
+        };
+        struct WorkingOrder
+        {
+            data_type::OrderRef order_ref = 0;
+            uint32_t leg_id = 0;
+            uint32_t remain = 0;
+        };
+        struct LegOrder
+        {
+            uint32_t traded = 0;
+            uint32_t working = 0;
+            double traded_amount = 0.;
+            uint32_t rejected = 0;              // 该腿连续拒单次数, 成交后清零
+            util::DateTime retry_time;          // 拒单后下次报单时间
+        };
+        struct SpreadOrder
+        {
+            uint32_t strategy_id = 0;
+            data_type::SpreadOrderData data;
+            std::vector<LegOrder> legs;
+            std::vector<WorkingOrder> working_orders;
+            uint32_t active_leg = 0;
+            bool active_canceling = false;
+            bool cancel_requested = false;
+            bool failed = false;                // 腿连续拒单超过上限
+        };
+        static constexpr uint32_t max_leg_reject_num = 5;
+        static constexpr auto leg_retry_interval = std::chrono::milliseconds(500);     // 按连续拒单次数线性退避
+        // 该腿在买入/卖出组合时是否买入
+        static bool leg_buy(const Leg& leg, data_type::Direction direction)
+        {
+            return (direction == data_type::Direction::LONG) == (leg.ratio > 0);
+        }
+        // 增量更新腿对价差盘口的贡献
+        static void update_leg(Spread& spread, Leg& leg, const data_type::TickData& tick);
+        [[nodiscard]] bool spread_crossed(const Spread& spread, const data_type::SpreadOrderReq& req) const;
+        void process(SpreadOrder& order, Spread& spread);
+        void send_active(SpreadOrder& order, Spread& spread);
+        void hedge(SpreadOrder& order, Spread& spread);
+        [[nodiscard]] bool hedge_pending(const SpreadOrder& order, const Spread& spread) const;
+        bool send(SpreadOrder& order, const Spread& spread, uint32_t leg_id, double price, uint32_t volume);
+        void leg_rejected(SpreadOrder& order, const Spread& spread, uint32_t leg_id);
+        // 回报扣减在途数量, all为整笔失效
+        void release(SpreadOrder& order, data_type::OrderRef order_ref, uint32_t volume, bool all);
+        void refresh(SpreadOrder& order, Spread& spread);
+
+        InsertFunc _insert_func;
+        CancelFunc _cancel_func;
+        TickCallback _on_tick;
+        OrderCallback _on_order;
+        std::deque<Spread> _spreads;                        // 按SpreadId索引, 回调中下单不使引用失效
+        std::deque<SpreadOrder> _orders;                    // 按价差订单号索引
+        util::FlatMap<data_type::Symbol, std::vector<std::pair<data_type::SpreadId, uint32_t>>> _leg_index;     // 腿合约 -> (价差, 腿序号)
+    };
+};
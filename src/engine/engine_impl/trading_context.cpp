@@ -2,8 +2,8 @@
 #include <utility>
 namespace rk
 {
-    TradingContext::TradingContext()
-        :   _trade_handlers(1000)
+    TradingContext::TradingContext(size_t order_capacity)
+        :   _trade_handlers(order_capacity)
     {
 
     }
@@ -13,16 +13,16 @@ namespace rk
     }
     void TradingContext::order_insert(TradeHandler handler, data_type::OrderRef order_ref)
     {
+        if (order_ref >= _trade_handlers.size()) _trade_handlers.resize(order_ref + 1);
         _trade_handlers[order_ref] = std::move(handler);
     }
     void TradingContext::handle_tick(const data_type::TickData& data)
     {
-        auto range = _market_handlers.equal_range(data.symbol);
-        for (auto it = range.first; it != range.second; ++it)
+        for (const auto& handler : _market_handlers.equal_range(data.symbol))
         {
-            if ((it->second).on_tick != nullptr)
+            if (handler.on_tick != nullptr)
             {
-                (it->second).on_tick(data);
+                handler.on_tick(data);
             }
         }
     }
@@ -32,21 +32,21 @@ namespace rk
     }
     void TradingContext::handle_trade(const data_type::TradeData& data)
     {
-        if (_trade_handlers[data.order_ref].on_trade != nullptr)
+        if (data.order_ref < _trade_handlers.size() && _trade_handlers[data.order_ref].on_trade != nullptr)
         {
             _trade_handlers[data.order_ref].on_trade(data);
         }
     }
     void TradingContext::handle_cancel(const data_type::CancelData& data)
     {
-        if (_trade_handlers[data.order_ref].on_cancel != nullptr)
+        if (data.order_ref < _trade_handlers.size() && _trade_handlers[data.order_ref].on_cancel != nullptr)
         {
             _trade_handlers[data.order_ref].on_cancel(data);
         }
     }
     void TradingContext::handle_error(const data_type::OrderError& data)
     {
-        if (_trade_handlers[data.order_ref].on_error != nullptr)
+        if (data.order_ref < _trade_handlers.size() && _trade_handlers[data.order_ref].on_error != nullptr)
         {
             _trade_handlers[data.order_ref].on_error(data);
         }
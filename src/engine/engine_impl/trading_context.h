@@ -3,6 +3,8 @@
 #include <unordered_set>
 #include "adapter/adapter.h"
 #include "data_type.h"
+#include "util/flat_map.h"
+#include "util/paged_vector.h"
 
 
 namespace rk
@@ -22,7 +24,7 @@ namespace rk
     class TradingContext
     {
     public:
-        TradingContext();
+        explicit TradingContext(size_t order_capacity);
         ~TradingContext() = default;
         TradingContext(const TradingContext&) = delete;
         TradingContext& operator=(const TradingContext&) = delete;
@@ -38,8 +40,8 @@ namespace rk
         void handle_error(const data_type::OrderError& data);
 
         // handlers
-        std::unordered_multimap<data_type::Symbol, MarketHandler> _market_handlers;
-        std::vector<TradeHandler> _trade_handlers;
+        util::FlatMultiMap<data_type::Symbol, MarketHandler> _market_handlers;
+        util::PagedVector<TradeHandler> _trade_handlers;      // 按OrderRef索引
 
     };
 
@@ -15,6 +15,7 @@ namespace rk::event
         EVENT_CANCEL_DATA,
         EVENT_ORDER_ERROR,
         EVENT_ALGO_REQ,
+        EVENT_RECONCILE,
         UNKNOWN
     };
     struct Event
@@ -40,12 +41,13 @@ namespace rk::event
         {
             _mpsc_queue.enqueue(Event(event_type, std::move(data)));
         }
-        void handle_event()
+        // 每轮批量取出事件, 组合子单的成交回报不再按轮询间隔逐个处理
+        size_t handle_event()
         {
-            Event event;
-            bool updated = _mpsc_queue.try_dequeue(event);
-            if (updated)
+            const auto num = _mpsc_queue.try_dequeue_bulk(_events.begin(), _events.size());
+            for (size_t i = 0; i < num; ++i)
             {
+                auto& event = _events[i];
                 for (
                     const auto& event_handler :
                     _event_handlers[static_cast<uint8_t>(event.event_type)]
@@ -53,12 +55,15 @@ namespace rk::event
                 {
                     event_handler(event.data);
                 }
+                event.data.reset();
             }
-
+            return num;
         }
 
     private:
+        static constexpr size_t batch_size = 256;
         std::vector<std::vector<std::function<void(std::any&)>>> _event_handlers;
+        std::vector<Event> _events = std::vector<Event>(batch_size);
         moodycamel::ConcurrentQueue<Event> _mpsc_queue;
     };
 };
\ No newline at end of file
@@ -10,6 +10,16 @@ namespace rk::gateway
     MDGateway::MDGateway(config_type::MDGatewayConfig config)
     :
     _config{std::move(config)},
+    _order_book{
+        _config.order_book_config.shard_num > 0 ?
+        std::make_unique<util::ShardedOrderBookEngine>(
+            _config.order_book_config.shard_num,
+            _config.order_book_config.queue_capacity,
+            _config.order_book_config.depth,
+            std::chrono::milliseconds(_config.order_book_config.snapshot_interval_ms),
+            _config.order_book_config.shard_cpu_id
+        ) : nullptr
+    },
     _adapter{
         adapter::create_md_adapter(
             {
@@ -17,12 +27,26 @@ namespace rk::gateway
                 {
                     _tick_data_queue.enqueue(data);
                 },
-                [] (){}
+                [] (){},
+                // 订单簿在Level2组播接收启动前就绪, 全市场逐笔都进入订单簿
+                [this] (data_type::L2OrderData&& data)
+                {
+                    if (_order_book) _order_book->on_order(data);
+                },
+                [this] (data_type::L2TradeData&& data)
+                {
+                    if (_order_book) _order_book->on_trade(data);
+                },
+                [this] (data_type::L2SnapshotData&& data)
+                {
+                    if (_order_book) _order_book->on_snapshot(data);
+                }
             },
             _config.md_adapter_config
         )
     },
     _tick_data_queue{100},
+    _iopv{_config.iopv ? std::make_unique<util::IOPVCalculator>() : nullptr},
     _busy_worker(
         [this] (const std::stop_token& stop_token) { working_loop(stop_token); }
     )
@@ -43,6 +67,8 @@ namespace rk::gateway
             RK_LOG_ERROR("query symbol detail failed!");
             return false;
         }
+        _symbol_detail.reserve(symbol_detail.value().size());
+        _subscribe_reference.reserve(symbol_detail.value().size());
         for (const auto& [symbol, detail] : symbol_detail.value())
         {
             if (
@@ -55,12 +81,55 @@ namespace rk::gateway
                 continue;
             _symbol_detail.emplace(symbol, detail);
         }
+        if (_iopv)
+        {
+            RK_LOG_INFO("query etf detail...");
+            auto etf_detail = _adapter->query_etf_detail();
+            if (!etf_detail)
+            {
+                RK_LOG_ERROR("query etf detail failed!");
+                return false;
+            }
+            _iopv->reset(symbol_detail.value(), etf_detail.value());
+            for (const auto& [etf, detail] : etf_detail.value())
+            {
+                for (const auto& component : detail->component)
+                {
+                    if (component.replace_type == data_type::CashReplaceType::MUST || !symbol_detail->contains(component.symbol)) continue;
+                    _iopv_component.emplace(component.symbol);
+                }
+            }
+            // 行情在成分股订阅后才推送, 此前消费者线程不会访问IOPV
+            if (!_iopv_component.empty() && !_adapter->subscribe(_iopv_component))
+            {
+                RK_LOG_ERROR("subscribe iopv component failed!");
+                return false;
+            }
+            RK_LOG_INFO("iopv {} etf {} component subscribed", _iopv->etf_num(), _iopv_component.size());
+        }
+        if (_order_book)
+        {
+            const auto& name = _config.order_book_config.last_value_store;
+            if (!name.empty())
+            {
+                _last_value_store = std::make_unique<util::LastValueStore<data_type::TickData>>(name, _symbol_detail.size());
+                if (!_last_value_store->is_open()) RK_LOG_ERROR("open last value store {} failed!", name);
+            }
+            _order_book->start(_symbol_detail, _last_value_store && _last_value_store->is_open() ? _last_value_store.get() : nullptr);
+        }
+        // 订单簿分片路由表建好后才启动组播分发线程
+        if (!_adapter->start_l2())
+        {
+            RK_LOG_ERROR("start level2 market data failed!");
+            return false;
+        }
         RK_LOG_INFO("{} num of symbol queried, start trading!", _symbol_detail.size());
         return true;
     }
     void MDGateway::stop_trading()
     {
         _adapter->logout();
+        if (_order_book) _order_book->stop();
     }
     std::tuple<ipc::RspData, ipc::SubscribeRsp> MDGateway::handle_subscribe(std::string client_id, const ipc::SubscribeReq& req)
     {
@@ -70,7 +139,7 @@ namespace rk::gateway
             // 全订阅
             for (const auto& [symbol, _] : _symbol_detail)
             {
-                if (!_subscribe_reference.contains(symbol))
+                if (!_subscribe_reference.contains(symbol) && !_iopv_component.contains(symbol))
                 {
                     add.emplace(symbol);
                 }
@@ -86,7 +155,7 @@ namespace rk::gateway
                     RK_LOG_WARN("client id {} subscribe symbol {} not found", util::to_hex_string(client_id), symbol.symbol.to_string());
                     return {{false, ipc::RPCType::SUBSCRIBE}, {}};
                 }
-                if (!_subscribe_reference.contains(symbol))
+                if (!_subscribe_reference.contains(symbol) && !_iopv_component.contains(symbol))
                 {
                     add.emplace(symbol);
                 }
@@ -113,17 +182,8 @@ namespace rk::gateway
             for (const auto& [symbol, _] : _symbol_detail)
             {
                 if (!_subscribe_reference.contains(symbol)) continue;
-                auto range = _subscribe_reference.equal_range(symbol);
-                for (auto it = range.first; it != range.second; )
-                {
-                    if (it->second == client_id)
-                    {
-                        _subscribe_reference.erase(it);
-                        break;
-                    }
-                    else ++it;
-                }
-                if (!_subscribe_reference.contains(symbol)) add.emplace(symbol);
+                _subscribe_reference.erase(symbol, client_id);
+                if (!_subscribe_reference.contains(symbol) && !_iopv_component.contains(symbol)) add.emplace(symbol);
             }
         }
         else
@@ -136,17 +196,8 @@ namespace rk::gateway
                     return {{false, ipc::RPCType::UNSUBSCRIBE}, {}};
                 }
                 if (!_subscribe_reference.contains(symbol)) continue;
-                auto range = _subscribe_reference.equal_range(symbol);
-                for (auto it = range.first; it != range.second; )
-                {
-                    if (it->second == client_id)
-                    {
-                        _subscribe_reference.erase(it);
-                        break;
-                    }
-                    else ++it;
-                }
-                if (!_subscribe_reference.contains(symbol)) add.emplace(symbol);
+                _subscribe_reference.erase(symbol, client_id);
+                if (!_subscribe_reference.contains(symbol) && !_iopv_component.contains(symbol)) add.emplace(symbol);
             }
         }
         if (!add.empty())
@@ -200,6 +251,28 @@ namespace rk::gateway
         router.set(zmq::sockopt::router_mandatory, 1);
         router.set(zmq::sockopt::sndhwm, 1000);
         router.bind(_config.endpoint);
+        const auto publish_tick = [&](const data_type::TickData& data)
+        {
+            if (!_subscribe_reference.contains(data.symbol)) return;
+            auto ipc_data = ipc::IPCData{ipc::IPCDataType::PUB};
+            auto pub_data_head = ipc::PubData{ipc::PubDataType::TICK_DATA};
+            for (const auto& zmq_client_id : _subscribe_reference.equal_range(data.symbol))
+            {
+                try
+                {
+                    router.send(zmq::message_t{zmq_client_id.data(), zmq_client_id.size()}, zmq::send_flags::sndmore);
+                    router.send(zmq::message_t{&ipc_data, sizeof(ipc_data)}, zmq::send_flags::sndmore);
+                    router.send(zmq::message_t{&pub_data_head, sizeof(pub_data_head)}, zmq::send_flags::sndmore);
+                    router.send(zmq::message_t{&data, sizeof(data)}, zmq::send_flags::dontwait);
+                }
+                catch (const zmq::error_t& zmq_error)
+                {
+                    RK_LOG_WARN("client id {} error {}", zmq_client_id, zmq_error.what());
+                    handle_unsubscribe(zmq_client_id, {});
+                    break;
+                }
+            }
+        };
         while (!stop_token.stop_requested())
         {
             zmq::pollitem_t items[] = {{router.handle(), 0, ZMQ_POLLIN, 0}};
@@ -306,28 +379,11 @@ namespace rk::gateway
             data_type::TickData data{};
             while (_tick_data_queue.try_dequeue(data))
             {
-                if (!_subscribe_reference.contains(data.symbol)) continue;
-                auto ipc_data = ipc::IPCData{ipc::IPCDataType::PUB};
-                auto pub_data_head = ipc::PubData{ipc::PubDataType::TICK_DATA};
-                auto range = _subscribe_reference.equal_range(data.symbol);
-                for (auto it = range.first; it != range.second; ++it)
-                {
-                    const auto& zmq_client_id = it->second;
-                    try
-                    {
-                        router.send(zmq::message_t{zmq_client_id.data(), zmq_client_id.size()}, zmq::send_flags::sndmore);
-                        router.send(zmq::message_t{&ipc_data, sizeof(ipc_data)}, zmq::send_flags::sndmore);
-                        router.send(zmq::message_t{&pub_data_head, sizeof(pub_data_head)}, zmq::send_flags::sndmore);
-                        router.send(zmq::message_t{&data, sizeof(data)}, zmq::send_flags::dontwait);
-                    }
-                    catch (const zmq::error_t& zmq_error)
-                    {
-                        RK_LOG_WARN("client id {} error {}", zmq_client_id, zmq_error.what());
-                        handle_unsubscribe(zmq_client_id, {});
-                        break;
-                    }
-                }
+                if (_iopv) _iopv->on_tick(data);
+                publish_tick(data);
             }
+            // 成分股变化引起的ETF参考净值更新
+            if (_iopv) _iopv->flush(publish_tick);
         }
     }
 };
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include "data_type.h"
 #include "config_type.h"
 #include "adapter/adapter.h"
+#include "util/flat_map.h"
+#include "util/iopv.h"
+#include "util/last_value_store.h"
+#include "util/sharded_order_book.h"
 #include <magic_enum/magic_enum.hpp>
 #include <thread>
 #include <readerwriterqueue.h>
@@ -26,13 +30,19 @@ namespace rk::gateway
     private:
         // 配置
         config_type::MDGatewayConfig _config;
+        // Level2订单簿, 先于行情接口构造, 后于行情接口析构; 最新值表在订单簿工作线程停止后析构
+        std::unique_ptr<util::LastValueStore<data_type::TickData>> _last_value_store;
+        std::unique_ptr<util::ShardedOrderBookEngine> _order_book;
         // 生产者
         std::unique_ptr<adapter::MDAdapter> _adapter;
         moodycamel::ReaderWriterQueue<data_type::TickData> _tick_data_queue;
+        // ETF参考净值, 只在消费者线程计算
+        std::unique_ptr<util::IOPVCalculator> _iopv;
+        std::unordered_set<data_type::Symbol> _iopv_component;     // 为计算IOPV订阅的成分股, 客户端退订时保留
         // 消费者
         std::jthread _busy_worker;
-        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_detail;
-        std::unordered_multimap<data_type::Symbol, std::string> _subscribe_reference;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> _symbol_detail;
+        util::FlatMultiMap<data_type::Symbol, std::string> _subscribe_reference;
 
 
 
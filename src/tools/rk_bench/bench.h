@@ -0,0 +1,38 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+
+namespace rk::bench
+{
+    // 阻止编译器把结果优化掉
+    template<typename T>
+    inline void do_not_optimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+    // 运行func iterations次, 输出每次耗时(ns)
+    template<typename Func>
+    double run(std::string_view name, size_t iterations, Func&& func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) func(i);
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const auto per_op = elapsed / static_cast<double>(iterations);
+        std::printf("%-48.*s %12zu ops %10.2f ns/op\n", static_cast<int>(name.size()), name.data(), iterations, per_op);
+        return per_op;
+    }
+
+    // 各组基准, 参数为迭代次数
+    void fixed_string(size_t iterations);
+    void flat_map(size_t iterations);
+    void datetime(size_t iterations);
+    void ctp_tick(size_t iterations);
+    void emt_tick(size_t iterations);
+    void order_book(size_t iterations);
+    void iopv(size_t iterations);
+}
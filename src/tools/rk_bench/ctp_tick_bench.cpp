@@ -0,0 +1,94 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <format>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "adapter/impl/ctp_tick_decoder.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        // 录制的CThostFtdcDepthMarketDataField原始结构体序列, 由环境变量RK_BENCH_CTP_TICKS指定; 未指定时生成样本
+        std::vector<CThostFtdcDepthMarketDataField> load_samples(const std::vector<std::string>& instruments)
+        {
+            std::vector<CThostFtdcDepthMarketDataField> samples;
+            if (const char* path = std::getenv("RK_BENCH_CTP_TICKS"))
+            {
+                std::ifstream file(path, std::ios::binary);
+                CThostFtdcDepthMarketDataField field{};
+                while (file.read(reinterpret_cast<char*>(&field), sizeof(field))) samples.emplace_back(field);
+                if (!samples.empty()) return samples;
+            }
+            const char* times[] = {"21:00:01", "23:59:59", "01:30:00", "09:00:00", "14:59:59"};
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                CThostFtdcDepthMarketDataField field{};
+                std::memcpy(field.TradingDay, "20251027", sizeof(field.TradingDay));
+                std::strncpy(field.InstrumentID, instruments[i % instruments.size()].c_str(), sizeof(field.InstrumentID) - 1);
+                std::strncpy(field.UpdateTime, times[i % std::size(times)], sizeof(field.UpdateTime) - 1);
+                field.UpdateMillisec = static_cast<int>(i % 2) * 500;
+                field.LastPrice = 3500. + static_cast<double>(i % 100);
+                field.Volume = static_cast<int>(i);
+                field.BidPrice1 = field.LastPrice - 1;
+                field.AskPrice1 = field.LastPrice + 1;
+                samples.emplace_back(field);
+            }
+            return samples;
+        }
+    }
+
+    void ctp_tick(size_t iterations)
+    {
+        // 期货全市场约千个合约
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> symbol_details;
+        std::vector<std::string> instruments;
+        const char* products[] = {"rb", "hc", "cu", "al", "zn", "au", "ag", "ru", "IF", "IC", "IH", "IM", "T", "TF", "m", "y", "p", "c", "SR", "CF"};
+        for (const auto* product : products)
+        {
+            for (int year = 25; year <= 26; ++year)
+            {
+                for (int month = 1; month <= 12; ++month)
+                {
+                    instruments.emplace_back(std::string(product) + std::to_string(year * 100 + month));
+                    data_type::Symbol symbol;
+                    symbol.symbol.assign(instruments.back());
+                    symbol_details.emplace(symbol, std::make_shared<data_type::SymbolDetail>());
+                }
+            }
+        }
+        const auto samples = load_samples(instruments);
+        adapter::CTPTickDecoder decoder;
+        decoder.reset(symbol_details);
+
+        // 优化前的转换: stoul + std::format + strptime + 构造Symbol查表
+        run("legacy conversion", iterations, [&](size_t i)
+        {
+            const auto& field = samples[i % samples.size()];
+            auto it = symbol_details.find({field.InstrumentID});
+            if (it == symbol_details.end()) return;
+            data_type::TickData tick{};
+            tick.symbol = it->first;
+            tick.trading_day = static_cast<uint32_t>(std::stoul(field.TradingDay));
+            auto datetime = util::DateTime::strptime(std::format("{} {}", field.TradingDay, field.UpdateTime), "%Y%m%d %H:%M:%S", field.UpdateMillisec);
+            const auto hour = datetime.hour();
+            int back_days = 0;
+            if (datetime.weekday() == 1) back_days = hour >= 16 ? 3 : (hour <= 3 ? 2 : 0);
+            else if (hour >= 16) back_days = 1;
+            tick.update_time = datetime - util::TimeDelta({.days = back_days});
+            tick.last_price = field.LastPrice;
+            do_not_optimize(tick);
+        });
+        run("CTPTickDecoder::decode", iterations, [&](size_t i)
+        {
+            data_type::TickData tick{};
+            do_not_optimize(decoder.decode(samples[i % samples.size()], tick));
+            do_not_optimize(tick);
+        });
+    }
+}
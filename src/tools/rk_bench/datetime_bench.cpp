@@ -0,0 +1,80 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "bench.h"
+#include "util/datetime.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        // 优化前的实现: localtime + stringstream + std::strftime, std::get_time + mktime
+        std::string legacy_strftime(std::chrono::system_clock::time_point tp, std::string_view format)
+        {
+            std::time_t tt = std::chrono::system_clock::to_time_t(tp);
+            std::tm* tm = std::localtime(&tt);
+            std::string modified_format{format};
+            auto duration = tp.time_since_epoch();
+            auto total_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - std::chrono::duration_cast<std::chrono::seconds>(duration)).count();
+            size_t f_pos = modified_format.find("%f");
+            if (f_pos != std::string::npos)
+            {
+                std::stringstream ss;
+                ss << std::setfill('0') << std::setw(6) << (total_nanos / 1000);
+                modified_format.replace(f_pos, 2, ss.str());
+            }
+            char buffer[256];
+            std::strftime(buffer, sizeof(buffer), modified_format.c_str(), tm);
+            return buffer;
+        }
+        std::chrono::system_clock::time_point legacy_strptime(const std::string& datetime_string, std::string_view format)
+        {
+            std::tm tm = {};
+            std::istringstream ss(datetime_string);
+            ss >> std::get_time(&tm, format.data());
+            return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+        }
+        int legacy_hour(std::chrono::system_clock::time_point tp)
+        {
+            std::time_t tt = std::chrono::system_clock::to_time_t(tp);
+            return std::localtime(&tt)->tm_hour;
+        }
+    }
+
+    void datetime(size_t iterations)
+    {
+        const auto base = std::chrono::system_clock::now();
+        auto at = [&](size_t i) {return base + std::chrono::microseconds(i * 1237);};
+
+        run("legacy strftime default", iterations, [&](size_t i) {do_not_optimize(legacy_strftime(at(i), "%Y-%m-%d %H:%M:%S.%f"));});
+        run("DateTime::strftime default", iterations, [&](size_t i) {do_not_optimize(util::DateTime(at(i)).strftime());});
+        run("DateTime::strftime to buffer", iterations, [&](size_t i)
+        {
+            char buffer[32];
+            do_not_optimize(util::DateTime(at(i)).strftime(buffer, sizeof(buffer), "%Y%m%d %H:%M:%S"));
+            do_not_optimize(buffer[0]);
+        });
+        run("legacy hour", iterations, [&](size_t i) {do_not_optimize(legacy_hour(at(i)));});
+        run("DateTime::hour", iterations, [&](size_t i) {do_not_optimize(util::DateTime(at(i)).hour());});
+
+        const std::string datetime_string = "20251023 21:30:05";
+        run("legacy strptime", iterations / 10, [&](size_t) {do_not_optimize(legacy_strptime(datetime_string, "%Y%m%d %H:%M:%S"));});
+        run("DateTime::strptime", iterations, [&](size_t) {do_not_optimize(util::DateTime::strptime(datetime_string, "%Y%m%d %H:%M:%S"));});
+        run("DateTime::strptime_date_time", iterations, [&](size_t) {do_not_optimize(util::DateTime::strptime_date_time("20251023", "21:30:05", 500));});
+        run("legacy keyword ctor (mktime)", iterations / 10, [&](size_t i)
+        {
+            std::tm tm = {};
+            tm.tm_year = 125;
+            tm.tm_mon = 9;
+            tm.tm_mday = 23;
+            tm.tm_hour = static_cast<int>(i % 24);
+            tm.tm_isdst = -1;
+            do_not_optimize(std::mktime(&tm));
+        });
+        run("DateTime keyword ctor", iterations, [&](size_t i) {do_not_optimize(util::DateTime({2025, 10, 23, static_cast<int>(i % 24)}));});
+    }
+}
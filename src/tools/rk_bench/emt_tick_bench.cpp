@@ -0,0 +1,103 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <cstring>
+#include <format>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "bench.h"
+#include "adapter/impl/emt_tick_decoder.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        std::string legacy_convert_trade_symbol_to_symbol(data_type::Exchange exchange, std::string trade_symbol)
+        {
+            switch (exchange)
+            {
+                case data_type::Exchange::SSE: return std::format("{}.SH", trade_symbol);
+                case data_type::Exchange::SZSE: return std::format("{}.SZ", trade_symbol);
+                default: return trade_symbol;
+            }
+        }
+    }
+
+    void emt_tick(size_t iterations)
+    {
+        // 沪深全市场5000只, 全部订阅
+        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> symbol_details;
+        std::unordered_set<data_type::Symbol> subscribed_symbols;
+        std::vector<EMTMarketDataStruct> samples;
+        auto add = [&](uint32_t begin, uint32_t num, data_type::Exchange exchange, EMQ_EXCHANGE_TYPE emq_exchange) -> void
+        {
+            for (uint32_t code = begin; code < begin + num; ++code)
+            {
+                auto ticker = std::to_string(code);
+                ticker = std::string(6 - ticker.size(), '0') + ticker;
+                data_type::Symbol symbol;
+                symbol.symbol.assign(ticker + (exchange == data_type::Exchange::SSE ? ".SH" : ".SZ"));
+                symbol.trade_symbol.assign(ticker);
+                symbol.exchange = exchange;
+                symbol.product_class = data_type::ProductClass::STOCK;
+                symbol_details.emplace(symbol, std::make_shared<data_type::SymbolDetail>());
+                subscribed_symbols.emplace(symbol);
+                EMTMarketDataStruct market_data{};
+                market_data.exchange_id = emq_exchange;
+                std::memcpy(market_data.ticker, ticker.c_str(), ticker.size() + 1);
+                market_data.data_time = 20251023093000000 + code % 60 * 1000;
+                market_data.last_price = 10. + code % 100;
+                for (int level = 0; level < 10; ++level)
+                {
+                    market_data.bid[level] = market_data.last_price - 0.01 * (level + 1);
+                    market_data.ask[level] = market_data.last_price + 0.01 * (level + 1);
+                    market_data.bid_qty[level] = 100 * (level + 1);
+                    market_data.ask_qty[level] = 100 * (level + 1);
+                }
+                samples.emplace_back(market_data);
+            }
+        };
+        add(600000, 1700, data_type::Exchange::SSE, EMQ_EXCHANGE_SH);
+        add(688000, 600, data_type::Exchange::SSE, EMQ_EXCHANGE_SH);
+        add(1, 1500, data_type::Exchange::SZSE, EMQ_EXCHANGE_SZ);
+        add(300001, 1200, data_type::Exchange::SZSE, EMQ_EXCHANGE_SZ);
+        adapter::EMTTickDecoder decoder;
+        decoder.reset(symbol_details);
+        for (const auto& symbol : subscribed_symbols) decoder.set_subscribed(symbol, true);
+        auto convert_exchange = [](EMQ_EXCHANGE_TYPE exchange)
+        {
+            return exchange == EMQ_EXCHANGE_SH ? data_type::Exchange::SSE : data_type::Exchange::SZSE;
+        };
+
+        // 优化前: 每笔拼接std::string代码, 两次合约表查找, 一次订阅表查找, 逐档拷贝
+        run("legacy conversion", iterations, [&](size_t i)
+        {
+            const auto& market_data = samples[i % samples.size()];
+            auto exchange = convert_exchange(market_data.exchange_id);
+            auto symbol_name = legacy_convert_trade_symbol_to_symbol(exchange, market_data.ticker);
+            if (!symbol_details.contains({symbol_name})) return;
+            auto symbol = symbol_details.find({symbol_name})->first;
+            if (subscribed_symbols.find(symbol) == subscribed_symbols.end()) return;
+            data_type::TickData tick{};
+            tick.symbol = symbol;
+            tick.update_time = adapter::EMTTickDecoder::convert_datetime(market_data.data_time);
+            for (int level = 0; level < 10; ++level)
+            {
+                tick.bid_price[level] = market_data.bid[level];
+                tick.ask_price[level] = market_data.ask[level];
+                tick.bid_volume[level] = market_data.bid_qty[level];
+                tick.ask_volume[level] = market_data.ask_qty[level];
+            }
+            do_not_optimize(tick);
+        });
+        run("EMTTickDecoder::decode", iterations, [&](size_t i)
+        {
+            const auto& market_data = samples[i % samples.size()];
+            data_type::TickData tick{};
+            do_not_optimize(decoder.decode(convert_exchange(market_data.exchange_id), market_data, tick));
+            do_not_optimize(tick);
+        });
+    }
+}
@@ -0,0 +1,76 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "bench.h"
+#include "data_type.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        // 优化前的实现: 逐字节找'\0'后按string_view比较/哈希, 复制自原FixedString::view
+        template<size_t N>
+        std::string_view legacy_view(const util::FixedString<N>& s)
+        {
+            size_t len = 0;
+            for (; len < N; ++len)
+            {
+                if (s.data()[len] == '\0') break;
+            }
+            return std::string_view(s.data(), len);
+        }
+        struct LegacyHash
+        {
+            size_t operator()(const data_type::Symbol& s) const
+            {
+                return std::hash<std::string_view>{}(legacy_view(s.symbol));
+            }
+        };
+        struct LegacyEqual
+        {
+            bool operator()(const data_type::Symbol& a, const data_type::Symbol& b) const
+            {
+                return legacy_view(a.symbol) == legacy_view(b.symbol);
+            }
+        };
+        std::vector<data_type::Symbol> make_symbols(size_t num)
+        {
+            std::vector<data_type::Symbol> symbols;
+            symbols.reserve(num);
+            for (size_t i = 0; i < num; ++i)
+            {
+                data_type::Symbol symbol;
+                symbol.symbol.assign(std::to_string(600000 + i));
+                symbols.emplace_back(symbol);
+            }
+            return symbols;
+        }
+    }
+
+    void fixed_string(size_t iterations)
+    {
+        const auto symbols = make_symbols(5000);
+        auto at = [&](size_t i) -> const data_type::Symbol& {return symbols[(i * 2654435761u) % symbols.size()];};
+
+        run("legacy view().size()", iterations, [&](size_t i) {do_not_optimize(legacy_view(at(i).symbol).size());});
+        run("view().size()", iterations, [&](size_t i) {do_not_optimize(at(i).symbol.view().size());});
+        run("legacy hash", iterations, [&](size_t i) {do_not_optimize(LegacyHash{}(at(i)));});
+        run("FixedString::hash", iterations, [&](size_t i) {do_not_optimize(at(i).symbol.hash());});
+        run("legacy equal", iterations, [&](size_t i) {do_not_optimize(LegacyEqual{}(at(i), at(i + 1)));});
+        run("FixedString::operator==", iterations, [&](size_t i) {do_not_optimize(at(i).symbol == at(i + 1).symbol);});
+
+        std::unordered_map<data_type::Symbol, int, LegacyHash, LegacyEqual> legacy_map;
+        std::unordered_map<data_type::Symbol, int> map;
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            legacy_map.emplace(symbols[i], static_cast<int>(i));
+            map.emplace(symbols[i], static_cast<int>(i));
+        }
+        run("unordered_map<Symbol> find, legacy", iterations, [&](size_t i) {do_not_optimize(legacy_map.find(at(i))->second);});
+        run("unordered_map<Symbol> find", iterations, [&](size_t i) {do_not_optimize(map.find(at(i))->second);});
+    }
+}
@@ -0,0 +1,98 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bench.h"
+#include "data_type.h"
+#include "util/flat_map.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        // 模拟5000只A股: 沪市主板/科创板, 深市主板/创业板
+        std::vector<data_type::Symbol> make_a_share_universe()
+        {
+            std::vector<data_type::Symbol> symbols;
+            auto add = [&](uint32_t begin, uint32_t num, data_type::Exchange exchange) -> void
+            {
+                for (uint32_t code = begin; code < begin + num; ++code)
+                {
+                    data_type::Symbol symbol;
+                    auto code_str = std::to_string(code);
+                    symbol.symbol.assign(std::string(6 - code_str.size(), '0') + code_str);
+                    symbol.exchange = exchange;
+                    symbol.product_class = data_type::ProductClass::STOCK;
+                    symbols.emplace_back(symbol);
+                }
+            };
+            add(600000, 1700, data_type::Exchange::SSE);
+            add(688000, 600, data_type::Exchange::SSE);
+            add(1, 1500, data_type::Exchange::SZSE);
+            add(300001, 1200, data_type::Exchange::SZSE);
+            return symbols;
+        }
+    }
+
+    void flat_map(size_t iterations)
+    {
+        const auto symbols = make_a_share_universe();
+        auto at = [&](size_t i) -> const data_type::Symbol& {return symbols[(i * 2654435761u) % symbols.size()];};
+        std::vector<data_type::Symbol> missing;
+        for (const auto& symbol : symbols)
+        {
+            auto other = symbol;
+            other.symbol.assign(symbol.symbol.to_string() + "X");
+            missing.emplace_back(other);
+        }
+
+        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::TickData>> std_map;
+        util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::TickData>> flat_map(symbols.size());
+        for (const auto& symbol : symbols)
+        {
+            std_map.emplace(symbol, std::make_shared<data_type::TickData>());
+            flat_map.emplace(symbol, std::make_shared<data_type::TickData>());
+        }
+        run("unordered_map find hit", iterations, [&](size_t i) {do_not_optimize(std_map.find(at(i))->second.get());});
+        run("FlatMap find hit", iterations, [&](size_t i) {do_not_optimize(flat_map.find(at(i))->second.get());});
+        run("unordered_map find miss", iterations, [&](size_t i) {do_not_optimize(std_map.contains(missing[i % missing.size()]));});
+        run("FlatMap find miss", iterations, [&](size_t i) {do_not_optimize(flat_map.contains(missing[i % missing.size()]));});
+        const auto loops = std::max<size_t>(1, iterations / symbols.size());
+        run("unordered_map iterate 5000", loops, [&](size_t)
+        {
+            for (const auto& [symbol, tick] : std_map) do_not_optimize(tick.get());
+        });
+        run("FlatMap iterate 5000", loops, [&](size_t)
+        {
+            for (const auto& [symbol, tick] : flat_map) do_not_optimize(tick.get());
+        });
+
+        // 行情分发: 每个合约挂2个回调
+        std::unordered_multimap<data_type::Symbol, int> std_multimap;
+        util::FlatMultiMap<data_type::Symbol, int> flat_multimap(symbols.size());
+        for (size_t i = 0; i < symbols.size(); ++i)
+        {
+            for (int handler = 0; handler < 2; ++handler)
+            {
+                std_multimap.emplace(symbols[i], handler);
+                flat_multimap.emplace(symbols[i], handler);
+            }
+        }
+        run("unordered_multimap equal_range", iterations, [&](size_t i)
+        {
+            int sum = 0;
+            auto range = std_multimap.equal_range(at(i));
+            for (auto it = range.first; it != range.second; ++it) sum += it->second;
+            do_not_optimize(sum);
+        });
+        run("FlatMultiMap equal_range", iterations, [&](size_t i)
+        {
+            int sum = 0;
+            for (const auto handler : flat_multimap.equal_range(at(i))) sum += handler;
+            do_not_optimize(sum);
+        });
+    }
+}
@@ -0,0 +1,116 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bench.h"
+#include "util/iopv.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        data_type::Symbol make_symbol(uint32_t code, data_type::ProductClass product_class)
+        {
+            auto ticker = std::to_string(code);
+            ticker = std::string(6 - ticker.size(), '0') + ticker;
+            data_type::Symbol symbol;
+            symbol.symbol.assign(ticker + ".SH");
+            symbol.trade_symbol.assign(ticker);
+            symbol.exchange = data_type::Exchange::SSE;
+            symbol.product_class = product_class;
+            return symbol;
+        }
+    }
+
+    // 全市场规模: 5000只股票, 800只ETF, 每只ETF 30~300只成分股, 权重股被数百只ETF持有
+    void iopv(size_t iterations)
+    {
+        constexpr uint32_t stock_num = 5000;
+        constexpr uint32_t etf_num = 800;
+        std::mt19937_64 rng(42);
+        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>> symbol_details;
+        std::unordered_map<data_type::Symbol, std::shared_ptr<data_type::ETFDetail>> etf_details;
+        std::vector<data_type::Symbol> stocks;
+        for (uint32_t i = 0; i < stock_num; ++i)
+        {
+            auto symbol = make_symbol(600000 + i, data_type::ProductClass::STOCK);
+            auto detail = std::make_shared<data_type::SymbolDetail>();
+            detail->symbol = symbol;
+            detail->pre_close_price = static_cast<double>(300 + rng() % 10000) / 100;
+            symbol_details.emplace(symbol, std::move(detail));
+            stocks.push_back(symbol);
+        }
+        // 成分股按序号的平方分布抽取, 序号小的权重股出现在更多ETF中
+        const auto pick_stock = [&]()
+        {
+            const auto r = static_cast<double>(rng() % 1'000'000) / 1'000'000;
+            return static_cast<uint32_t>(r * r * stock_num);
+        };
+        for (uint32_t i = 0; i < etf_num; ++i)
+        {
+            auto etf = std::make_shared<data_type::ETFDetail>();
+            etf->symbol = make_symbol(510000 + i, data_type::ProductClass::ETF);
+            etf->unit = 1'000'000;
+            etf->estimate_cash_component = 1000.;
+            const auto component_num = 30 + rng() % 271;
+            for (size_t j = 0; j < component_num; ++j)
+            {
+                etf->component.push_back({stocks[pick_stock()], static_cast<int64_t>(100 * (1 + rng() % 100)), data_type::CashReplaceType::OPTIONAL});
+            }
+            etf_details.emplace(etf->symbol, std::move(etf));
+        }
+        // 成分股行情流, 同样偏向权重股
+        std::vector<data_type::TickData> ticks(1 << 16);
+        for (auto& tick : ticks)
+        {
+            const auto stock = pick_stock();
+            tick.symbol = stocks[stock];
+            tick.last_price = symbol_details[tick.symbol]->pre_close_price * (0.95 + static_cast<double>(rng() % 1000) / 10000);
+        }
+
+        // 对照实现: 成分股行情到达时重算所有包含它的ETF的整个篮子
+        std::unordered_map<data_type::Symbol, double> prices;
+        for (const auto& [symbol, detail] : symbol_details) prices[symbol] = detail->pre_close_price;
+        std::unordered_map<data_type::Symbol, std::vector<std::shared_ptr<data_type::ETFDetail>>> etf_by_component;
+        for (const auto& [etf, detail] : etf_details)
+        {
+            for (const auto& component : detail->component) etf_by_component[component.symbol].push_back(detail);
+        }
+        std::unordered_map<data_type::Symbol, double> full_iopv;
+        run("recompute basket", iterations, [&](size_t i)
+        {
+            const auto& tick = ticks[i & (ticks.size() - 1)];
+            prices[tick.symbol] = tick.last_price;
+            const auto it = etf_by_component.find(tick.symbol);
+            if (it == etf_by_component.end()) return;
+            for (const auto& detail : it->second)
+            {
+                double value = detail->estimate_cash_component;
+                for (const auto& component : detail->component) value += static_cast<double>(component.quantity) * prices[component.symbol];
+                full_iopv[detail->symbol] = value / static_cast<double>(detail->unit);
+            }
+        });
+
+        util::IOPVCalculator calculator;
+        calculator.reset(symbol_details, etf_details);
+        // 按行情批次输出, 每64条行情flush一次
+        run("IOPVCalculator incremental", iterations, [&](size_t i)
+        {
+            auto tick = ticks[i & (ticks.size() - 1)];
+            calculator.on_tick(tick);
+            if ((i & 63) == 63) calculator.flush([](const data_type::TickData& etf_tick) {do_not_optimize(etf_tick.iopv);});
+        });
+
+        // 回放同样的行情后两种实现结果应一致
+        double max_error = 0.;
+        for (const auto& [etf, value] : full_iopv)
+        {
+            max_error = std::max(max_error, std::abs(*calculator.iopv(etf) - value));
+        }
+        std::printf("%zu etf, %zu component, max abs diff %.3g\n", calculator.etf_num(), calculator.component_num(), max_error);
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Created by root on 2026/10/19.
+// 热路径基准, 对比优化前后的实现
+// 用法: rk_bench [基准名...] [-n 迭代次数], 不指定基准名则全部运行
+// rk_bench与库编译参数相同, rk_bench_native为-march=native对照
+//
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <vector>
+#include "bench.h"
+
+using namespace rk;
+
+struct BenchEntry
+{
+    std::string_view name;
+    void (*func)(size_t);
+};
+
+static constexpr BenchEntry benches[] = {
+    {"fixed_string", bench::fixed_string},
+    {"flat_map", bench::flat_map},
+    {"datetime", bench::datetime},
+    {"ctp_tick", bench::ctp_tick},
+    {"emt_tick", bench::emt_tick},
+    {"order_book", bench::order_book},
+    {"iopv", bench::iopv},
+};
+
+int main(int argc, char* argv[])
+{
+    size_t iterations = 10'000'000;
+    std::vector<std::string_view> names;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg(argv[i]);
+        if (arg == "-n" && i + 1 < argc) iterations = std::strtoull(argv[++i], nullptr, 10);
+        else names.emplace_back(arg);
+    }
+#ifdef RK_BENCH_NATIVE
+    std::cout << "build: -march=native" << std::endl;
+#else
+    std::cout << "build: library flags" << std::endl;
+#endif
+    for (const auto& [name, func] : benches)
+    {
+        if (!names.empty() && std::ranges::find(names, name) == names.end()) continue;
+        std::cout << "== " << name << " ==" << std::endl;
+        func(iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,304 @@
+//
+// Created by root on 2026/10/19.
+//
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "bench.h"
+#include "util/order_book.h"
+
+namespace rk::bench
+{
+    namespace
+    {
+        using Event = std::variant<data_type::L2OrderData, data_type::L2TradeData>;
+        using SymbolDetailMap = util::FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>;
+
+        // 对照实现: 有序表存档位, 哈希表存委托
+        class MapOrderBook
+        {
+            struct Order
+            {
+                int64_t tick;
+                int64_t volume;
+                bool is_bid;
+            };
+        public:
+            void on_order(const data_type::L2OrderData& order)
+            {
+                if (order.order_type == data_type::L2OrderType::CANCEL)
+                {
+                    auto it = _orders.find(order.order_no);
+                    if (it == _orders.end()) return;
+                    add_volume(it->second.is_bid, it->second.tick, -it->second.volume);
+                    _orders.erase(it);
+                    return;
+                }
+                const auto tick = std::llround(order.price * 100);
+                const bool is_bid = order.direction == data_type::Direction::LONG;
+                if (!_orders.try_emplace(order.order_no, Order{tick, order.volume, is_bid}).second) return;
+                add_volume(is_bid, tick, order.volume);
+            }
+            void on_trade(const data_type::L2TradeData& trade)
+            {
+                for (const auto order_no : {trade.buy_order_no, trade.sell_order_no})
+                {
+                    auto it = _orders.find(order_no);
+                    if (it == _orders.end()) continue;
+                    const auto reduced = std::min(trade.volume, it->second.volume);
+                    add_volume(it->second.is_bid, it->second.tick, -reduced);
+                    it->second.volume -= reduced;
+                    if (it->second.volume <= 0) _orders.erase(it);
+                }
+            }
+            void snapshot(data_type::TickData& tick) const
+            {
+                size_t i = 0;
+                for (auto it = _bids.rbegin(); it != _bids.rend() && i < 10; ++it, ++i)
+                {
+                    tick.bid_price[i] = static_cast<double>(it->first) / 100;
+                    tick.bid_volume[i] = it->second;
+                }
+                i = 0;
+                for (auto it = _asks.begin(); it != _asks.end() && i < 10; ++it, ++i)
+                {
+                    tick.ask_price[i] = static_cast<double>(it->first) / 100;
+                    tick.ask_volume[i] = it->second;
+                }
+            }
+        private:
+            void add_volume(bool is_bid, int64_t tick, int64_t delta)
+            {
+                auto& levels = is_bid ? _bids : _asks;
+                auto& volume = levels[tick];
+                volume += delta;
+                if (volume <= 0) levels.erase(tick);
+            }
+            std::map<int64_t, int64_t> _bids;
+            std::map<int64_t, int64_t> _asks;
+            std::unordered_map<uint64_t, Order> _orders;
+        };
+
+        data_type::Symbol make_symbol(uint32_t code)
+        {
+            auto ticker = std::to_string(code);
+            ticker = std::string(6 - ticker.size(), '0') + ticker;
+            data_type::Symbol symbol;
+            symbol.symbol.assign(ticker + ".SZ");
+            symbol.trade_symbol.assign(ticker);
+            symbol.exchange = data_type::Exchange::SZSE;
+            symbol.product_class = data_type::ProductClass::STOCK;
+            return symbol;
+        }
+        // 录制的逐笔序列由环境变量RK_BENCH_L2_EVENTS指定, 每条为1字节类型(0委托, 1成交)加L2OrderData/L2TradeData原始结构体
+        // 录制数据按首个价格上下20%设涨跌停区间
+        bool load_recorded(std::vector<Event>& events, SymbolDetailMap& symbol_details)
+        {
+            const char* path = std::getenv("RK_BENCH_L2_EVENTS");
+            if (!path) return false;
+            std::ifstream file(path, std::ios::binary);
+            char type = 0;
+            const auto add_symbol = [&](const data_type::Symbol& symbol, double price)
+            {
+                if (symbol_details.contains(symbol) || price <= 0) return;
+                auto detail = std::make_shared<data_type::SymbolDetail>();
+                detail->symbol = symbol;
+                detail->price_tick = 0.01;
+                detail->lower_limit_price = std::floor(price * 80) / 100;
+                detail->upper_limit_price = std::ceil(price * 120) / 100;
+                symbol_details.emplace(symbol, std::move(detail));
+            };
+            while (file.read(&type, 1))
+            {
+                if (type == 0)
+                {
+                    data_type::L2OrderData order;
+                    if (!file.read(reinterpret_cast<char*>(&order), sizeof(order))) break;
+                    add_symbol(order.symbol, order.price);
+                    events.emplace_back(order);
+                }
+                else
+                {
+                    data_type::L2TradeData trade;
+                    if (!file.read(reinterpret_cast<char*>(&trade), sizeof(trade))) break;
+                    add_symbol(trade.symbol, trade.price);
+                    events.emplace_back(trade);
+                }
+            }
+            return !events.empty();
+        }
+        // 深交所语义的合成逐笔: 50%被动限价委托, 35%撤单, 15%成交
+        void generate(std::vector<Event>& events, SymbolDetailMap& symbol_details, size_t symbol_num, size_t event_num)
+        {
+            struct LiveOrder
+            {
+                uint64_t order_no;
+                bool is_bid;
+            };
+            struct SymbolState
+            {
+                data_type::Symbol symbol;
+                int64_t mid_tick;
+                std::vector<LiveOrder> live;
+            };
+            std::mt19937_64 rng(42);
+            std::vector<SymbolState> states;
+            for (uint32_t i = 0; i < symbol_num; ++i)
+            {
+                const auto symbol = make_symbol(i + 1);
+                const auto mid_tick = static_cast<int64_t>(500 + rng() % 5000);
+                auto detail = std::make_shared<data_type::SymbolDetail>();
+                detail->symbol = symbol;
+                detail->price_tick = 0.01;
+                detail->lower_limit_price = static_cast<double>(mid_tick * 9 / 10) / 100;
+                detail->upper_limit_price = static_cast<double>(mid_tick * 11 / 10) / 100;
+                symbol_details.emplace(symbol, std::move(detail));
+                states.push_back({symbol, mid_tick, {}});
+            }
+            const auto time = util::DateTime({2025, 10, 27, 9, 30, 0});
+            uint64_t seq = 0;
+            events.reserve(event_num);
+            while (events.size() < event_num)
+            {
+                auto& state = states[rng() % states.size()];
+                const auto r = rng() % 100;
+                ++seq;
+                if (r < 50 || state.live.size() < 2)
+                {
+                    data_type::L2OrderData order;
+                    order.symbol = state.symbol;
+                    order.update_time = time;
+                    order.channel = 2011;
+                    order.seq = seq;
+                    order.order_no = seq;
+                    const bool is_bid = rng() % 2;
+                    order.direction = is_bid ? data_type::Direction::LONG : data_type::Direction::SHORT;
+                    order.order_type = data_type::L2OrderType::LIMIT;
+                    const auto offset = static_cast<int64_t>(1 + rng() % 10);
+                    order.price = static_cast<double>(is_bid ? state.mid_tick - offset : state.mid_tick + offset) / 100;
+                    order.volume = static_cast<int64_t>(100 * (1 + rng() % 10));
+                    state.live.push_back({seq, is_bid});
+                    events.emplace_back(order);
+                }
+                else if (r < 85)
+                {
+                    const auto index = rng() % state.live.size();
+                    data_type::L2OrderData order;
+                    order.symbol = state.symbol;
+                    order.update_time = time;
+                    order.channel = 2011;
+                    order.seq = seq;
+                    order.order_no = state.live[index].order_no;
+                    order.direction = state.live[index].is_bid ? data_type::Direction::LONG : data_type::Direction::SHORT;
+                    order.order_type = data_type::L2OrderType::CANCEL;
+                    state.live[index] = state.live.back();
+                    state.live.pop_back();
+                    events.emplace_back(order);
+                }
+                else
+                {
+                    data_type::L2TradeData trade;
+                    trade.symbol = state.symbol;
+                    trade.update_time = time;
+                    trade.channel = 2011;
+                    trade.seq = seq;
+                    for (const auto& order : state.live)
+                    {
+                        (order.is_bid ? trade.buy_order_no : trade.sell_order_no) = order.order_no;
+                        if (trade.buy_order_no && trade.sell_order_no) break;
+                    }
+                    trade.price = static_cast<double>(state.mid_tick) / 100;
+                    trade.volume = 100;
+                    trade.turnover = trade.price * 100;
+                    events.emplace_back(trade);
+                }
+            }
+        }
+    }
+
+    void order_book(size_t iterations)
+    {
+        std::vector<Event> events;
+        SymbolDetailMap symbol_details;
+        if (!load_recorded(events, symbol_details))
+        {
+            // 深市约2800只
+            generate(events, symbol_details, 2800, 1'000'000);
+        }
+        // 每轮回放完清空订单簿, 重建开销摊入
+        const auto replay = [&](auto& reset, auto& apply)
+        {
+            return [&](size_t i)
+            {
+                const auto index = i % events.size();
+                if (index == 0) reset();
+                std::visit(apply, events[index]);
+            };
+        };
+
+        std::unordered_map<data_type::Symbol, MapOrderBook> map_books;
+        auto map_reset = [&]() {map_books.clear();};
+        auto map_apply = [&]<typename T>(const T& event)
+        {
+            auto& book = map_books[event.symbol];
+            if constexpr (std::is_same_v<T, data_type::L2OrderData>) book.on_order(event);
+            else book.on_trade(event);
+        };
+        run("std::map book", iterations, replay(map_reset, map_apply));
+
+        util::OrderBookEngine engine({});
+        auto engine_reset = [&]() {engine.reset(symbol_details);};
+        auto engine_apply = [&]<typename T>(const T& event)
+        {
+            if constexpr (std::is_same_v<T, data_type::L2OrderData>) engine.on_order(event);
+            else engine.on_trade(event);
+        };
+        run("OrderBookEngine", iterations, replay(engine_reset, engine_apply));
+
+        // 逐条发布十档快照
+        util::OrderBookEngine publishing_engine([](const data_type::TickData& tick) {do_not_optimize(tick);});
+        auto publishing_reset = [&]() {publishing_engine.reset(symbol_details);};
+        auto publishing_apply = [&]<typename T>(const T& event)
+        {
+            if constexpr (std::is_same_v<T, data_type::L2OrderData>) publishing_engine.on_order(event);
+            else publishing_engine.on_trade(event);
+        };
+        run("OrderBookEngine + 10-level tick per event", iterations, replay(publishing_reset, publishing_apply));
+
+        // 一轮回放后两种实现的十档应一致
+        map_books.clear();
+        engine.reset(symbol_details);
+        for (const auto& event : events)
+        {
+            std::visit(map_apply, event);
+            std::visit(engine_apply, event);
+        }
+        size_t mismatched = 0;
+        for (const auto& [symbol, map_book] : map_books)
+        {
+            data_type::TickData expected{};
+            data_type::TickData actual{};
+            map_book.snapshot(expected);
+            engine.find(symbol)->snapshot(actual);
+            // 价格按档位比较, tick / 100与tick * 0.01的浮点表示可能不同
+            const auto same_levels = [](const auto& expected_price, const auto& expected_volume, const auto& actual_price, const auto& actual_volume)
+            {
+                for (size_t i = 0; i < expected_price.size(); ++i)
+                {
+                    if (std::llround(expected_price[i] * 100) != std::llround(actual_price[i] * 100) || expected_volume[i] != actual_volume[i]) return false;
+                }
+                return true;
+            };
+            if (!same_levels(expected.bid_price, expected.bid_volume, actual.bid_price, actual.bid_volume) ||
+                !same_levels(expected.ask_price, expected.ask_volume, actual.ask_price, actual.ask_volume))
+                ++mismatched;
+        }
+        std::printf("%zu events, %zu books, %zu mismatched against std::map book\n", events.size(), map_books.size(), mismatched);
+    }
+}
@@ -0,0 +1,52 @@
+//
+// Created by root on 2026/10/19.
+// OMS事件日志解码, 每条记录输出一行json
+// 用法: rk_journal <journal文件> [-f 持续跟踪新记录]
+//
+#include <iostream>
+#include <filesystem>
+#include <string_view>
+#include <thread>
+#include "journal_record.h"
+#include "util/journal.h"
+
+using namespace rk;
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: rk_journal <journal file> [-f]" << std::endl;
+        return 1;
+    }
+    const std::filesystem::path path(argv[1]);
+    const bool follow = argc > 2 && std::string_view(argv[2]) == "-f";
+    if (!std::filesystem::exists(path))
+    {
+        std::cerr << "journal " << path << " not found" << std::endl;
+        return 1;
+    }
+    // 已有文件沿用文件头中的容量
+    util::Journal<JournalRecord> journal(path, 0, std::chrono::seconds(1));
+    if (!journal.is_open())
+    {
+        std::cerr << "journal " << path << " open failed or format mismatch" << std::endl;
+        return 1;
+    }
+    size_t index = 0;
+    while (true)
+    {
+        for (; index < journal.size(); ++index)
+        {
+            nlohmann::ordered_json line;
+            line["seq"] = index;
+            line.update(to_json(journal[index]));
+            std::cout << line.dump() << '\n';
+        }
+        std::cout.flush();
+        if (!follow) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+}
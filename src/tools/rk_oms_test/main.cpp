@@ -0,0 +1,480 @@
+//
+// Created by root on 2026/10/19.
+// OMS随机生命周期测试: 随机报单/成交/撤单/拒单/重复回报/撤单先于成交, 每步与模拟柜台的持仓和委托对账
+// 结束后撤掉全部在途委托检查冻结资金归零, 并从预写日志重建检查与内存状态一致; 另检查日志写满时拒绝报单和日志快照恢复的资金
+// 用法: rk_oms_test [起始种子] [种子数] [每个种子步数], 失败返回1并打印种子和步数
+//
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "engine_impl/engine_impl.h"
+#include "engine_impl/oms.h"
+#include "util/logger.h"
+
+using namespace rk;
+
+namespace
+{
+    struct CheckFailed
+    {
+        std::string msg;
+    };
+    void check(bool cond, const std::string& msg)
+    {
+        if (!cond) throw CheckFailed{msg};
+    }
+    /// 模拟柜台, 按交易所语义维护持仓和委托, 作为OMS的对账基准
+    class Counter
+    {
+    public:
+        struct Order
+        {
+            data_type::OrderReq req;
+            uint32_t traded = 0;
+            uint32_t canceled = 0;
+            uint32_t remain = 0;
+            bool rejected = false;
+            [[nodiscard]] bool finished() const {return rejected || remain == 0;}
+        };
+        void add_position(const data_type::Symbol& symbol, uint32_t long_yd, uint32_t short_yd)
+        {
+            auto& position = _positions.try_emplace(symbol, symbol).first->second;
+            position.long_position.position = position.long_position.yd_position = long_yd;
+            position.short_position.position = position.short_position.yd_position = short_yd;
+        }
+        [[nodiscard]] std::unordered_map<data_type::Symbol, data_type::PositionData> query_position_data() const {return _positions;}
+        [[nodiscard]] const std::vector<Order>& orders() const {return _orders;}
+        [[nodiscard]] uint32_t closable_volume(const data_type::OrderReq& req) const
+        {
+            return _positions.at(req.symbol).closable_volume(req.direction, req.offset);
+        }
+        void insert(const data_type::OrderReq& req)
+        {
+            _orders.push_back({req, 0, 0, req.volume});
+            apply(req, req.volume, 0);
+        }
+        void trade(data_type::OrderRef order_ref, uint32_t volume)
+        {
+            auto& order = _orders[order_ref];
+            order.traded += volume;
+            order.remain -= volume;
+            apply(order.req, -static_cast<int64_t>(volume), volume);
+        }
+        void cancel(data_type::OrderRef order_ref, uint32_t volume)
+        {
+            auto& order = _orders[order_ref];
+            order.canceled += volume;
+            order.remain -= volume;
+            apply(order.req, -static_cast<int64_t>(volume), 0);
+        }
+        void reject(data_type::OrderRef order_ref)
+        {
+            auto& order = _orders[order_ref];
+            apply(order.req, -static_cast<int64_t>(order.remain), 0);
+            order.remain = 0;
+            order.rejected = true;
+        }
+
+    private:
+        // 开仓的在途数量计入同向pending, 平仓计入反向frozen
+        void apply(const data_type::OrderReq& req, int64_t working_delta, uint32_t traded_volume)
+        {
+            auto& position = _positions.at(req.symbol);
+            const auto is_open = req.offset == data_type::Offset::OPEN;
+            auto& info = (req.direction == data_type::Direction::LONG) == is_open ? position.long_position : position.short_position;
+            if (is_open)
+            {
+                info.pending = static_cast<uint32_t>(info.pending + working_delta);
+                info.position += traded_volume;
+                return;
+            }
+            info.frozen = static_cast<uint32_t>(info.frozen + working_delta);
+            info.position -= traded_volume;
+            if (req.symbol.is_close_yesterday(req.offset))
+            {
+                info.yd_frozen = static_cast<uint32_t>(info.yd_frozen + working_delta);
+                info.yd_position -= traded_volume;
+            }
+            // 不区分今昨的平仓指令, 昨仓不超过总持仓
+            info.yd_position = std::min(info.yd_position, info.position);
+        }
+
+        std::unordered_map<data_type::Symbol, data_type::PositionData> _positions;
+        std::vector<Order> _orders;
+    };
+
+    data_type::Symbol make_symbol(std::string_view name, data_type::Exchange exchange, data_type::ProductClass product_class)
+    {
+        return {name, name, exchange, product_class};
+    }
+    std::shared_ptr<data_type::SymbolDetail> make_detail(const data_type::Symbol& symbol, int multiplier, double margin_ratio)
+    {
+        auto detail = std::make_shared<data_type::SymbolDetail>();
+        detail->symbol = symbol;
+        detail->product_class = symbol.product_class;
+        detail->multiplier = multiplier;
+        detail->min_buy_volume = detail->min_sell_volume = 1;
+        detail->long_margin_ratio = detail->short_margin_ratio = margin_ratio;
+        detail->open_fee_rate_by_money = 0.0001;
+        detail->close_fee_rate_by_money = 0.0001;
+        detail->close_today_fee_rate_by_money = 0.0002;
+        detail->open_fee_rate_by_volume = 1.;
+        return detail;
+    }
+    void check_state(const Counter& counter, const TradeInfo& trade_info, const std::string& where)
+    {
+        for (const auto& [symbol, expect] : counter.query_position_data())
+        {
+            const auto& position = *trade_info._position_data.find(symbol)->second;
+            for (auto side : {&data_type::PositionData::long_position, &data_type::PositionData::short_position})
+            {
+                const auto& info = position.*side;
+                const auto& expect_info = expect.*side;
+                check(
+                    info == expect_info && info.yd_position == expect_info.yd_position && info.yd_frozen == expect_info.yd_frozen,
+                    std::format(
+                        "{} {} {} position/frozen/pending/yd/yd_frozen local {}/{}/{}/{}/{} counter {}/{}/{}/{}/{}",
+                        where, symbol.symbol.view(), side == &data_type::PositionData::long_position ? "long" : "short",
+                        info.position, info.frozen, info.pending, info.yd_position, info.yd_frozen,
+                        expect_info.position, expect_info.frozen, expect_info.pending, expect_info.yd_position, expect_info.yd_frozen
+                    )
+                );
+            }
+        }
+        const auto& orders = counter.orders();
+        check(trade_info._order_data.size() == orders.size(), std::format("{} order num {} counter {}", where, trade_info._order_data.size(), orders.size()));
+        bool working_open = false;
+        for (size_t order_ref = 0; order_ref < orders.size(); ++order_ref)
+        {
+            const auto& order = trade_info._order_data[order_ref];
+            const auto& expect = orders[order_ref];
+            check(
+                order.traded_volume == expect.traded && order.canceled_volume == expect.canceled &&
+                order.remain_volume == expect.remain && order.is_finished() == expect.finished() &&
+                order.is_rejected() == expect.rejected,
+                std::format(
+                    "{} order ref {} traded/canceled/remain local {}/{}/{} counter {}/{}/{}",
+                    where, order_ref, order.traded_volume, order.canceled_volume, order.remain_volume, expect.traded, expect.canceled, expect.remain
+                )
+            );
+            working_open |= expect.req.offset == data_type::Offset::OPEN && !expect.finished();
+        }
+        const auto frozen_margin = trade_info._account_data.frozen_margin;
+        check(frozen_margin > -1e-6, std::format("{} frozen margin {} negative", where, frozen_margin));
+        check(working_open || std::abs(frozen_margin) < 1e-6, std::format("{} frozen margin {} left without working open order", where, frozen_margin));
+    }
+    void run(uint32_t seed, size_t steps, const std::filesystem::path& journal_path)
+    {
+        std::filesystem::remove_all(journal_path);
+        config_type::AccountConfig account_config{"oms_test", 1024, 4096, journal_path.string()};
+        const std::vector<data_type::Symbol> symbols{
+            make_symbol("rb2601", data_type::Exchange::SHFE, data_type::ProductClass::FUTURE),
+            make_symbol("IF2601", data_type::Exchange::CFFEX, data_type::ProductClass::FUTURE),
+            make_symbol("600000", data_type::Exchange::SSE, data_type::ProductClass::STOCK),
+        };
+        auto market_info = std::make_shared<MarketInfo>();
+        market_info->_symbol_details[symbols[0]] = make_detail(symbols[0], 10, 0.1);
+        market_info->_symbol_details[symbols[1]] = make_detail(symbols[1], 300, 0.12);
+        market_info->_symbol_details[symbols[2]] = make_detail(symbols[2], 1, 1.);
+        Counter counter;
+        auto trade_info = std::make_shared<TradeInfo>();
+        trade_info->_account_name = account_config.account_name;
+        trade_info->_account_data.balance = trade_info->_account_data.available = 1e9;
+        for (const auto& symbol : symbols)
+        {
+            const auto short_yd = symbol.product_class == data_type::ProductClass::STOCK ? 0u : 20u;
+            counter.add_position(symbol, 20, short_yd);
+            trade_info->_position_data[symbol] = std::make_shared<data_type::PositionData>(counter.query_position_data().at(symbol));
+        }
+        OMS oms(account_config);
+        oms.set_market_info(market_info);
+        oms.set_trade_info(trade_info);
+        oms.write_checkpoint();
+
+        std::mt19937 rng(seed);
+        const auto random = [&rng](uint32_t begin, uint32_t end) {return std::uniform_int_distribution<uint32_t>(begin, end)(rng);};
+        std::vector<double> prices{3500., 4000., 10.};
+        const auto push_tick = [&](size_t i)
+        {
+            data_type::TickData tick;
+            tick.symbol = symbols[i];
+            tick.last_price = prices[i];
+            oms.handle_tick(tick);
+        };
+        for (size_t i = 0; i < symbols.size(); ++i) push_tick(i);
+        const auto working_orders = [&counter]()
+        {
+            std::vector<data_type::OrderRef> refs;
+            for (size_t order_ref = 0; order_ref < counter.orders().size(); ++order_ref)
+            {
+                if (!counter.orders()[order_ref].finished()) refs.push_back(static_cast<data_type::OrderRef>(order_ref));
+            }
+            return refs;
+        };
+        uint32_t trade_id = 0;
+        const auto make_trade = [&](data_type::OrderRef order_ref, uint32_t volume)
+        {
+            const auto& req = counter.orders()[order_ref].req;
+            const auto symbol_index = std::find(symbols.begin(), symbols.end(), req.symbol) - symbols.begin();
+            const auto price = req.limit_price > 0. ? req.limit_price : prices[symbol_index];
+            return data_type::TradeData{order_ref, std::format("T{}", ++trade_id), price, volume, market_info->_trading_day, util::DateTime::now(), 0.};
+        };
+        const auto make_cancel = [&](data_type::OrderRef order_ref, uint32_t volume)
+        {
+            return data_type::CancelData{order_ref, volume, market_info->_trading_day, util::DateTime::now()};
+        };
+        std::vector<data_type::TradeData> delivered_trades;
+        for (size_t step = 0; step < steps; ++step)
+        {
+            const auto working = working_orders();
+            const auto action = working.empty() ? 0 : random(0, 9);
+            std::string where;
+            if (action <= 2)
+            {
+                // 报单, 平仓不超过可平数量, 无可平时改为开仓
+                const auto i = random(0, static_cast<uint32_t>(symbols.size() - 1));
+                const auto& symbol = symbols[i];
+                const auto is_stock = symbol.product_class == data_type::ProductClass::STOCK;
+                data_type::OrderReq req{symbol, random(0, 3) == 0 ? 0. : prices[i], random(1, 5)};
+                req.direction = random(0, 1) ? data_type::Direction::LONG : data_type::Direction::SHORT;
+                constexpr data_type::Offset offsets[] = {data_type::Offset::OPEN, data_type::Offset::CLOSE, data_type::Offset::CLOSE_TD, data_type::Offset::CLOSE_YD};
+                req.offset = is_stock
+                    ? (req.direction == data_type::Direction::LONG ? data_type::Offset::OPEN : data_type::Offset::CLOSE)
+                    : offsets[random(0, 3)];
+                if (req.offset != data_type::Offset::OPEN)
+                {
+                    const auto closable = counter.closable_volume(req);
+                    if (closable == 0)
+                    {
+                        req.offset = data_type::Offset::OPEN;
+                        if (is_stock) req.direction = data_type::Direction::LONG;
+                    }
+                    else req.volume = std::min(req.volume, closable);
+                }
+                const auto order_ref = oms.order_insert(req, false);
+                check(order_ref.has_value(), std::format("seed {} step {} order insert rejected", seed, step));
+                counter.insert(req);
+                where = std::format("insert ref {}", *order_ref);
+            }
+            else if (action <= 4)
+            {
+                // 部分或全部成交
+                const auto order_ref = working[random(0, static_cast<uint32_t>(working.size() - 1))];
+                const auto volume = random(1, counter.orders()[order_ref].remain);
+                const auto trade = make_trade(order_ref, volume);
+                check(oms.handle_trade(trade), std::format("trade ref {} not handled", order_ref));
+                counter.trade(order_ref, volume);
+                delivered_trades.push_back(trade);
+                where = std::format("trade ref {} volume {}", order_ref, volume);
+            }
+            else if (action == 5)
+            {
+                // 撤单
+                const auto order_ref = working[random(0, static_cast<uint32_t>(working.size() - 1))];
+                const auto volume = counter.orders()[order_ref].remain;
+                check(oms.handle_cancel(make_cancel(order_ref, volume)), std::format("cancel ref {} not handled", order_ref));
+                counter.cancel(order_ref, volume);
+                where = std::format("cancel ref {}", order_ref);
+            }
+            else if (action == 6)
+            {
+                // 撤单回报先于撤单前的成交回报到达, 撤单数量多计
+                const auto order_ref = working[random(0, static_cast<uint32_t>(working.size() - 1))];
+                const auto remain = counter.orders()[order_ref].remain;
+                const auto volume = random(1, remain);
+                oms.handle_cancel(make_cancel(order_ref, remain));
+                const auto trade = make_trade(order_ref, volume);
+                check(oms.handle_trade(trade), std::format("late trade ref {} not handled", order_ref));
+                counter.trade(order_ref, volume);
+                counter.cancel(order_ref, remain - volume);
+                delivered_trades.push_back(trade);
+                where = std::format("cancel before trade ref {} volume {}", order_ref, volume);
+            }
+            else if (action == 7)
+            {
+                // 拒单只发生在无成交的委托
+                const auto order_ref = working[random(0, static_cast<uint32_t>(working.size() - 1))];
+                if (counter.orders()[order_ref].traded > 0) continue;
+                oms.handle_error(data_type::OrderError{market_info->_trading_day, order_ref, data_type::ErrorType::ORDER_INSERT_ERROR, "rejected"});
+                counter.reject(order_ref);
+                where = std::format("reject ref {}", order_ref);
+            }
+            else if (action == 8)
+            {
+                // 重复推送的成交回报和终态后的撤单回报应被忽略
+                if (!delivered_trades.empty())
+                {
+                    const auto& trade = delivered_trades[random(0, static_cast<uint32_t>(delivered_trades.size() - 1))];
+                    check(!oms.handle_trade(trade), std::format("duplicate trade {} handled", trade.trade_id.view()));
+                }
+                for (size_t order_ref = 0; order_ref < counter.orders().size(); ++order_ref)
+                {
+                    const auto& order = counter.orders()[order_ref];
+                    if (!order.finished() || order.rejected || order.canceled == 0) continue;
+                    check(!oms.handle_cancel(make_cancel(static_cast<data_type::OrderRef>(order_ref), 1)), std::format("stale cancel ref {} handled", order_ref));
+                    break;
+                }
+                where = "duplicate";
+            }
+            else
+            {
+                // 行情变动, 市价单冻结与释放价格不同
+                const auto i = random(0, static_cast<uint32_t>(symbols.size() - 1));
+                prices[i] = std::max(prices[i] * (1. + (static_cast<double>(random(0, 200)) - 100.) / 10000.), 0.01);
+                push_tick(i);
+                where = std::format("tick {}", symbols[i].symbol.view());
+            }
+            check_state(counter, *trade_info, std::format("seed {} step {} {}", seed, step, where));
+        }
+        // 撤掉全部在途委托后冻结归零
+        for (const auto order_ref : working_orders())
+        {
+            const auto volume = counter.orders()[order_ref].remain;
+            oms.handle_cancel(make_cancel(order_ref, volume));
+            counter.cancel(order_ref, volume);
+        }
+        check_state(counter, *trade_info, std::format("seed {} cancel all", seed));
+        // 从预写日志重建
+        OMS restored_oms(account_config);
+        restored_oms.set_market_info(market_info);
+        const auto restored = restored_oms.restore_trade_info();
+        check(restored != nullptr, std::format("seed {} journal restore failed", seed));
+        check_state(counter, *restored, std::format("seed {} journal restore", seed));
+    }
+    // 日志写满前拒绝新报单, 已接受的委托全部可从日志恢复
+    void run_journal_full(const std::filesystem::path& journal_path)
+    {
+        std::filesystem::remove_all(journal_path);
+        config_type::AccountConfig account_config{"oms_test_full", 8, 8, journal_path.string()};
+        const auto symbol = make_symbol("rb2601", data_type::Exchange::SHFE, data_type::ProductClass::FUTURE);
+        auto market_info = std::make_shared<MarketInfo>();
+        market_info->_symbol_details[symbol] = make_detail(symbol, 10, 0.1);
+        auto trade_info = std::make_shared<TradeInfo>();
+        trade_info->_account_name = account_config.account_name;
+        trade_info->_account_data.balance = trade_info->_account_data.available = 1e9;
+        OMS oms(account_config);
+        oms.set_market_info(market_info);
+        oms.set_trade_info(trade_info);
+        oms.write_checkpoint();
+        size_t accepted_num = 0;
+        for (size_t i = 0; i < 64; ++i)
+        {
+            data_type::OrderReq req{symbol, 3500., 1};
+            req.direction = data_type::Direction::LONG;
+            req.offset = data_type::Offset::OPEN;
+            if (!oms.order_insert(req, false)) break;
+            ++accepted_num;
+        }
+        check(accepted_num > 0 && accepted_num < 64, std::format("journal full accepted order num {}", accepted_num));
+        OMS restored_oms(account_config);
+        restored_oms.set_market_info(market_info);
+        const auto restored = restored_oms.restore_trade_info();
+        check(restored != nullptr, "journal full restore failed");
+        check(
+            restored->_order_data.size() == accepted_num,
+            std::format("journal full restored order num {} accepted {}", restored->_order_data.size(), accepted_num)
+        );
+    }
+    // 从日志快照恢复的资金已按本地口径盯市, 重新盯市后与恢复前一致, 股票盈亏不重复扣除
+    void run_checkpoint_account(const std::filesystem::path& journal_path)
+    {
+        std::filesystem::remove_all(journal_path);
+        config_type::AccountConfig account_config{"oms_test_account", 64, 64, journal_path.string()};
+        const std::vector<data_type::Symbol> symbols{
+            make_symbol("600000", data_type::Exchange::SSE, data_type::ProductClass::STOCK),
+            make_symbol("rb2601", data_type::Exchange::SHFE, data_type::ProductClass::FUTURE),
+        };
+        auto market_info = std::make_shared<MarketInfo>();
+        market_info->_symbol_details[symbols[0]] = make_detail(symbols[0], 1, 1.);
+        market_info->_symbol_details[symbols[1]] = make_detail(symbols[1], 10, 0.1);
+        auto trade_info = std::make_shared<TradeInfo>();
+        trade_info->_account_name = account_config.account_name;
+        trade_info->_account_data.balance = trade_info->_account_data.available = 1e6;
+        trade_info->_account_data.market_value = 1000.;
+        auto stock_position = std::make_shared<data_type::PositionData>(symbols[0]);
+        stock_position->long_position.position = stock_position->long_position.yd_position = 100;
+        stock_position->long_position.cost = 1000.;
+        trade_info->_position_data[symbols[0]] = stock_position;
+        auto future_position = std::make_shared<data_type::PositionData>(symbols[1]);
+        future_position->long_position.position = future_position->long_position.yd_position = 2;
+        future_position->long_position.cost = 70000.;
+        trade_info->_position_data[symbols[1]] = future_position;
+        const auto push_tick = [](OMS& oms, const data_type::Symbol& symbol, double last_price)
+        {
+            data_type::TickData tick;
+            tick.symbol = symbol;
+            tick.last_price = last_price;
+            oms.handle_tick(tick);
+        };
+        OMS oms(account_config);
+        oms.set_market_info(market_info);
+        oms.set_trade_info(trade_info);
+        push_tick(oms, symbols[0], 12.);
+        push_tick(oms, symbols[1], 3600.);
+        oms.write_checkpoint();
+        const auto expect = trade_info->_account_data;
+
+        OMS restored_oms(account_config);
+        restored_oms.set_market_info(market_info);
+        const auto restored = restored_oms.restore_trade_info();
+        check(restored != nullptr, "checkpoint account restore failed");
+        push_tick(restored_oms, symbols[0], 12.);
+        push_tick(restored_oms, symbols[1], 3600.);
+        const auto& account = restored->_account_data;
+        check(
+            std::abs(account.balance - expect.balance) < 1e-6 && std::abs(account.available - expect.available) < 1e-6 &&
+            std::abs(account.market_value - expect.market_value) < 1e-6 && std::abs(account.position_profit - expect.position_profit) < 1e-6,
+            std::format(
+                "checkpoint account balance/available/market_value/position_profit restored {}/{}/{}/{} expect {}/{}/{}/{}",
+                account.balance, account.available, account.market_value, account.position_profit,
+                expect.balance, expect.available, expect.market_value, expect.position_profit
+            )
+        );
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const auto begin_seed = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1u;
+    const auto seed_num = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 100u;
+    const auto steps = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 500ull;
+    // 回报乱序和重复的告警属于预期
+    util::get_logger()->set_log_level(quill::LogLevel::Error);
+    const auto journal_path = std::filesystem::temp_directory_path() / std::format("rk_oms_test_{}", ::getpid());
+    int ret = 0;
+    for (auto seed = begin_seed; seed < begin_seed + seed_num; ++seed)
+    {
+        try
+        {
+            run(seed, steps, journal_path);
+        }
+        catch (const CheckFailed& e)
+        {
+            std::cerr << "FAILED " << e.msg << std::endl;
+            ret = 1;
+            break;
+        }
+    }
+    if (ret == 0)
+    {
+        try
+        {
+            run_journal_full(journal_path);
+            run_checkpoint_account(journal_path);
+        }
+        catch (const CheckFailed& e)
+        {
+            std::cerr << "FAILED " << e.msg << std::endl;
+            ret = 1;
+        }
+    }
+    std::filesystem::remove_all(journal_path);
+    if (ret == 0) std::cout << "passed, seed " << begin_seed << " ~ " << begin_seed + seed_num - 1 << ", steps " << steps << std::endl;
+    return ret;
+}
@@ -5,17 +5,60 @@
 #pragma once
 #include <thread>
 #include <string_view>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+#include <type_traits>
+#include <memory>
+#include <format>
 #include "pqxx/pqxx"
 #include "readerwriterqueue.h"
 #include "config_type.h"
+#include "data_type.h"
 #include "util/logger.h"
 namespace rk::db
 {
     namespace table
     {
+        // 可空字段
+        template<typename T>
+        std::optional<T> nullable(bool has_value, T value)
+        {
+            return has_value ? std::optional<T>(value) : std::nullopt;
+        }
         struct logs
         {
             static constexpr std::string_view table_name = "rookietrader_logs";
+            static constexpr bool bulk_copy = true;   // 建表列顺序与插入列顺序一致, 批量写入走COPY
+            struct row
+            {
+                uint32_t                                trading_day = 0;
+                util::FixedString<32>                   account_name;
+                data_type::Symbol                       symbol;             // 为空时合约字段落库为NULL
+                std::optional<data_type::OrderRef>      order_ref;
+                util::FixedString<32>                   event_type;
+                util::FixedString<1024>                 logs;
+                util::FixedString<8>                    log_level;
+                util::DateTime                          action_time;
+                util::DateTime                          insert_time;
+            };
+            static auto fields(const row& r)
+            {
+                const bool has_symbol = !r.symbol.symbol.empty();
+                return std::make_tuple(
+                    r.trading_day, r.account_name.view(),
+                    nullable(has_symbol, r.symbol.symbol.view()),
+                    nullable(has_symbol, r.symbol.trade_symbol.view()),
+                    nullable(has_symbol, magic_enum::enum_name(r.symbol.exchange)),
+                    nullable(has_symbol, magic_enum::enum_name(r.symbol.product_class)),
+                    r.order_ref, r.event_type.view(), r.logs.view(), r.log_level.view(),
+                    r.action_time.strftime(), r.insert_time.strftime()
+                );
+            }
             static constexpr std::string_view create_table = R"(
                 CREATE TABLE IF NOT EXISTS rookietrader_logs (
                     trading_day DATE NOT NULL,
@@ -42,6 +85,28 @@ namespace rk::db
         struct orders
         {
             static constexpr std::string_view table_name = "rookietrader_orders";
+            static constexpr std::string_view clear = "DELETE FROM rookietrader_orders WHERE trading_day = $1 AND account_name = $2;";   // 快照覆盖写入
+            static constexpr std::string_view erase = "DELETE FROM rookietrader_orders WHERE trading_day = $1 AND account_name = $2 AND order_ref = ANY($3::int[]);";   // 增量快照覆盖变化的委托
+            static constexpr bool bulk_copy = true;
+            struct row
+            {
+                uint32_t                                trading_day = 0;
+                util::FixedString<32>                   account_name;
+                data_type::OrderData                    order;
+                util::DateTime                          insert_time;
+            };
+            static auto fields(const row& r)
+            {
+                const auto& req = r.order.order_req;
+                return std::make_tuple(
+                    r.trading_day, r.account_name.view(), r.order.order_ref,
+                    req.symbol.symbol.view(), req.symbol.trade_symbol.view(),
+                    magic_enum::enum_name(req.symbol.exchange), magic_enum::enum_name(req.symbol.product_class),
+                    req.limit_price, req.volume, magic_enum::enum_name(req.direction), magic_enum::enum_name(req.offset),
+                    r.order.req_time.strftime(), r.order.traded_volume, r.order.remain_volume, r.order.canceled_volume,
+                    r.insert_time.strftime(), magic_enum::enum_name(r.order.status)
+                );
+            }
             static constexpr std::string_view create_table = R"(
                 CREATE TABLE IF NOT EXISTS rookietrader_orders (
                     trading_day DATE NOT NULL,
@@ -59,19 +124,44 @@ namespace rk::db
                     traded_volume INT NOT NULL,
                     remain_volume INT NOT NULL,
                     canceled_volume INT NOT NULL,
-                    insert_time TIME NOT NULL
+                    insert_time TIME NOT NULL,
+                    status TEXT NOT NULL
                 );
+                ALTER TABLE rookietrader_orders ADD COLUMN IF NOT EXISTS status TEXT NOT NULL DEFAULT 'UNKNOWN';
                 CREATE INDEX IF NOT EXISTS rookietrader_orders_idx ON rookietrader_orders USING btree (trading_day, account_name, symbol);
             )";
             static constexpr std::string_view insert = R"(
                 INSERT INTO rookietrader_orders
-                (trading_day,account_name,order_ref,symbol,trade_symbol,exchange,product_class,limit_price,volume,direction,"offset",req_time,traded_volume,remain_volume,canceled_volume,insert_time) VALUES
-                ($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12,$13,$14,$15,$16);
+                (trading_day,account_name,order_ref,symbol,trade_symbol,exchange,product_class,limit_price,volume,direction,"offset",req_time,traded_volume,remain_volume,canceled_volume,insert_time,status) VALUES
+                ($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12,$13,$14,$15,$16,$17);
             )";
         };
         struct trades
         {
             static constexpr std::string_view table_name = "rookietrader_trades";
+            static constexpr std::string_view clear = "DELETE FROM rookietrader_trades WHERE trading_day = $1 AND account_name = $2;";   // 快照覆盖写入
+            static constexpr std::string_view erase = "DELETE FROM rookietrader_trades WHERE trading_day = $1 AND account_name = $2 AND order_ref = ANY($3::int[]);";
+            static constexpr bool bulk_copy = true;
+            struct row
+            {
+                uint32_t                                trading_day = 0;
+                util::FixedString<32>                   account_name;
+                data_type::OrderReq                     order_req;
+                data_type::TradeData                    trade;
+                util::DateTime                          insert_time;
+            };
+            static auto fields(const row& r)
+            {
+                const auto& req = r.order_req;
+                return std::make_tuple(
+                    r.trading_day, r.account_name.view(), r.trade.order_ref,
+                    req.symbol.symbol.view(), req.symbol.trade_symbol.view(),
+                    magic_enum::enum_name(req.symbol.exchange), magic_enum::enum_name(req.symbol.product_class),
+                    req.limit_price, req.volume, magic_enum::enum_name(req.direction), magic_enum::enum_name(req.offset),
+                    r.trade.trade_id.view(), r.trade.trade_price, r.trade.trade_volume, r.trade.trade_time.strftime(), r.trade.fee,
+                    r.insert_time.strftime()
+                );
+            }
             static constexpr std::string_view create_table = R"(
                 CREATE TABLE IF NOT EXISTS rookietrader_trades (
                     trading_day DATE NOT NULL,
@@ -103,6 +193,27 @@ namespace rk::db
         struct positions
         {
             static constexpr std::string_view table_name = "rookietrader_positions";
+            static constexpr std::string_view clear = "DELETE FROM rookietrader_positions WHERE trading_day = $1 AND account_name = $2;";   // 快照覆盖写入
+            static constexpr std::string_view erase = "DELETE FROM rookietrader_positions WHERE trading_day = $1 AND account_name = $2 AND symbol = ANY($3::text[]);";
+            static constexpr bool bulk_copy = true;
+            struct row
+            {
+                uint32_t                                trading_day = 0;
+                util::FixedString<32>                   account_name;
+                data_type::PositionData                 position;
+                util::DateTime                          insert_time;
+            };
+            static auto fields(const row& r)
+            {
+                const auto& symbol = r.position.symbol;
+                return std::make_tuple(
+                    r.trading_day, r.account_name.view(),
+                    symbol.symbol.view(), symbol.trade_symbol.view(),
+                    magic_enum::enum_name(symbol.exchange), magic_enum::enum_name(symbol.product_class),
+                    r.position.long_position.position, r.position.short_position.position,
+                    r.insert_time.strftime()
+                );
+            }
             static constexpr std::string_view create_table = R"(
                 CREATE TABLE IF NOT EXISTS rookietrader_positions (
                     trading_day DATE NOT NULL,
@@ -126,6 +237,24 @@ namespace rk::db
         struct risk_indicators
         {
             static constexpr std::string_view table_name = "rookietrader_risk_indicators";
+            static constexpr bool bulk_copy = false;   // ON CONFLICT更新, 批量写入逐行执行
+            struct row
+            {
+                uint32_t                                trading_day = 0;
+                util::FixedString<32>                   account_name;
+                int                                     daily_order_num = 0;
+                int                                     daily_cancel_num = 0;
+                int                                     daily_repeat_order_num = 0;
+                util::DateTime                          insert_time;
+            };
+            static auto fields(const row& r)
+            {
+                return std::make_tuple(
+                    r.trading_day, r.account_name.view(),
+                    r.daily_order_num, r.daily_cancel_num, r.daily_repeat_order_num,
+                    r.insert_time.strftime()
+                );
+            }
             static constexpr std::string_view create_table = R"(
                 CREATE TABLE IF NOT EXISTS rookietrader_risk_indicators (
                     trading_day DATE NOT NULL,
@@ -147,8 +276,63 @@ namespace rk::db
         };
     };
 
+    /// 单表批量写入统计
+    struct BatchStats
+    {
+        uint64_t row_num = 0;
+        uint64_t failed_row_num = 0;
+        uint64_t dropped_row_num = 0;       // 队列满丢弃
+        uint64_t batch_num = 0;
+        uint64_t max_batch_size = 0;
+        std::chrono::microseconds flush_time{0};
+    };
+    /// 交易数据快照(委托/成交/持仓/风控指标), 整体一个事务写入
+    /// 增量快照只含变化的委托及其全部成交和所涉合约持仓, 按委托号和合约覆盖
+    struct Snapshot
+    {
+        uint32_t                                    trading_day = 0;
+        util::FixedString<32>                       account_name;
+        bool                                        full = true;
+        std::vector<data_type::OrderRef>            order_refs;     // 增量快照覆盖的委托
+        std::vector<data_type::Symbol>              symbols;        // 增量快照覆盖的合约持仓, 空持仓只删除
+        std::vector<table::orders::row>             orders;
+        std::vector<table::trades::row>             trades;
+        std::vector<table::positions::row>          positions;
+        table::risk_indicators::row                 risk_indicators;
+    };
+    /// 异步写入队列满时的处理策略
+    enum class BackpressurePolicy
+    {
+        DROP,   // 丢弃并计数, 引擎线程不阻塞
+        BLOCK   // 自旋等待写入线程腾出空间
+    };
     class Executor
     {
+        // 每张表一个预分配的定长记录队列, 入队为一次按值拷贝
+        template<typename Table>
+        struct TableQueue
+        {
+            using row = typename Table::row;
+            static_assert(std::is_trivially_copyable_v<row>, "db row must be trivially copyable");
+            static constexpr std::string_view table_name = Table::table_name;
+            void reserve(size_t capacity, size_t batch_size)
+            {
+                queue = moodycamel::ReaderWriterQueue<row>(capacity);
+                batch.reserve(batch_size);
+            }
+            moodycamel::ReaderWriterQueue<row> queue;
+            std::atomic<uint64_t> dropped_row_num = 0;
+            // 仅写入线程访问
+            std::vector<row> batch;
+            std::chrono::steady_clock::time_point deadline;
+        };
+        using TableQueues = std::tuple<
+            TableQueue<table::logs>,
+            TableQueue<table::orders>,
+            TableQueue<table::trades>,
+            TableQueue<table::positions>,
+            TableQueue<table::risk_indicators>
+        >;
     public:
         explicit Executor(const config_type::DBConfig& db_config)
         :
@@ -159,37 +343,32 @@ namespace rk::db
         _sync_engine(std::format(
             "host={} port={} dbname={} user={} password={}",
             db_config.ip, db_config.port, db_config.database, db_config.user, db_config.password
-        ))
+        )),
+        _batch_size(std::max<size_t>(db_config.batch_size, 1)),
+        _flush_interval(db_config.flush_interval_ms),
+        _backpressure(db_config.backpressure == "block" ? BackpressurePolicy::BLOCK : BackpressurePolicy::DROP)
         {
+            std::apply([&db_config, this](auto&... queues) {(queues.reserve(std::max<size_t>(db_config.queue_capacity, 1), _batch_size), ...);}, _queues);
             create_table_if_not_exists();
             prepare_stmt();
 
             _busy_worker = std::make_unique<std::jthread>([this](std::stop_token st) -> void
             {
-                std::tuple<std::function<void()>, std::function<void(bool)>> sql_task;
                 while (!st.stop_requested())
                 {
-                    if (_spsc_queue.try_dequeue(sql_task))
-                    {
-                        bool success = false;
-                        auto& [task, callback] = sql_task;
-                        try
-                        {
-                            task();
-                            success = true;
-                        }
-                        catch (const std::exception& e)
-                        {
-                            std::cout << e.what();
-//                            RK_LOG_WARN("sql exec error: %s", e.what());
-                        }
-                        if (callback) callback(success);
-                    }
-                    else
+                    // 各表队列取入批次, 满批立即刷出, 未满的批次等到截止时间
+                    const auto dequeued = std::apply([this](auto&... queues) {return (drain_queue(queues) | ...);}, _queues);
+                    const auto now = std::chrono::steady_clock::now();
+                    std::apply([this, now](auto&... queues)
                     {
-                        std::this_thread::sleep_for(std::chrono::microseconds(100));
-                    }
+                        ((queues.batch.empty() || now < queues.deadline ? void() : flush(queues)), ...);
+                    }, _queues);
+                    const auto snapshot_dequeued = write_snapshots();
+                    if (!dequeued && !snapshot_dequeued) std::this_thread::sleep_for(std::chrono::microseconds(100));
                 }
+                // 退出前刷出剩余数据
+                std::apply([this](auto&... queues) {(drain_queue(queues), ...); (flush(queues), ...);}, _queues);
+                write_snapshots(true);
             });
         }
         bool exec_sync(std::string_view sql)
@@ -225,30 +404,178 @@ namespace rk::db
             }
             return success;
         }
-        template<typename... Args>
-        bool insert_async(std::string_view table_name, std::function<void(bool)> callback, Args&&... args)
+        // 按值入队, 不分配内存; 队列满时按背压策略丢弃或等待, 丢弃返回false
+        template<typename Table>
+        bool insert_async(const typename Table::row& row)
+        {
+            auto& queue = std::get<TableQueue<Table>>(_queues);
+            if (queue.queue.try_enqueue(row)) return true;
+            if (_backpressure == BackpressurePolicy::BLOCK)
+            {
+                while (!queue.queue.try_enqueue(row)) std::this_thread::yield();
+                return true;
+            }
+            queue.dropped_row_num.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 快照由调用方构造后不再修改, 写入线程持有只读引用, 调用方无需等待写入完成
+        bool insert_snapshot_async(std::shared_ptr<const Snapshot> snapshot)
+        {
+            return _snapshot_queue.try_enqueue(std::move(snapshot));
+        }
+        // 各表批量写入统计
+        [[nodiscard]] std::unordered_map<std::string_view, BatchStats> batch_stats() const
+        {
+            std::unordered_map<std::string_view, BatchStats> ret;
+            {
+                auto lock = std::lock_guard(_stats_mutex);
+                ret = _stats;
+            }
+            std::apply([&ret](const auto&... queues)
+            {
+                ((ret[std::decay_t<decltype(queues)>::table_name].dropped_row_num = queues.dropped_row_num.load(std::memory_order_relaxed)), ...);
+            }, _queues);
+            return ret;
+        }
+    private:
+        // 返回是否取到数据
+        template<typename Table>
+        bool drain_queue(TableQueue<Table>& queue)
         {
-            auto task = [
-                this,
-                name = std::string(table_name),
-                args_tuple = std::make_tuple(std::forward<Args>(args)...)
-            ]() mutable
+            bool dequeued = false;
+            typename Table::row row;
+            while (queue.queue.try_dequeue(row))
+            {
+                dequeued = true;
+                if (queue.batch.empty()) queue.deadline = std::chrono::steady_clock::now() + _flush_interval;
+                queue.batch.push_back(row);
+                if (queue.batch.size() >= _batch_size) flush(queue);
+            }
+            return dequeued;
+        }
+        // 一个批次一个事务
+        template<typename Table>
+        void flush(TableQueue<Table>& queue)
+        {
+            if (queue.batch.empty()) return;
+            const auto begin = std::chrono::steady_clock::now();
+            bool success = false;
+            try
             {
                 pqxx::work tx(_async_engine);
-                std::apply([&](auto&&... unpacked_args)
-                    {
-                        tx.exec(
-                            pqxx::prepped{std::format("insert_{}", name)},
-                            pqxx::params{std::forward<decltype(unpacked_args)>(unpacked_args)...}
-                        );
-                    },
-                    args_tuple
-                );
+                write_rows<Table>(tx, queue.batch);
                 tx.commit();
-            };
-            return _spsc_queue.try_enqueue(std::make_tuple(std::move(task), std::move(callback)));
+                success = true;
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << e.what();
+//                RK_LOG_WARN("sql exec error: %s", e.what());
+            }
+            update_stats(Table::table_name, queue.batch.size(), success, std::chrono::steady_clock::now() - begin);
+            queue.batch.clear();
+        }
+        // 增量快照按顺序全部写入, 积压时从最后一份全量快照开始
+        // 写入失败的快照及其后的增量保留, 间隔重试, 新的全量快照到达后以其为准
+        bool write_snapshots(bool retry_now = false)
+        {
+            std::shared_ptr<const Snapshot> snapshot;
+            bool dequeued = false;
+            while (_snapshot_queue.try_dequeue(snapshot))
+            {
+                dequeued = true;
+                if (snapshot->full) _pending_snapshots.clear();
+                _pending_snapshots.push_back(std::move(snapshot));
+            }
+            if (_pending_snapshots.empty() || (!retry_now && std::chrono::steady_clock::now() < _snapshot_retry_time)) return dequeued;
+            size_t written_num = 0;
+            while (written_num < _pending_snapshots.size() && write_snapshot(*_pending_snapshots[written_num])) ++written_num;
+            _pending_snapshots.erase(_pending_snapshots.begin(), _pending_snapshots.begin() + static_cast<std::ptrdiff_t>(written_num));
+            if (!_pending_snapshots.empty())
+            {
+                _snapshot_retry_time = std::chrono::steady_clock::now() + snapshot_retry_interval;
+                RK_LOG_WARN("snapshot write failed, pending snapshot num {}, retry later", _pending_snapshots.size());
+            }
+            return dequeued;
+        }
+        // 快照整体一个事务, 全量快照先清除当日旧快照, 增量快照先删除覆盖的委托/成交/持仓, 风控指标按唯一键更新
+        bool write_snapshot(const Snapshot& snapshot)
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            bool success = false;
+            try
+            {
+                pqxx::work tx(_async_engine);
+                // 增量删除条件以数组字面量传入, 一张表一条语句
+                std::string order_refs;
+                std::string symbols;
+                if (!snapshot.full)
+                {
+                    order_refs = "{";
+                    for (const auto order_ref : snapshot.order_refs) order_refs += std::format("{}{}", order_refs.size() > 1 ? "," : "", order_ref);
+                    order_refs += "}";
+                    symbols = "{";
+                    for (const auto& symbol : snapshot.symbols) symbols += std::format("{}\"{}\"", symbols.size() > 1 ? "," : "", symbol.symbol.view());
+                    symbols += "}";
+                }
+                const auto rewrite = [&tx, &snapshot]<typename Table>(const std::vector<typename Table::row>& rows, const std::string& keys)
+                {
+                    if (snapshot.full) tx.exec(pqxx::prepped{std::format("clear_{}", Table::table_name)}, pqxx::params{snapshot.trading_day, snapshot.account_name.view()});
+                    else tx.exec(pqxx::prepped{std::format("erase_{}", Table::table_name)}, pqxx::params{snapshot.trading_day, snapshot.account_name.view(), keys});
+                    write_rows<Table>(tx, rows);
+                };
+                rewrite.template operator()<table::orders>(snapshot.orders, order_refs);
+                rewrite.template operator()<table::trades>(snapshot.trades, order_refs);
+                rewrite.template operator()<table::positions>(snapshot.positions, symbols);
+                write_rows<table::risk_indicators>(tx, {snapshot.risk_indicators});
+                tx.commit();
+                success = true;
+            }
+            catch (const std::exception& e)
+            {
+                RK_LOG_WARN("snapshot sql exec error: {}", e.what());
+            }
+            update_stats(
+                "snapshot",
+                snapshot.orders.size() + snapshot.trades.size() + snapshot.positions.size() + 1,
+                success,
+                std::chrono::steady_clock::now() - begin
+            );
+            return success;
+        }
+        // 可COPY的表整批流式写入, 其余表逐行执行预编译语句
+        template<typename Table>
+        static void write_rows(pqxx::work& tx, const std::vector<typename Table::row>& rows)
+        {
+            if (rows.empty()) return;
+            if constexpr (Table::bulk_copy)
+            {
+                auto stream = pqxx::stream_to::raw_table(tx, tx.quote_name(Table::table_name));
+                for (const auto& row : rows)
+                {
+                    std::apply([&stream](const auto&... values) {stream.write_values(values...);}, Table::fields(row));
+                }
+                stream.complete();
+            }
+            else
+            {
+                const auto stmt = std::format("insert_{}", Table::table_name);
+                for (const auto& row : rows)
+                {
+                    std::apply([&tx, &stmt](const auto&... values) {tx.exec(pqxx::prepped{stmt}, pqxx::params{values...});}, Table::fields(row));
+                }
+            }
+        }
+        void update_stats(std::string_view name, size_t row_num, bool success, std::chrono::steady_clock::duration flush_time)
+        {
+            auto lock = std::lock_guard(_stats_mutex);
+            auto& stats = _stats[name];
+            stats.row_num += row_num;
+            stats.failed_row_num += success ? 0 : row_num;
+            stats.batch_num += 1;
+            stats.max_batch_size = std::max<uint64_t>(stats.max_batch_size, row_num);
+            stats.flush_time += std::chrono::duration_cast<std::chrono::microseconds>(flush_time);
         }
-    private:
         void create_table_if_not_exists()
         {
             exec_sync(db::table::logs::create_table);
@@ -269,10 +596,25 @@ namespace rk::db
             _sync_engine.prepare(std::format("insert_{}", table::trades::table_name).c_str(), table::trades::insert.data());
             _sync_engine.prepare(std::format("insert_{}", table::positions::table_name).c_str(), table::positions::insert.data());
             _sync_engine.prepare(std::format("insert_{}", table::risk_indicators::table_name).c_str(), table::risk_indicators::insert.data());
+            _async_engine.prepare(std::format("clear_{}", table::orders::table_name).c_str(), table::orders::clear.data());
+            _async_engine.prepare(std::format("clear_{}", table::trades::table_name).c_str(), table::trades::clear.data());
+            _async_engine.prepare(std::format("clear_{}", table::positions::table_name).c_str(), table::positions::clear.data());
+            _async_engine.prepare(std::format("erase_{}", table::orders::table_name).c_str(), table::orders::erase.data());
+            _async_engine.prepare(std::format("erase_{}", table::trades::table_name).c_str(), table::trades::erase.data());
+            _async_engine.prepare(std::format("erase_{}", table::positions::table_name).c_str(), table::positions::erase.data());
         }
-        moodycamel::ReaderWriterQueue<std::tuple<std::function<void()>, std::function<void(bool)>>> _spsc_queue;
         pqxx::connection _async_engine;
         pqxx::connection _sync_engine;
+        const size_t _batch_size;
+        const std::chrono::milliseconds _flush_interval;
+        const BackpressurePolicy _backpressure;
+        TableQueues _queues;
+        moodycamel::ReaderWriterQueue<std::shared_ptr<const Snapshot>> _snapshot_queue{16};
+        std::vector<std::shared_ptr<const Snapshot>> _pending_snapshots;    // 仅写入线程访问
+        std::chrono::steady_clock::time_point _snapshot_retry_time;
+        static constexpr auto snapshot_retry_interval = std::chrono::seconds(1);
+        mutable std::mutex _stats_mutex;
+        std::unordered_map<std::string_view, BatchStats> _stats;
         std::unique_ptr<std::jthread> _busy_worker;
     };
 };
\ No newline at end of file
@@ -0,0 +1,178 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <optional>
+#include <vector>
+#include "data_type.h"
+#include "util/flat_map.h"
+
+namespace rk::util
+{
+    /// ETF实时参考净值(IOPV), 按申赎清单增量计算
+    /// IOPV = (sum(成分股数量 * 成分股价格) + 必须现金替代金额 + 预估现金差额) / 最小申赎单位
+    /// 成分股 -> 所属ETF建倒排表, 成分股行情只把价格变化量乘数量累加到所属ETF, 不重算整个篮子
+    /// 成分股价格初始为昨收, 之后取最新价; 仍有成分股无价格的ETF不输出IOPV
+    /// 单线程使用
+    class IOPVCalculator
+    {
+        struct Node
+        {
+            int32_t component_id = -1;
+            int32_t etf_id = -1;
+        };
+        struct Holding
+        {
+            uint32_t etf_id;
+            double quantity;
+        };
+        struct ETFState
+        {
+            double basket_value = 0.;           // 已有价格的成分股市值
+            double cash = 0.;                   // 必须现金替代金额 + 预估现金差额
+            double unit = 0.;
+            uint32_t missing = 0;               // 无价格的成分股数
+            bool dirty = false;                 // 上次flush后IOPV有变化
+            bool has_tick = false;
+            util::DateTime update_time;         // 最近一次引起变化的成分股行情时间
+        };
+    public:
+        template<typename SymbolDetailMap, typename ETFDetailMap>
+        void reset(const SymbolDetailMap& symbol_details, const ETFDetailMap& etf_details)
+        {
+            _nodes.clear();
+            _prices.clear();
+            _offsets.clear();
+            _holdings.clear();
+            _etfs.clear();
+            _etf_ticks.clear();
+            _dirty.clear();
+            // 先按成分股统计持有的ETF数, 再按偏移平铺倒排表
+            std::vector<std::vector<Holding>> holdings;
+            for (const auto& [etf, detail] : etf_details)
+            {
+                if (!detail || detail->unit <= 0) continue;
+                const auto etf_id = static_cast<uint32_t>(_etfs.size());
+                _nodes[etf].etf_id = static_cast<int32_t>(etf_id);
+                auto& state = _etfs.emplace_back();
+                state.unit = static_cast<double>(detail->unit);
+                state.cash = detail->estimate_cash_component;
+                for (const auto& component : detail->component)
+                {
+                    if (component.replace_type == data_type::CashReplaceType::MUST)
+                    {
+                        state.cash += component.creation_amount;
+                        continue;
+                    }
+                    if (component.quantity <= 0) continue;
+                    auto& node = _nodes[component.symbol];
+                    if (node.component_id < 0)
+                    {
+                        node.component_id = static_cast<int32_t>(holdings.size());
+                        holdings.emplace_back();
+                        const auto it = symbol_details.find(component.symbol);
+                        _prices.emplace_back(it != symbol_details.end() && it->second ? it->second->pre_close_price : 0.);
+                    }
+                    holdings[node.component_id].push_back({etf_id, static_cast<double>(component.quantity)});
+                }
+            }
+            _etf_ticks.resize(_etfs.size());
+            _offsets.reserve(holdings.size() + 1);
+            _offsets.push_back(0);
+            for (size_t component_id = 0; component_id < holdings.size(); ++component_id)
+            {
+                const auto price = _prices[component_id];
+                for (const auto& holding : holdings[component_id])
+                {
+                    _holdings.push_back(holding);
+                    auto& state = _etfs[holding.etf_id];
+                    if (price > 0) state.basket_value += holding.quantity * price;
+                    else ++state.missing;
+                }
+                _offsets.push_back(static_cast<uint32_t>(_holdings.size()));
+            }
+            _dirty.reserve(_etfs.size());
+        }
+
+        // 成分股行情更新所属ETF, ETF行情填入IOPV
+        void on_tick(data_type::TickData& tick)
+        {
+            const auto it = _nodes.find(tick.symbol);
+            if (it == _nodes.end()) return;
+            const auto [component_id, etf_id] = it->second;
+            if (component_id >= 0) update_component(static_cast<uint32_t>(component_id), tick);
+            if (etf_id >= 0)
+            {
+                auto& state = _etfs[etf_id];
+                if (const auto value = iopv(state)) tick.iopv = *value;
+                _etf_ticks[etf_id] = tick;
+                state.has_tick = true;
+                state.dirty = false;
+            }
+        }
+        // 输出上次flush以来IOPV变化的ETF, 以该ETF最新行情携带IOPV, 更新时间为引起变化的成分股行情时间
+        // 尚未收到行情的ETF不输出
+        template<typename Func>
+        void flush(Func&& func)
+        {
+            for (const auto etf_id : _dirty)
+            {
+                auto& state = _etfs[etf_id];
+                if (!state.dirty) continue;
+                state.dirty = false;
+                const auto value = iopv(state);
+                if (!state.has_tick || !value) continue;
+                auto& tick = _etf_ticks[etf_id];
+                tick.iopv = *value;
+                tick.update_time = state.update_time;
+                func(tick);
+            }
+            _dirty.clear();
+        }
+
+        [[nodiscard]] std::optional<double> iopv(const data_type::Symbol& etf) const
+        {
+            const auto it = _nodes.find(etf);
+            if (it == _nodes.end() || it->second.etf_id < 0) return std::nullopt;
+            return iopv(_etfs[it->second.etf_id]);
+        }
+        [[nodiscard]] size_t etf_num() const {return _etfs.size();}
+        [[nodiscard]] size_t component_num() const {return _prices.size();}
+
+    private:
+        static std::optional<double> iopv(const ETFState& state)
+        {
+            if (state.missing > 0) return std::nullopt;
+            return (state.basket_value + state.cash) / state.unit;
+        }
+        void update_component(uint32_t component_id, const data_type::TickData& tick)
+        {
+            const auto price = tick.last_price;
+            auto& old_price = _prices[component_id];
+            if (price <= 0 || price == old_price) return;
+            const bool priced = old_price > 0;
+            const auto delta = priced ? price - old_price : price;
+            old_price = price;
+            for (auto i = _offsets[component_id]; i < _offsets[component_id + 1]; ++i)
+            {
+                const auto& holding = _holdings[i];
+                auto& state = _etfs[holding.etf_id];
+                state.basket_value += holding.quantity * delta;
+                if (!priced) --state.missing;
+                state.update_time = tick.update_time;
+                if (state.dirty) continue;
+                state.dirty = true;
+                _dirty.push_back(holding.etf_id);
+            }
+        }
+
+        FlatMap<data_type::Symbol, Node> _nodes;
+        std::vector<double> _prices;                // 按成分股序号
+        std::vector<uint32_t> _offsets;             // 成分股序号 -> 倒排表区间
+        std::vector<Holding> _holdings;
+        std::vector<ETFState> _etfs;                // 按ETF序号
+        std::vector<data_type::TickData> _etf_ticks;
+        std::vector<uint32_t> _dirty;
+    };
+}
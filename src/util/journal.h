@@ -0,0 +1,152 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace rk::util
+{
+    /// 预写日志, 定长记录顺序追加到内存映射文件
+    /// 写入即进入页缓存, 进程崩溃不丢记录; 后台线程按批msync(group commit), 掉电最多丢失一个刷盘周期
+    /// 单线程写入, 记录数在记录拷贝完成后发布, 崩溃时写了一半的记录不计入
+    /// Record::version为记录格式版本, 布局变化时递增; 版本不一致的文件拒绝打开
+    template<typename Record>
+    class Journal
+    {
+        static_assert(std::is_trivially_copyable_v<Record>, "journal record must be trivially copyable");
+        struct Header
+        {
+            uint64_t magic;
+            uint64_t record_size;
+            uint64_t capacity;
+            uint64_t size;
+            uint64_t version;       // 旧文件此处为0
+        };
+        static constexpr uint64_t magic = 0x4c4e524a4b52;   // "RKJRNL"
+        static constexpr size_t header_size = 4096;          // 记录区按页对齐
+    public:
+        Journal(const std::filesystem::path& path, size_t capacity, std::chrono::milliseconds sync_interval)
+        {
+            std::error_code ec;
+            if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), ec);
+            _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+            if (_fd < 0) return;
+            const auto file_size = std::filesystem::file_size(path, ec);
+            if (ec) return;
+            // 新文件按容量预分配, 已有文件沿用文件头中的容量
+            if (file_size == 0)
+            {
+                _file_size = header_size + capacity * sizeof(Record);
+                if (::ftruncate(_fd, static_cast<off_t>(_file_size)) != 0) return;
+            }
+            else
+            {
+                _file_size = file_size;
+            }
+            auto addr = ::mmap(nullptr, _file_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (addr == MAP_FAILED) return;
+            _addr = static_cast<std::byte*>(addr);
+            _header = reinterpret_cast<Header*>(_addr);
+            _records = _addr + header_size;
+            if (file_size == 0)
+            {
+                *_header = Header{magic, sizeof(Record), capacity, 0, Record::version};
+                ::msync(_addr, header_size, MS_SYNC);
+            }
+            else if (
+                _header->magic != magic ||
+                _header->record_size != sizeof(Record) ||
+                _header->version != Record::version ||
+                header_size + _header->capacity * sizeof(Record) > _file_size ||
+                _header->size > _header->capacity
+            )
+            {
+                close();
+                return;
+            }
+            _synced = size();
+            _sync_worker = std::make_unique<std::jthread>([this, sync_interval](std::stop_token st) -> void
+            {
+                while (!st.stop_requested())
+                {
+                    std::this_thread::sleep_for(sync_interval);
+                    sync();
+                }
+            });
+        }
+        ~Journal()
+        {
+            _sync_worker.reset();
+            sync();
+            close();
+        }
+        Journal(const Journal&) = delete;
+        Journal& operator=(const Journal&) = delete;
+
+        [[nodiscard]] bool is_open() const {return _addr != nullptr;}
+        // 容量已满返回false
+        bool append(const Record& record)
+        {
+            const auto index = size();
+            if (index >= _header->capacity) return false;
+            std::memcpy(_records + index * sizeof(Record), &record, sizeof(Record));
+            std::atomic_ref(_header->size).store(index + 1, std::memory_order_release);
+            return true;
+        }
+        // 将已发布的记录刷到磁盘, 一次msync覆盖上次刷盘以来的全部记录
+        void sync()
+        {
+            if (!is_open()) return;
+            auto lock = std::lock_guard(_sync_mutex);
+            const auto size = this->size();
+            if (size == _synced) return;
+            const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            const auto begin = (header_size + _synced * sizeof(Record)) / page_size * page_size;
+            ::msync(_addr + begin, header_size + size * sizeof(Record) - begin, MS_SYNC);
+            ::msync(_addr, header_size, MS_SYNC);
+            _synced = size;
+        }
+        [[nodiscard]] size_t size() const
+        {
+            return is_open() ? std::atomic_ref(_header->size).load(std::memory_order_acquire) : 0;
+        }
+        [[nodiscard]] size_t capacity() const {return is_open() ? _header->capacity : 0;}
+        [[nodiscard]] Record operator[](size_t index) const
+        {
+            Record record;
+            std::memcpy(&record, _records + index * sizeof(Record), sizeof(Record));
+            return record;
+        }
+
+    private:
+        void close()
+        {
+            if (_addr) ::munmap(_addr, _file_size);
+            if (_fd >= 0) ::close(_fd);
+            _addr = nullptr;
+            _header = nullptr;
+            _records = nullptr;
+            _fd = -1;
+        }
+        int _fd = -1;
+        size_t _file_size = 0;
+        std::byte* _addr = nullptr;
+        Header* _header = nullptr;
+        std::byte* _records = nullptr;
+        std::mutex _sync_mutex;
+        size_t _synced = 0;
+        std::unique_ptr<std::jthread> _sync_worker;
+    };
+}
@@ -0,0 +1,138 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rk::util
+{
+    /// 共享内存最新值表, 每个槽位保存一条最新记录, 跨进程读取
+    /// 槽位用顺序锁保护: 写入前版本号置奇数, 写完置偶数; 读取前后版本号一致且为偶数才算读到完整记录
+    /// 每个槽位只允许一个线程写, 不同槽位可以由不同线程并发写
+    /// 写端创建时重建共享内存, 读端按共享内存头中的容量映射
+    template<typename Record>
+    class LastValueStore
+    {
+        static_assert(std::is_trivially_copyable_v<Record>, "last value record must be trivially copyable");
+        struct Header
+        {
+            uint64_t magic;
+            uint64_t record_size;
+            uint64_t capacity;
+        };
+        struct alignas(64) Slot
+        {
+            uint64_t version;       // 0为从未写入
+            Record record;
+        };
+        static constexpr uint64_t magic = 0x5356564c4b52;   // "RKLVVS"
+        static constexpr size_t header_size = 4096;
+    public:
+        // 写端, 名称同shm_open, 以'/'开头
+        LastValueStore(const std::string& name, size_t capacity)
+        {
+            ::shm_unlink(name.c_str());
+            _fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+            if (_fd < 0) return;
+            _size = header_size + capacity * sizeof(Slot);
+            if (::ftruncate(_fd, static_cast<off_t>(_size)) != 0 || !map())
+            {
+                close();
+                return;
+            }
+            // ftruncate得到的内存全部为0, 版本号无需初始化
+            *_header = Header{magic, sizeof(Record), capacity};
+        }
+        // 读端
+        explicit LastValueStore(const std::string& name)
+        {
+            _fd = ::shm_open(name.c_str(), O_RDWR, 0);
+            if (_fd < 0) return;
+            struct stat st{};
+            if (::fstat(_fd, &st) != 0 || static_cast<size_t>(st.st_size) < header_size)
+            {
+                close();
+                return;
+            }
+            _size = static_cast<size_t>(st.st_size);
+            if (!map() ||
+                _header->magic != magic ||
+                _header->record_size != sizeof(Record) ||
+                header_size + _header->capacity * sizeof(Slot) > _size
+            )
+            {
+                close();
+            }
+        }
+        ~LastValueStore() {close();}
+        LastValueStore(const LastValueStore&) = delete;
+        LastValueStore& operator=(const LastValueStore&) = delete;
+
+        [[nodiscard]] bool is_open() const {return _addr != nullptr;}
+        [[nodiscard]] size_t capacity() const {return is_open() ? _header->capacity : 0;}
+        void store(size_t index, const Record& record)
+        {
+            auto& slot = _slots[index];
+            auto version = std::atomic_ref(slot.version);
+            const auto current = version.load(std::memory_order_relaxed);
+            version.store(current + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(&slot.record, &record, sizeof(Record));
+            version.store(current + 2, std::memory_order_release);
+        }
+        // 从未写入返回false
+        bool load(size_t index, Record& record) const
+        {
+            auto& slot = _slots[index];
+            auto version = std::atomic_ref(slot.version);
+            while (true)
+            {
+                const auto before = version.load(std::memory_order_acquire);
+                if (before == 0) return false;
+                if (before & 1) continue;
+                std::memcpy(&record, &slot.record, sizeof(Record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version.load(std::memory_order_relaxed) == before) return true;
+            }
+        }
+        // 读端轮询变化用, 每次写入加2
+        [[nodiscard]] uint64_t version(size_t index) const
+        {
+            return std::atomic_ref(_slots[index].version).load(std::memory_order_acquire);
+        }
+
+    private:
+        bool map()
+        {
+            auto addr = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (addr == MAP_FAILED) return false;
+            _addr = static_cast<std::byte*>(addr);
+            _header = reinterpret_cast<Header*>(_addr);
+            _slots = reinterpret_cast<Slot*>(_addr + header_size);
+            return true;
+        }
+        void close()
+        {
+            if (_addr) ::munmap(_addr, _size);
+            if (_fd >= 0) ::close(_fd);
+            _addr = nullptr;
+            _header = nullptr;
+            _slots = nullptr;
+            _fd = -1;
+        }
+        int _fd = -1;
+        size_t _size = 0;
+        std::byte* _addr = nullptr;
+        Header* _header = nullptr;
+        Slot* _slots = nullptr;
+    };
+}
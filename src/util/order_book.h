@@ -0,0 +1,453 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+#include "data_type.h"
+#include "util/flat_map.h"
+
+namespace rk::util
+{
+    /// 逐笔重建的单合约全档订单簿
+    /// 价格按最小变动价位换算为档位, 涨跌停区间内的档位平铺在数组中, 区间外的档位(无涨跌停或异常价格)放入有序表
+    /// 每侧用位图记录非空档位并缓存最优档位, 最优档位撤空时按64档一个字向后扫描
+    /// 上交所: 新增订单数量为撮合后剩余量, 主动成交部分只出现在成交中, 删除订单撤销剩余量
+    /// 深交所: 委托全量入簿, 成交同时扣减买卖双方, 撤单以撤单委托到达; 市价委托不入簿只跟踪剩余量, 本方最优按到达时本方最优价入簿
+    /// 集合竞价期间买卖盘可以交叉
+    class OrderBook
+    {
+        static constexpr int64_t npos = -1;
+        struct Order
+        {
+            int64_t tick = 0;
+            int64_t volume = 0;
+            bool is_bid = false;
+            bool placed = false;        // 未入簿的市价委托只跟踪剩余量
+        };
+        struct Side
+        {
+            std::vector<int64_t> volume;            // 按档位序号
+            std::vector<uint64_t> bits;             // 非空档位
+            std::map<int64_t, int64_t> overflow;    // 区间外档位 -> 数量
+            int64_t best = npos;                    // 区间内最优档位序号
+        };
+    public:
+        struct Level
+        {
+            double price = 0.;
+            int64_t volume = 0;
+        };
+
+        OrderBook(const data_type::Symbol& symbol, double price_tick, double lower_limit_price, double upper_limit_price)
+        : _symbol(symbol), _price_tick(price_tick > 0 ? price_tick : 0.01), _inverse_tick(1. / _price_tick),
+        _lower_limit_price(lower_limit_price), _upper_limit_price(upper_limit_price)
+        {
+            // 无涨跌停时区间为空, 全部档位进入有序表
+            const bool has_band = upper_limit_price > lower_limit_price && upper_limit_price < std::numeric_limits<double>::max();
+            _lower_tick = has_band ? to_tick(lower_limit_price) : 0;
+            const auto level_num = has_band ? static_cast<size_t>(to_tick(upper_limit_price) - _lower_tick + 1) : 0;
+            for (auto* side : {&_bid, &_ask})
+            {
+                side->volume.assign(level_num, 0);
+                side->bits.assign((level_num + 63) / 64, 0);
+            }
+            _level_num = static_cast<int64_t>(level_num);
+            _orders.reserve(1024);
+        }
+
+        void on_order(const data_type::L2OrderData& order)
+        {
+            const bool is_bid = order.direction == data_type::Direction::LONG;
+            switch (order.order_type)
+            {
+                case data_type::L2OrderType::CANCEL:
+                {
+                    auto it = _orders.find(order.order_no);
+                    if (it == _orders.end()) break;
+                    if (it->second.placed) add_volume(it->second.is_bid, it->second.tick, -it->second.volume);
+                    _orders.erase(it);
+                    break;
+                }
+                case data_type::L2OrderType::LIMIT:
+                    place(order.order_no, is_bid, to_tick(order.price), order.volume);
+                    break;
+                case data_type::L2OrderType::BEST_OWN:
+                {
+                    const auto best = is_bid ? best_bid_tick() : best_ask_tick();
+                    if (best) place(order.order_no, is_bid, *best, order.volume);
+                    else _orders.try_emplace(order.order_no, Order{0, order.volume, is_bid, false});
+                    break;
+                }
+                default:
+                    _orders.try_emplace(order.order_no, Order{0, order.volume, is_bid, false});
+                    break;
+            }
+            _last_seq = order.seq;
+            _update_time = order.update_time;
+        }
+        void on_trade(const data_type::L2TradeData& trade)
+        {
+            // 上交所主动方不在簿中, 查不到即跳过
+            reduce(trade.buy_order_no, trade.volume);
+            reduce(trade.sell_order_no, trade.volume);
+            if (_volume == 0) _open_price = _highest_price = _lowest_price = trade.price;
+            _last_price = trade.price;
+            _highest_price = std::max(_highest_price, trade.price);
+            _lowest_price = std::min(_lowest_price, trade.price);
+            _volume += trade.volume;
+            _turnover += trade.turnover;
+            _last_seq = trade.seq;
+            _update_time = trade.update_time;
+        }
+
+        [[nodiscard]] std::optional<int64_t> best_bid_tick() const
+        {
+            std::optional<int64_t> best;
+            if (_bid.best != npos) best = _lower_tick + _bid.best;
+            if (!_bid.overflow.empty() && (!best || _bid.overflow.rbegin()->first > *best)) best = _bid.overflow.rbegin()->first;
+            return best;
+        }
+        [[nodiscard]] std::optional<int64_t> best_ask_tick() const
+        {
+            std::optional<int64_t> best;
+            if (_ask.best != npos) best = _lower_tick + _ask.best;
+            if (!_ask.overflow.empty() && (!best || _ask.overflow.begin()->first < *best)) best = _ask.overflow.begin()->first;
+            return best;
+        }
+        // 无挂单时返回空
+        [[nodiscard]] std::optional<Level> best_bid() const
+        {
+            const auto tick = best_bid_tick();
+            if (!tick) return std::nullopt;
+            return Level{to_price(*tick), volume_at(_bid, *tick)};
+        }
+        [[nodiscard]] std::optional<Level> best_ask() const
+        {
+            const auto tick = best_ask_tick();
+            if (!tick) return std::nullopt;
+            return Level{to_price(*tick), volume_at(_ask, *tick)};
+        }
+        [[nodiscard]] bool crossed() const
+        {
+            const auto bid = best_bid_tick();
+            const auto ask = best_ask_tick();
+            return bid && ask && *bid >= *ask;
+        }
+        // 按价格优先输出前levels.size()档, 返回实际档数
+        size_t bid_levels(std::span<Level> levels) const
+        {
+            size_t num = 0;
+            auto it = _bid.overflow.rbegin();
+            for (; it != _bid.overflow.rend() && it->first >= _lower_tick + _level_num && num < levels.size(); ++it)
+                levels[num++] = {to_price(it->first), it->second};
+            for (auto index = _bid.best; index != npos && num < levels.size(); index = prev_set(_bid.bits, index - 1))
+                levels[num++] = {to_price(_lower_tick + index), _bid.volume[index]};
+            for (; it != _bid.overflow.rend() && num < levels.size(); ++it)
+                levels[num++] = {to_price(it->first), it->second};
+            return num;
+        }
+        size_t ask_levels(std::span<Level> levels) const
+        {
+            size_t num = 0;
+            auto it = _ask.overflow.begin();
+            for (; it != _ask.overflow.end() && it->first < _lower_tick && num < levels.size(); ++it)
+                levels[num++] = {to_price(it->first), it->second};
+            for (auto index = _ask.best; index != npos && num < levels.size(); index = next_set(_ask.bits, index + 1))
+                levels[num++] = {to_price(_lower_tick + index), _ask.volume[index]};
+            for (; it != _ask.overflow.end() && num < levels.size(); ++it)
+                levels[num++] = {to_price(it->first), it->second};
+            return num;
+        }
+        // 前depth档写入TickData, depth不超过10
+        void snapshot(data_type::TickData& tick, size_t depth = 10) const
+        {
+            std::array<Level, 10> levels{};
+            depth = std::min(depth, levels.size());
+            tick.symbol = _symbol;
+            tick.trading_day = static_cast<uint32_t>(_update_time.date());
+            tick.update_time = _update_time;
+            tick.last_price = _last_price;
+            tick.open_price = _open_price;
+            tick.highest_price = _highest_price;
+            tick.lowest_price = _lowest_price;
+            tick.upper_limit_price = _upper_limit_price;
+            tick.lower_limit_price = _lower_limit_price;
+            tick.volume = _volume;
+            tick.open_interest = 0.;
+            tick.average_price = _volume > 0 ? _turnover / static_cast<double>(_volume) : 0.;
+            const auto bid_num = bid_levels(std::span(levels.data(), depth));
+            for (size_t i = 0; i < levels.size(); ++i)
+            {
+                tick.bid_price[i] = i < bid_num ? levels[i].price : 0.;
+                tick.bid_volume[i] = i < bid_num ? levels[i].volume : 0;
+            }
+            const auto ask_num = ask_levels(std::span(levels.data(), depth));
+            for (size_t i = 0; i < levels.size(); ++i)
+            {
+                tick.ask_price[i] = i < ask_num ? levels[i].price : 0.;
+                tick.ask_volume[i] = i < ask_num ? levels[i].volume : 0;
+            }
+            tick.iopv = 0.;
+        }
+
+        [[nodiscard]] const data_type::Symbol& symbol() const {return _symbol;}
+        [[nodiscard]] uint64_t last_seq() const {return _last_seq;}
+        [[nodiscard]] const DateTime& update_time() const {return _update_time;}
+        [[nodiscard]] size_t order_num() const {return _orders.size();}
+        [[nodiscard]] int64_t to_tick(double price) const {return std::llround(price * _inverse_tick);}
+        [[nodiscard]] double to_price(int64_t tick) const {return static_cast<double>(tick) * _price_tick;}
+
+    private:
+        void place(uint64_t order_no, bool is_bid, int64_t tick, int64_t volume)
+        {
+            if (volume <= 0) return;
+            if (!_orders.try_emplace(order_no, Order{tick, volume, is_bid, true}).second) return;
+            add_volume(is_bid, tick, volume);
+        }
+        void reduce(uint64_t order_no, int64_t volume)
+        {
+            auto it = _orders.find(order_no);
+            if (it == _orders.end()) return;
+            auto& order = it->second;
+            const auto reduced = std::min(volume, order.volume);
+            if (order.placed) add_volume(order.is_bid, order.tick, -reduced);
+            order.volume -= reduced;
+            if (order.volume <= 0) _orders.erase(it);
+        }
+        void add_volume(bool is_bid, int64_t tick, int64_t delta)
+        {
+            auto& side = is_bid ? _bid : _ask;
+            const auto index = tick - _lower_tick;
+            if (index < 0 || index >= _level_num)
+            {
+                auto& volume = side.overflow[tick];
+                volume += delta;
+                if (volume <= 0) side.overflow.erase(tick);
+                return;
+            }
+            auto& volume = side.volume[index];
+            const bool was_empty = volume == 0;
+            volume += delta;
+            if (volume > 0)
+            {
+                if (!was_empty) return;
+                side.bits[index / 64] |= uint64_t{1} << (index % 64);
+                if (side.best == npos || (is_bid ? index > side.best : index < side.best)) side.best = index;
+                return;
+            }
+            volume = 0;
+            side.bits[index / 64] &= ~(uint64_t{1} << (index % 64));
+            if (index == side.best) side.best = is_bid ? prev_set(side.bits, index - 1) : next_set(side.bits, index + 1);
+        }
+        static int64_t volume_at(const Side& side, int64_t tick, int64_t lower_tick, int64_t level_num)
+        {
+            const auto index = tick - lower_tick;
+            if (index >= 0 && index < level_num) return side.volume[index];
+            const auto it = side.overflow.find(tick);
+            return it == side.overflow.end() ? 0 : it->second;
+        }
+        [[nodiscard]] int64_t volume_at(const Side& side, int64_t tick) const {return volume_at(side, tick, _lower_tick, _level_num);}
+        // 不大于index的最高非空档位
+        static int64_t prev_set(const std::vector<uint64_t>& bits, int64_t index)
+        {
+            if (index < 0) return npos;
+            auto word = index / 64;
+            auto mask = bits[word] & (~uint64_t{0} >> (63 - index % 64));
+            while (true)
+            {
+                if (mask) return word * 64 + 63 - std::countl_zero(mask);
+                if (--word < 0) return npos;
+                mask = bits[word];
+            }
+        }
+        // 不小于index的最低非空档位
+        static int64_t next_set(const std::vector<uint64_t>& bits, int64_t index)
+        {
+            const auto word_num = static_cast<int64_t>(bits.size());
+            auto word = index / 64;
+            if (word >= word_num) return npos;
+            auto mask = bits[word] & (~uint64_t{0} << (index % 64));
+            while (true)
+            {
+                if (mask) return word * 64 + std::countr_zero(mask);
+                if (++word >= word_num) return npos;
+                mask = bits[word];
+            }
+        }
+
+        data_type::Symbol _symbol;
+        double _price_tick;
+        double _inverse_tick;
+        double _lower_limit_price;
+        double _upper_limit_price;
+        int64_t _lower_tick = 0;
+        int64_t _level_num = 0;
+        Side _bid;
+        Side _ask;
+        FlatMap<uint64_t, Order, IntegerHash> _orders;
+        uint64_t _last_seq = 0;
+        DateTime _update_time;
+        double _last_price = 0.;
+        double _open_price = 0.;
+        double _highest_price = 0.;
+        double _lowest_price = 0.;
+        int64_t _volume = 0;
+        double _turnover = 0.;
+    };
+
+    /// 全市场订单簿, 单线程按频道顺序输入逐笔
+    /// 每只合约按交易所时间间隔发布TickData快照, 间隔为0时每条逐笔发布
+    /// 建树快照用于校验: 本合约逐笔已处理到建树序号且频道进度不早于建树序号时比较前十档, 竞价期间交叉盘不比较
+    class OrderBookEngine
+    {
+        struct BookState
+        {
+            DateTime next_publish;
+            std::optional<data_type::L2SnapshotData> pending_tree;
+        };
+    public:
+        struct ValidationStats
+        {
+            uint64_t matched = 0;
+            uint64_t mismatched = 0;
+            uint64_t skipped = 0;       // 本地订单簿已越过建树序号或交叉盘
+        };
+        using PublishCallback = std::function<void(const data_type::TickData&)>;
+        using MismatchCallback = std::function<void(const OrderBook&, const data_type::L2SnapshotData&)>;
+
+        explicit OrderBookEngine(PublishCallback publish, size_t depth = 10, std::chrono::milliseconds snapshot_interval = std::chrono::milliseconds(0), MismatchCallback on_mismatch = {})
+        : _publish(std::move(publish)), _on_mismatch(std::move(on_mismatch)), _depth(depth), _snapshot_interval(snapshot_interval)
+        {}
+
+        template<typename SymbolDetailMap>
+        void reset(const SymbolDetailMap& symbol_details)
+        {
+            _books.clear();
+            _states.clear();
+            _book_ids.clear();
+            _channel_seq.clear();
+            _stats = {};
+            _books.reserve(symbol_details.size());
+            _states.reserve(symbol_details.size());
+            _book_ids.reserve(symbol_details.size());
+            for (const auto& [symbol, detail] : symbol_details)
+            {
+                _book_ids.emplace(symbol, static_cast<uint32_t>(_books.size()));
+                _books.emplace_back(symbol, detail->price_tick, detail->lower_limit_price, detail->upper_limit_price);
+                _states.emplace_back();
+            }
+        }
+
+        void on_order(const data_type::L2OrderData& order)
+        {
+            const auto id = find_id(order.symbol);
+            if (!id) return;
+            before_event(*id, order.seq);
+            _books[*id].on_order(order);
+            after_event(*id, order.channel, order.seq);
+        }
+        void on_trade(const data_type::L2TradeData& trade)
+        {
+            const auto id = find_id(trade.symbol);
+            if (!id) return;
+            before_event(*id, trade.seq);
+            _books[*id].on_trade(trade);
+            after_event(*id, trade.channel, trade.seq);
+        }
+        void on_tree(const data_type::L2SnapshotData& tree)
+        {
+            if (!tree.is_tree) return;
+            const auto id = find_id(tree.tick.symbol);
+            if (!id) return;
+            auto& state = _states[*id];
+            if (_books[*id].last_seq() > tree.seq)
+            {
+                ++_stats.skipped;
+                return;
+            }
+            const auto channel_it = _channel_seq.find(tree.channel);
+            if (channel_it != _channel_seq.end() && channel_it->second >= tree.seq) validate(*id, tree);
+            else state.pending_tree = tree;
+        }
+
+        [[nodiscard]] const OrderBook* find(const data_type::Symbol& symbol) const
+        {
+            const auto id = find_id(symbol);
+            return id ? &_books[*id] : nullptr;
+        }
+        [[nodiscard]] const ValidationStats& validation_stats() const {return _stats;}
+        [[nodiscard]] size_t book_num() const {return _books.size();}
+
+    private:
+        [[nodiscard]] std::optional<uint32_t> find_id(const data_type::Symbol& symbol) const
+        {
+            const auto it = _book_ids.find(symbol);
+            if (it == _book_ids.end()) return std::nullopt;
+            return it->second;
+        }
+        void before_event(uint32_t id, uint64_t seq)
+        {
+            auto& pending = _states[id].pending_tree;
+            if (pending && seq > pending->seq)
+            {
+                validate(id, *pending);
+                pending.reset();
+            }
+        }
+        void after_event(uint32_t id, uint32_t channel, uint64_t seq)
+        {
+            auto& channel_seq = _channel_seq[channel];
+            channel_seq = std::max(channel_seq, seq);
+            auto& state = _states[id];
+            const auto& book = _books[id];
+            if (_snapshot_interval.count() > 0 && book.update_time() < state.next_publish) return;
+            state.next_publish = book.update_time() + TimeDelta(_snapshot_interval);
+            if (!_publish) return;
+            book.snapshot(_tick, _depth);
+            _publish(_tick);
+        }
+        void validate(uint32_t id, const data_type::L2SnapshotData& tree)
+        {
+            const auto& book = _books[id];
+            if (book.crossed())
+            {
+                ++_stats.skipped;
+                return;
+            }
+            book.snapshot(_tick);
+            bool matched = true;
+            for (size_t i = 0; i < _tick.bid_price.size() && matched; ++i)
+            {
+                matched = book.to_tick(_tick.bid_price[i]) == book.to_tick(tree.tick.bid_price[i]) && _tick.bid_volume[i] == tree.tick.bid_volume[i] &&
+                    book.to_tick(_tick.ask_price[i]) == book.to_tick(tree.tick.ask_price[i]) && _tick.ask_volume[i] == tree.tick.ask_volume[i];
+            }
+            if (matched)
+            {
+                ++_stats.matched;
+                return;
+            }
+            ++_stats.mismatched;
+            if (_on_mismatch) _on_mismatch(book, tree);
+        }
+
+        PublishCallback _publish;
+        MismatchCallback _on_mismatch;
+        size_t _depth;
+        std::chrono::milliseconds _snapshot_interval;
+        std::vector<OrderBook> _books;                      // 按合约序号
+        std::vector<BookState> _states;
+        FlatMap<data_type::Symbol, uint32_t> _book_ids;
+        FlatMap<uint32_t, uint64_t, IntegerHash> _channel_seq;          // 频道 -> 已处理的最大逐笔序号
+        ValidationStats _stats;
+        data_type::TickData _tick;                          // 发布与校验复用
+    };
+}
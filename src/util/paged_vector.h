@@ -0,0 +1,177 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace rk::util
+{
+    /// 分页数组, 按页分配, 扩容只新增页不搬移元素, 元素地址在整个生命周期内稳定
+    template<typename T, size_t PageSize = 1024>
+    class PagedVector
+    {
+        static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0, "page size must be power of 2");
+        template<typename Owner, typename Value>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+            Iterator() = default;
+            Iterator(Owner* owner, size_t index) : _owner(owner), _index(index) {}
+            reference operator*() const {return (*_owner)[_index];}
+            pointer operator->() const {return &(*_owner)[_index];}
+            Iterator& operator++() {++_index; return *this;}
+            Iterator operator++(int) {auto it = *this; ++_index; return it;}
+            bool operator==(const Iterator& other) const {return _index == other._index;}
+        private:
+            Owner* _owner = nullptr;
+            size_t _index = 0;
+        };
+    public:
+        using iterator = Iterator<PagedVector, T>;
+        using const_iterator = Iterator<const PagedVector, const T>;
+
+        PagedVector() = default;
+        explicit PagedVector(size_t capacity) {reserve(capacity);}
+        PagedVector(PagedVector&&) noexcept = default;
+        PagedVector& operator=(PagedVector&&) noexcept = default;
+        PagedVector(const PagedVector&) = delete;
+        PagedVector& operator=(const PagedVector&) = delete;
+
+        void reserve(size_t capacity)
+        {
+            while (this->capacity() < capacity) _pages.emplace_back(std::make_unique<T[]>(PageSize));
+        }
+        template<typename... Args>
+        T& emplace_back(Args&&... args)
+        {
+            if (_size == capacity()) reserve(_size + 1);
+            auto& slot = (*this)[_size++];
+            slot = T{std::forward<Args>(args)...};
+            return slot;
+        }
+        void resize(size_t size)
+        {
+            reserve(size);
+            for (auto i = size; i < _size; ++i) (*this)[i] = T{};
+            _size = size;
+        }
+        void clear() {resize(0);}
+
+        T& operator[](size_t index) {return _pages[index / PageSize][index % PageSize];}
+        const T& operator[](size_t index) const {return _pages[index / PageSize][index % PageSize];}
+        T& back() {return (*this)[_size - 1];}
+        const T& back() const {return (*this)[_size - 1];}
+        [[nodiscard]] size_t size() const {return _size;}
+        [[nodiscard]] size_t capacity() const {return _pages.size() * PageSize;}
+        [[nodiscard]] bool empty() const {return _size == 0;}
+
+        iterator begin() {return {this, 0};}
+        iterator end() {return {this, _size};}
+        const_iterator begin() const {return {this, 0};}
+        const_iterator end() const {return {this, _size};}
+
+    private:
+        std::vector<std::unique_ptr<T[]>> _pages;
+        size_t _size = 0;
+    };
+
+    /// 链式分页池, 元素平铺在同一个分页数组中, 按链表(例如同一委托的成交)串联
+    /// 链表按下标访问, 追加元素不产生单独的小块分配
+    template<typename T, size_t PageSize = 1024>
+    class PagedListPool
+    {
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+        struct Node
+        {
+            T value;
+            uint32_t next = npos;
+        };
+        struct List
+        {
+            uint32_t head = npos;
+            uint32_t tail = npos;
+            uint32_t size = 0;
+        };
+        template<typename Owner, typename Value>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+            Iterator() = default;
+            Iterator(Owner* nodes, uint32_t index) : _nodes(nodes), _index(index) {}
+            reference operator*() const {return (*_nodes)[_index].value;}
+            pointer operator->() const {return &(*_nodes)[_index].value;}
+            Iterator& operator++() {_index = (*_nodes)[_index].next; return *this;}
+            Iterator operator++(int) {auto it = *this; ++(*this); return it;}
+            bool operator==(const Iterator& other) const {return _index == other._index;}
+        private:
+            Owner* _nodes = nullptr;
+            uint32_t _index = npos;
+        };
+        template<typename Owner, typename Value>
+        class Range
+        {
+        public:
+            Range(Owner* nodes, const List& list) : _nodes(nodes), _list(list) {}
+            auto begin() const {return Iterator<Owner, Value>{_nodes, _list.head};}
+            auto end() const {return Iterator<Owner, Value>{_nodes, npos};}
+            Value& back() const {return (*_nodes)[_list.tail].value;}
+            [[nodiscard]] size_t size() const {return _list.size;}
+            [[nodiscard]] bool empty() const {return _list.size == 0;}
+        private:
+            Owner* _nodes;
+            const List& _list;
+        };
+    public:
+        PagedListPool() = default;
+        PagedListPool(size_t list_capacity, size_t value_capacity) {reserve(list_capacity, value_capacity);}
+
+        void reserve(size_t list_capacity, size_t value_capacity)
+        {
+            _lists.reserve(list_capacity);
+            _nodes.reserve(value_capacity);
+        }
+        // 链表数量, 不足时补空链表
+        void resize(size_t list_num)
+        {
+            _lists.resize(list_num);
+        }
+        T& push_back(size_t list_index, T value)
+        {
+            if (list_index >= _lists.size()) _lists.resize(list_index + 1);
+            const auto node_index = static_cast<uint32_t>(_nodes.size());
+            auto& node = _nodes.emplace_back(std::move(value), npos);
+            auto& list = _lists[list_index];
+            if (list.tail == npos) list.head = node_index;
+            else _nodes[list.tail].next = node_index;
+            list.tail = node_index;
+            ++list.size;
+            return node.value;
+        }
+        auto operator[](size_t list_index) {return Range<PagedVector<Node, PageSize>, T>{&_nodes, _lists[list_index]};}
+        auto operator[](size_t list_index) const {return Range<const PagedVector<Node, PageSize>, const T>{&_nodes, _lists[list_index]};}
+        // 链表数量
+        [[nodiscard]] size_t size() const {return _lists.size();}
+        // 元素总数
+        [[nodiscard]] size_t value_size() const {return _nodes.size();}
+
+    private:
+        PagedVector<List, PageSize> _lists;
+        PagedVector<Node, PageSize> _nodes;
+    };
+}
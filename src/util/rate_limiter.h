@@ -0,0 +1,57 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+
+namespace rk::util
+{
+    /// 令牌桶限流, 按固定速率补充令牌, 桶容量为允许的突发笔数
+    /// rate为0不限流
+    /// 单线程使用
+    class RateLimiter
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        RateLimiter() = default;
+        RateLimiter(double rate, double burst)
+        : _rate(std::max(rate, 0.)), _burst(burst > 0 ? burst : std::max(rate, 1.)), _tokens(_burst), _last_refill(clock::now())
+        {}
+
+        [[nodiscard]] bool unlimited() const {return _rate <= 0;}
+        // 当前可用令牌数, 不消耗
+        [[nodiscard]] size_t available(clock::time_point now = clock::now())
+        {
+            if (unlimited()) return std::numeric_limits<size_t>::max();
+            refill(now);
+            return static_cast<size_t>(_tokens);
+        }
+        bool try_acquire(clock::time_point now = clock::now())
+        {
+            if (unlimited()) return true;
+            refill(now);
+            if (_tokens < 1.) return false;
+            _tokens -= 1.;
+            return true;
+        }
+
+    private:
+        void refill(clock::time_point now)
+        {
+            if (now <= _last_refill) return;
+            const auto elapsed = std::chrono::duration<double>(now - _last_refill).count();
+            _tokens = std::min(_burst, _tokens + elapsed * _rate);
+            _last_refill = now;
+        }
+
+        double _rate = 0.;
+        double _burst = 0.;
+        double _tokens = 0.;
+        clock::time_point _last_refill;
+    };
+}
@@ -0,0 +1,259 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include <pthread.h>
+#include <readerwriterqueue.h>
+#include "util/last_value_store.h"
+#include "util/logger.h"
+#include "util/order_book.h"
+
+namespace rk::util
+{
+    /// 按合约分片重建订单簿, 每个分片一个工作线程和一个OrderBookEngine
+    /// 输入线程(Level2行情分发线程)按合约序号取模路由到分片的单生产者单消费者队列, 同一合约的逐笔始终在同一分片内按序处理
+    /// 分片发布的快照写入共享内存最新值表, 槽位为合约序号, 各分片写不同槽位
+    /// 逐笔丢失会使订单簿永久错误, 队列满时输入线程自旋等待, 等待次数计入指标
+    /// 各分片每秒输出队列深度、排队延迟和行情延迟(本地时间与交易所时间之差), 用于确定分片数
+    class ShardedOrderBookEngine
+    {
+        using Event = std::variant<data_type::L2OrderData, data_type::L2TradeData, data_type::L2SnapshotData>;
+        struct Message
+        {
+            std::chrono::steady_clock::time_point enqueue_time;
+            Event event;
+        };
+        struct Metrics
+        {
+            std::atomic<uint64_t> enqueued = 0;         // 输入线程写
+            std::atomic<uint64_t> blocked = 0;          // 输入线程写, 队列满等待次数
+            std::atomic<uint64_t> processed = 0;        // 以下由工作线程按统计周期更新
+            std::atomic<uint64_t> max_depth = 0;
+            std::atomic<int64_t> avg_queue_us = 0;
+            std::atomic<int64_t> max_queue_us = 0;
+            std::atomic<int64_t> max_lag_us = 0;
+        };
+        struct Shard
+        {
+            Shard(size_t capacity, size_t depth, std::chrono::milliseconds snapshot_interval)
+            : queue(capacity), engine([this](const data_type::TickData& tick) {publish(tick);}, depth, snapshot_interval)
+            {}
+            void publish(const data_type::TickData& tick) const
+            {
+                if (!last_value_store) return;
+                const auto it = slots.find(tick.symbol);
+                if (it != slots.end()) last_value_store->store(it->second, tick);
+            }
+            moodycamel::ReaderWriterQueue<Message> queue;
+            OrderBookEngine engine;
+            FlatMap<data_type::Symbol, uint32_t> slots;     // 本分片合约 -> 最新值表槽位
+            LastValueStore<data_type::TickData>* last_value_store = nullptr;
+            Metrics metrics;
+            std::unique_ptr<std::jthread> worker;
+        };
+        static constexpr size_t process_batch_size = 256;
+    public:
+        struct ShardStats
+        {
+            uint64_t enqueued = 0;
+            uint64_t processed = 0;
+            uint64_t blocked = 0;
+            size_t depth = 0;               // 当前队列深度
+            uint64_t max_depth = 0;         // 以下为上一统计周期的值
+            int64_t avg_queue_us = 0;
+            int64_t max_queue_us = 0;
+            int64_t max_lag_us = 0;
+        };
+
+        // shard_cpu_id按分片绑核, 不足的分片或-1不绑核
+        ShardedOrderBookEngine(size_t shard_num, size_t queue_capacity, size_t depth, std::chrono::milliseconds snapshot_interval, std::vector<int32_t> shard_cpu_id = {})
+        : _shard_cpu_id(std::move(shard_cpu_id))
+        {
+            for (size_t i = 0; i < std::max<size_t>(shard_num, 1); ++i)
+            {
+                _shards.emplace_back(std::make_unique<Shard>(queue_capacity, depth, snapshot_interval));
+            }
+        }
+        ~ShardedOrderBookEngine() {stop();}
+        ShardedOrderBookEngine(const ShardedOrderBookEngine&) = delete;
+        ShardedOrderBookEngine& operator=(const ShardedOrderBookEngine&) = delete;
+
+        // 按合约序号分配分片和最新值表槽位, 并启动工作线程; 重复调用先停止工作线程
+        // 最新值表为空时不发布快照, 只重建订单簿和校验
+        template<typename SymbolDetailMap>
+        void start(const SymbolDetailMap& symbol_details, LastValueStore<data_type::TickData>* last_value_store)
+        {
+            stop();
+            _shard_ids.clear();
+            _shard_ids.reserve(symbol_details.size());
+            if (last_value_store && last_value_store->capacity() < symbol_details.size())
+            {
+                RK_LOG_WARN("order book last value store capacity {} less than symbol num {}", last_value_store->capacity(), symbol_details.size());
+                last_value_store = nullptr;
+            }
+            std::vector<FlatMap<data_type::Symbol, std::shared_ptr<data_type::SymbolDetail>>> shard_details(_shards.size());
+            for (auto& shard : _shards) shard->slots.clear();
+            uint32_t slot = 0;
+            for (const auto& [symbol, detail] : symbol_details)
+            {
+                const auto shard_id = slot % _shards.size();
+                _shard_ids.emplace(symbol, static_cast<uint32_t>(shard_id));
+                shard_details[shard_id].emplace(symbol, detail);
+                _shards[shard_id]->slots.emplace(symbol, slot);
+                ++slot;
+            }
+            for (size_t i = 0; i < _shards.size(); ++i)
+            {
+                auto& shard = *_shards[i];
+                shard.engine.reset(shard_details[i]);
+                shard.last_value_store = last_value_store;
+                const auto cpu_id = i < _shard_cpu_id.size() ? _shard_cpu_id[i] : -1;
+                shard.worker = std::make_unique<std::jthread>([&shard, i, cpu_id](const std::stop_token& stop_token)
+                {
+                    if (cpu_id >= 0) bind_cpu(cpu_id);
+                    working_loop(stop_token, i, shard);
+                });
+            }
+            RK_LOG_INFO("order book started, {} symbol across {} shard", slot, _shards.size());
+        }
+        void stop()
+        {
+            for (auto& shard : _shards)
+            {
+                shard->worker.reset();
+                // 停止后丢弃未处理的逐笔, 下次start重建
+                while (shard->queue.pop()) {}
+            }
+        }
+
+        // 以下只能在同一个输入线程调用
+        void on_order(const data_type::L2OrderData& order) {enqueue(order.symbol, order);}
+        void on_trade(const data_type::L2TradeData& trade) {enqueue(trade.symbol, trade);}
+        // 只转发建树快照, 用于校验
+        void on_snapshot(const data_type::L2SnapshotData& snapshot)
+        {
+            if (snapshot.is_tree) enqueue(snapshot.tick.symbol, snapshot);
+        }
+
+        [[nodiscard]] size_t shard_num() const {return _shards.size();}
+        [[nodiscard]] ShardStats stats(size_t shard_id) const
+        {
+            const auto& shard = *_shards[shard_id];
+            const auto& metrics = shard.metrics;
+            return {
+                metrics.enqueued.load(std::memory_order_relaxed),
+                metrics.processed.load(std::memory_order_relaxed),
+                metrics.blocked.load(std::memory_order_relaxed),
+                shard.queue.size_approx(),
+                metrics.max_depth.load(std::memory_order_relaxed),
+                metrics.avg_queue_us.load(std::memory_order_relaxed),
+                metrics.max_queue_us.load(std::memory_order_relaxed),
+                metrics.max_lag_us.load(std::memory_order_relaxed),
+            };
+        }
+
+    private:
+        template<typename T>
+        void enqueue(const data_type::Symbol& symbol, const T& data)
+        {
+            const auto it = _shard_ids.find(symbol);
+            if (it == _shard_ids.end()) return;
+            auto& shard = *_shards[it->second];
+            Message message{std::chrono::steady_clock::now(), data};
+            if (!shard.queue.try_enqueue(std::move(message)))
+            {
+                shard.metrics.blocked.fetch_add(1, std::memory_order_relaxed);
+                while (!shard.queue.try_enqueue(std::move(message))) std::this_thread::yield();
+            }
+            shard.metrics.enqueued.fetch_add(1, std::memory_order_relaxed);
+        }
+        static void bind_cpu(int32_t cpu_id)
+        {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu_id, &cpu_set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) RK_LOG_WARN("order book shard bind cpu {} failed", cpu_id);
+        }
+        static void working_loop(const std::stop_token& stop_token, size_t shard_id, Shard& shard)
+        {
+            auto& engine = shard.engine;
+            auto& metrics = shard.metrics;
+            // 统计周期内的累计值
+            uint64_t processed = 0;
+            uint64_t max_depth = 0;
+            int64_t queue_us_sum = 0;
+            int64_t max_queue_us = 0;
+            int64_t max_lag_us = 0;
+            uint64_t window_num = 0;
+            auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (!stop_token.stop_requested())
+            {
+                const auto depth = shard.queue.size_approx();
+                max_depth = std::max<uint64_t>(max_depth, depth);
+                size_t num = 0;
+                // 原地处理队首消息, 不拷出快照大结构体
+                for (auto* message = shard.queue.peek(); message && num < process_batch_size; message = shard.queue.peek())
+                {
+                    const auto queue_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - message->enqueue_time).count();
+                    queue_us_sum += queue_us;
+                    max_queue_us = std::max(max_queue_us, queue_us);
+                    std::visit([&]<typename T>(const T& event)
+                    {
+                        if constexpr (std::is_same_v<T, data_type::L2OrderData>)
+                        {
+                            engine.on_order(event);
+                            max_lag_us = std::max(max_lag_us, (DateTime::now() - event.update_time).microseconds());
+                        }
+                        else if constexpr (std::is_same_v<T, data_type::L2TradeData>)
+                        {
+                            engine.on_trade(event);
+                            max_lag_us = std::max(max_lag_us, (DateTime::now() - event.update_time).microseconds());
+                        }
+                        else engine.on_tree(event);
+                    }, message->event);
+                    shard.queue.pop();
+                    ++num;
+                }
+                processed += num;
+                window_num += num;
+                if (const auto now = std::chrono::steady_clock::now(); now >= next_report)
+                {
+                    const auto avg_queue_us = window_num > 0 ? queue_us_sum / static_cast<int64_t>(window_num) : 0;
+                    metrics.processed.store(processed, std::memory_order_relaxed);
+                    metrics.max_depth.store(max_depth, std::memory_order_relaxed);
+                    metrics.avg_queue_us.store(avg_queue_us, std::memory_order_relaxed);
+                    metrics.max_queue_us.store(max_queue_us, std::memory_order_relaxed);
+                    metrics.max_lag_us.store(max_lag_us, std::memory_order_relaxed);
+                    if (window_num > 0)
+                    {
+                        const auto& validation = engine.validation_stats();
+                        RK_LOG_INFO(
+                            "order book shard {} processed {} depth {} max depth {} queue avg {}us max {}us lag max {}us blocked {} tree matched {} mismatched {} skipped {}",
+                            shard_id, window_num, depth, max_depth, avg_queue_us, max_queue_us, max_lag_us,
+                            metrics.blocked.load(std::memory_order_relaxed), validation.matched, validation.mismatched, validation.skipped
+                        );
+                    }
+                    max_depth = 0;
+                    queue_us_sum = 0;
+                    max_queue_us = 0;
+                    max_lag_us = 0;
+                    window_num = 0;
+                    next_report = now + std::chrono::seconds(1);
+                }
+                if (num == 0) std::this_thread::yield();
+            }
+        }
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+        std::vector<int32_t> _shard_cpu_id;
+        FlatMap<data_type::Symbol, uint32_t> _shard_ids;       // 合约 -> 分片, 只在输入线程读
+    };
+}
@@ -0,0 +1,68 @@
+//
+// Created by root on 2026/10/19.
+//
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "util/datetime.h"
+
+namespace rk::util
+{
+    /// 定时器队列, 按到期时间小顶堆排序
+    /// 每个定时器同一时刻只有一个有效到期时间: 重新定时或取消只递增代数, 堆中旧条目到期时按代数丢弃
+    /// 堆条目为定长结构, 容量稳定后定时不再分配内存
+    /// 单线程使用
+    class TimerQueue
+    {
+    public:
+        uint32_t add_timer()
+        {
+            _generations.push_back(0);
+            return static_cast<uint32_t>(_generations.size() - 1);
+        }
+        void reserve(size_t timer_num)
+        {
+            _generations.reserve(timer_num);
+            _heap.reserve(timer_num * 2);
+        }
+        void schedule(uint32_t timer_id, const DateTime& deadline)
+        {
+            _heap.push_back({deadline, timer_id, ++_generations[timer_id]});
+            std::push_heap(_heap.begin(), _heap.end(), later);
+        }
+        void cancel(uint32_t timer_id) {++_generations[timer_id];}
+        [[nodiscard]] bool empty() const {return _heap.empty();}
+        [[nodiscard]] size_t size() const {return _heap.size();}
+        // 依次回调到期的定时器, 回调中可以重新定时
+        template<typename Callback>
+        size_t expire(const DateTime& now, Callback&& callback)
+        {
+            size_t num = 0;
+            while (!_heap.empty() && _heap.front().deadline <= now)
+            {
+                std::pop_heap(_heap.begin(), _heap.end(), later);
+                const auto entry = _heap.back();
+                _heap.pop_back();
+                if (entry.generation != _generations[entry.timer_id]) continue;
+                std::invoke(callback, entry.timer_id);
+                ++num;
+            }
+            return num;
+        }
+
+    private:
+        struct Entry
+        {
+            DateTime deadline;
+            uint32_t timer_id;
+            uint32_t generation;
+        };
+        static bool later(const Entry& a, const Entry& b) {return b.deadline < a.deadline;}
+
+        std::vector<Entry> _heap;
+        std::vector<uint32_t> _generations;     // 按定时器号索引
+    };
+}